@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "callback.h"
+
+#define BENCHMARK_HANDLERS_COUNTS (4)
+#define BENCHMARK_CALLBACKS (4096)
+#define BENCHMARK_CALLS_TOTAL (1 << 24)
+
+static const size_t handlers_counts[BENCHMARK_HANDLERS_COUNTS] = {1, 4, 16, 64};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void handler(void* context, void* payload) {
+    (void)payload;
+    (*(uint32_t*)context)++;
+}
+
+/*
+ * Many events are dispatched in random order, so the data set does not fit the caches. Live callbacks pay for
+ * announcing the dispatcher to writers, frozen ones do not.
+ */
+static double benchmark(size_t handlers, bool frozen) {
+    static callback_t* callbacks[BENCHMARK_CALLBACKS];
+    static uint32_t counters[BENCHMARK_CALLBACKS];
+    static uint16_t order[BENCHMARK_CALLS_TOTAL / 16];
+    srand(1);
+    for (size_t i = 0; i < BENCHMARK_CALLBACKS; i++) {
+        callbacks[i] = callback_create();
+        counters[i] = 0;
+    }
+    for (size_t j = 0; j < handlers; j++) {
+        for (size_t i = 0; i < BENCHMARK_CALLBACKS; i++) {
+            callback_register_handler(callbacks[(size_t)rand() % BENCHMARK_CALLBACKS], handler, &counters[i]);
+        }
+    }
+    for (size_t i = 0; frozen && i < BENCHMARK_CALLBACKS; i++) {
+        callback_freeze(callbacks[i]);
+    }
+    size_t dispatches = BENCHMARK_CALLS_TOTAL / handlers;
+    size_t orders = sizeof(order) / sizeof(order[0]);
+    for (size_t i = 0; i < orders; i++) {
+        order[i] = (uint16_t)((size_t)rand() % BENCHMARK_CALLBACKS);
+    }
+
+    double start = now_seconds();
+    for (size_t i = 0; i < dispatches; i++) {
+        callback_dispatch(callbacks[order[i % orders]], NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    for (size_t i = 0; i < BENCHMARK_CALLBACKS; i++) {
+        callback_destroy(callbacks[i]);
+    }
+    return elapsed * 1e9 / (double)dispatches;
+}
+
+#define BENCHMARK_BATCH_PAYLOADS (512)
+
+static void batch_handler(void* context, void* const* payloads, size_t count) {
+    (void)payloads;
+    *(uint32_t*)context += (uint32_t)count;
+}
+
+/* Payloads ready at once, dispatched one by one or as a batch to plain or batch-aware handlers. */
+static double benchmark_batch(size_t handlers, bool batched, bool batch_handlers) {
+    static void* payloads[BENCHMARK_BATCH_PAYLOADS];
+    uint32_t counters[64] = {0};
+    callback_t* callbacks = callback_create();
+    for (size_t i = 0; i < handlers; i++) {
+        if (batch_handlers) {
+            callback_register_batch_handler(callbacks, batch_handler, &counters[i]);
+        } else {
+            callback_register_handler(callbacks, handler, &counters[i]);
+        }
+    }
+    callback_freeze(callbacks);
+    size_t batches = BENCHMARK_CALLS_TOTAL / (handlers * BENCHMARK_BATCH_PAYLOADS);
+    double start = now_seconds();
+    for (size_t i = 0; i < batches; i++) {
+        if (batched) {
+            callback_dispatch_batch(callbacks, payloads, BENCHMARK_BATCH_PAYLOADS);
+        } else {
+            for (size_t j = 0; j < BENCHMARK_BATCH_PAYLOADS; j++) {
+                callback_dispatch(callbacks, payloads[j]);
+            }
+        }
+    }
+    double elapsed = now_seconds() - start;
+    callback_destroy(callbacks);
+    return elapsed * 1e9 / (double)(batches * BENCHMARK_BATCH_PAYLOADS);
+}
+
+int main(void) {
+    for (size_t i = 0; i < BENCHMARK_HANDLERS_COUNTS; i++) {
+        double live = benchmark(handlers_counts[i], false);
+        double frozen = benchmark(handlers_counts[i], true);
+        printf("%2zu handlers on average: live %8.2f ns, frozen %8.2f ns per dispatch, speedup %.2fx\n",
+               handlers_counts[i],
+               live,
+               frozen,
+               live / frozen);
+    }
+    for (size_t i = 0; i < BENCHMARK_HANDLERS_COUNTS; i++) {
+        double single = benchmark_batch(handlers_counts[i], false, false);
+        double batched = benchmark_batch(handlers_counts[i], true, false);
+        double batch_handlers = benchmark_batch(handlers_counts[i], true, true);
+        printf("%2zu handlers: single %7.2f ns, batch %7.2f ns, batch handlers %7.2f ns per payload\n",
+               handlers_counts[i],
+               single,
+               batched,
+               batch_handlers);
+    }
+    return 0;
+}
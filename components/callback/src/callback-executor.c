@@ -0,0 +1,300 @@
+/**
+ * MIT License
+ * Copyright (c) 2024 Grzegorz Grzęda
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "callback-executor.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+typedef struct callback_executor_task {
+    callback_handler_t handler;
+    void* context;
+    void* payload;
+} callback_executor_task_t;
+
+/* Ring of tasks, the owning worker takes from the back and thieves from the front. */
+typedef struct callback_executor_queue {
+    pthread_mutex_t lock;
+    atomic_size_t count;
+    size_t head;
+    callback_executor_task_t* tasks;
+} callback_executor_queue_t;
+
+typedef struct callback_executor_worker {
+    callback_executor_t* executor;
+    size_t index;
+    pthread_t thread;
+    callback_executor_queue_t queue;
+} callback_executor_worker_t;
+
+typedef struct callback_executor {
+    size_t worker_count;
+    size_t queue_depth;
+    callback_executor_worker_t* workers;
+    pthread_mutex_t lock;
+    pthread_cond_t work_available;
+    pthread_cond_t idle;
+    atomic_size_t outstanding;
+    atomic_size_t sleepers;
+    atomic_size_t next_queue;
+    atomic_bool stop;
+    atomic_size_t submitted;
+    atomic_size_t completed;
+    atomic_size_t stolen;
+    atomic_size_t rejected;
+} callback_executor_t;
+
+/* Worker running on this thread, tasks submitted from its handlers stay in its own queue. */
+static _Thread_local callback_executor_worker_t* current_worker;
+
+static bool push_task(callback_executor_t* executor,
+                      callback_executor_queue_t* queue,
+                      const callback_executor_task_t* task) {
+    pthread_mutex_lock(&queue->lock);
+    size_t count = atomic_load_explicit(&queue->count, memory_order_relaxed);
+    if (count == executor->queue_depth) {
+        pthread_mutex_unlock(&queue->lock);
+        return false;
+    }
+    queue->tasks[(queue->head + count) % executor->queue_depth] = *task;
+    atomic_fetch_add(&executor->outstanding, 1);
+    atomic_store(&queue->count, count + 1);
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+static bool take_task(callback_executor_t* executor,
+                      callback_executor_queue_t* queue,
+                      bool steal,
+                      callback_executor_task_t* task) {
+    if (atomic_load_explicit(&queue->count, memory_order_relaxed) == 0) {
+        return false;
+    }
+    pthread_mutex_lock(&queue->lock);
+    size_t count = atomic_load_explicit(&queue->count, memory_order_relaxed);
+    if (count == 0) {
+        pthread_mutex_unlock(&queue->lock);
+        return false;
+    }
+    if (steal) {
+        *task = queue->tasks[queue->head];
+        queue->head = (queue->head + 1) % executor->queue_depth;
+    } else {
+        *task = queue->tasks[(queue->head + count - 1) % executor->queue_depth];
+    }
+    atomic_store(&queue->count, count - 1);
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+static bool find_task(callback_executor_worker_t* worker, callback_executor_task_t* task) {
+    callback_executor_t* executor = worker->executor;
+    if (take_task(executor, &worker->queue, false, task)) {
+        return true;
+    }
+    for (size_t i = 1; i < executor->worker_count; i++) {
+        callback_executor_worker_t* victim = &executor->workers[(worker->index + i) % executor->worker_count];
+        if (take_task(executor, &victim->queue, true, task)) {
+            atomic_fetch_add_explicit(&executor->stolen, 1, memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool has_pending_tasks(callback_executor_t* executor) {
+    for (size_t i = 0; i < executor->worker_count; i++) {
+        if (atomic_load(&executor->workers[i].queue.count) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void task_completed(callback_executor_t* executor) {
+    atomic_fetch_add_explicit(&executor->completed, 1, memory_order_relaxed);
+    if (atomic_fetch_sub(&executor->outstanding, 1) == 1) {
+        pthread_mutex_lock(&executor->lock);
+        pthread_cond_broadcast(&executor->idle);
+        pthread_mutex_unlock(&executor->lock);
+    }
+}
+
+static void* worker_thread(void* arg) {
+    callback_executor_worker_t* worker = arg;
+    callback_executor_t* executor = worker->executor;
+    current_worker = worker;
+    callback_executor_task_t task;
+    while (!atomic_load(&executor->stop)) {
+        if (find_task(worker, &task)) {
+            task.handler(task.context, task.payload);
+            task_completed(executor);
+            continue;
+        }
+        atomic_fetch_add(&executor->sleepers, 1);
+        pthread_mutex_lock(&executor->lock);
+        if (!atomic_load(&executor->stop) && !has_pending_tasks(executor)) {
+            pthread_cond_wait(&executor->work_available, &executor->lock);
+        }
+        pthread_mutex_unlock(&executor->lock);
+        atomic_fetch_sub(&executor->sleepers, 1);
+    }
+    return NULL;
+}
+
+static void wake_workers(callback_executor_t* executor) {
+    pthread_mutex_lock(&executor->lock);
+    pthread_cond_broadcast(&executor->work_available);
+    pthread_mutex_unlock(&executor->lock);
+}
+
+static void stop_workers(callback_executor_t* executor, size_t started) {
+    atomic_store(&executor->stop, true);
+    wake_workers(executor);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(executor->workers[i].thread, NULL);
+    }
+}
+
+static void free_executor(callback_executor_t* executor) {
+    if (executor->workers) {
+        for (size_t i = 0; i < executor->worker_count; i++) {
+            pthread_mutex_destroy(&executor->workers[i].queue.lock);
+            free(executor->workers[i].queue.tasks);
+        }
+    }
+    pthread_cond_destroy(&executor->idle);
+    pthread_cond_destroy(&executor->work_available);
+    pthread_mutex_destroy(&executor->lock);
+    free(executor->workers);
+    free(executor);
+}
+
+static bool allocate_executor(callback_executor_t* executor) {
+    executor->workers = calloc(executor->worker_count, sizeof(callback_executor_worker_t));
+    if (!executor->workers) {
+        return false;
+    }
+    for (size_t i = 0; i < executor->worker_count; i++) {
+        callback_executor_worker_t* worker = &executor->workers[i];
+        worker->executor = executor;
+        worker->index = i;
+        pthread_mutex_init(&worker->queue.lock, NULL);
+        atomic_init(&worker->queue.count, 0);
+        worker->queue.tasks = calloc(executor->queue_depth, sizeof(callback_executor_task_t));
+        if (!worker->queue.tasks) {
+            return false;
+        }
+    }
+    return true;
+}
+
+callback_executor_t* callback_executor_create(const callback_executor_config_t* config) {
+    callback_executor_t* executor = calloc(1, sizeof(callback_executor_t));
+    if (!executor) {
+        return NULL;
+    }
+    executor->worker_count = ((config && config->worker_count) ? config->worker_count
+                                                                : CALLBACK_EXECUTOR_DEFAULT_WORKER_COUNT);
+    executor->queue_depth = ((config && config->queue_depth) ? config->queue_depth
+                                                              : CALLBACK_EXECUTOR_DEFAULT_QUEUE_DEPTH);
+    pthread_mutex_init(&executor->lock, NULL);
+    pthread_cond_init(&executor->work_available, NULL);
+    pthread_cond_init(&executor->idle, NULL);
+    atomic_init(&executor->outstanding, 0);
+    atomic_init(&executor->sleepers, 0);
+    atomic_init(&executor->next_queue, 0);
+    atomic_init(&executor->stop, false);
+    atomic_init(&executor->submitted, 0);
+    atomic_init(&executor->completed, 0);
+    atomic_init(&executor->stolen, 0);
+    atomic_init(&executor->rejected, 0);
+    if (!allocate_executor(executor)) {
+        free_executor(executor);
+        return NULL;
+    }
+    for (size_t i = 0; i < executor->worker_count; i++) {
+        if (pthread_create(&executor->workers[i].thread, NULL, worker_thread, &executor->workers[i]) != 0) {
+            stop_workers(executor, i);
+            free_executor(executor);
+            return NULL;
+        }
+    }
+    return executor;
+}
+
+void callback_executor_destroy(callback_executor_t* executor) {
+    if (!executor) {
+        return;
+    }
+    callback_executor_flush(executor);
+    stop_workers(executor, executor->worker_count);
+    free_executor(executor);
+}
+
+bool callback_executor_submit(callback_executor_t* executor, callback_handler_t handler, void* context, void* payload) {
+    if (!executor || !handler) {
+        return false;
+    }
+    callback_executor_task_t task = {handler, context, payload};
+    size_t first = 0;
+    if (current_worker && current_worker->executor == executor) {
+        first = current_worker->index;
+    } else {
+        first = atomic_fetch_add_explicit(&executor->next_queue, 1, memory_order_relaxed) % executor->worker_count;
+    }
+    /* A full queue spills over to the next ones, the task is rejected only when all of them are full. */
+    bool queued = false;
+    for (size_t i = 0; i < executor->worker_count && !queued; i++) {
+        queued = push_task(executor, &executor->workers[(first + i) % executor->worker_count].queue, &task);
+    }
+    if (!queued) {
+        atomic_fetch_add_explicit(&executor->rejected, 1, memory_order_relaxed);
+        return false;
+    }
+    atomic_fetch_add_explicit(&executor->submitted, 1, memory_order_relaxed);
+    if (atomic_load(&executor->sleepers) > 0) {
+        wake_workers(executor);
+    }
+    return true;
+}
+
+bool callback_executor_flush(callback_executor_t* executor) {
+    if (!executor || (current_worker && current_worker->executor == executor)) {
+        return false;
+    }
+    pthread_mutex_lock(&executor->lock);
+    while (atomic_load(&executor->outstanding) > 0) {
+        pthread_cond_wait(&executor->idle, &executor->lock);
+    }
+    pthread_mutex_unlock(&executor->lock);
+    return true;
+}
+
+void callback_executor_get_stats(callback_executor_t* executor, callback_executor_stats_t* stats) {
+    if (!executor || !stats) {
+        return;
+    }
+    stats->submitted = atomic_load_explicit(&executor->submitted, memory_order_relaxed);
+    stats->completed = atomic_load_explicit(&executor->completed, memory_order_relaxed);
+    stats->stolen = atomic_load_explicit(&executor->stolen, memory_order_relaxed);
+    stats->rejected = atomic_load_explicit(&executor->rejected, memory_order_relaxed);
+}
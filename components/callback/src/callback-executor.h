@@ -0,0 +1,146 @@
+/**
+ * MIT License
+ * Copyright (c) 2024 Grzegorz Grzęda
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CALLBACK_EXECUTOR_H
+#define CALLBACK_EXECUTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "callback.h"
+
+/**
+ * @defgroup callback_executor Callback executor
+ * @ingroup callback
+ * @brief Thread pool running callback handlers outside of the dispatching context
+ *
+ * Every worker thread owns a double-ended queue of tasks. A worker takes its newest task first and, when its
+ * own queue is empty, steals the oldest task of another worker. Tasks submitted from outside of the pool are
+ * spread over the queues in turns, tasks submitted from a handler running on a worker go to that worker's queue.
+ * @{
+ */
+#define CALLBACK_EXECUTOR_DEFAULT_WORKER_COUNT 4   /**< Default number of worker threads */
+#define CALLBACK_EXECUTOR_DEFAULT_QUEUE_DEPTH 1024 /**< Default number of tasks in each worker queue */
+
+/**
+ * @brief Callback executor type
+ *
+ * This is a declaration of the callback executor structure type. Use only by pointer.
+ */
+typedef struct callback_executor callback_executor_t;
+
+typedef struct callback_executor_config {
+    size_t worker_count; /**< Number of worker threads */
+    size_t queue_depth;  /**< Number of tasks in each worker queue */
+} callback_executor_config_t; /**< Callback executor configuration structure definition */
+
+typedef struct callback_executor_stats {
+    size_t submitted; /**< Number of tasks queued */
+    size_t completed; /**< Number of tasks run by the workers */
+    size_t stolen;    /**< Number of tasks taken from the queue of another worker */
+    size_t rejected;  /**< Number of tasks not queued because the queue was full */
+} callback_executor_stats_t; /**< Callback executor statistics structure definition */
+
+/**
+ * @brief Create the callback executor
+ * @param[in] config pointer to executor configuration, zeroed fields fall back to defaults, NULL for all defaults
+ * @return pointer to the newly created executor
+ * @return NULL if the executor could not be created
+ */
+callback_executor_t* callback_executor_create(const callback_executor_config_t* config);
+
+/**
+ * @brief Destroy the callback executor
+ *
+ * Queued tasks are run before the workers are stopped. No handler registered with the executor may be
+ * dispatched anymore.
+ * @param[in] executor pointer to the executor
+ */
+void callback_executor_destroy(callback_executor_t* executor);
+
+/**
+ * @brief Queue a handler call on the executor
+ *
+ * This function is thread safe.
+ * @param[in] executor pointer to the executor
+ * @param[in] handler pointer to the handler to be called on a worker thread
+ * @param[in] context pointer to some context for the handler
+ * @param[in] payload pointer to possible payload for the handler, it must stay valid until the handler ran
+ * @return true if the call was queued
+ * @return false if the handler was invalid or the queue is full
+ */
+bool callback_executor_submit(callback_executor_t* executor, callback_handler_t handler, void* context, void* payload);
+
+/**
+ * @brief Wait until every queued task has completed
+ *
+ * Tasks queued while waiting are waited for as well.
+ * @note It must not be called from a handler running on the executor.
+ * @param[in] executor pointer to the executor
+ * @return true if all tasks completed
+ * @return false if the executor was invalid or the call was made from one of its workers
+ */
+bool callback_executor_flush(callback_executor_t* executor);
+
+/**
+ * @brief Get the executor statistics
+ * @param[in] executor pointer to the executor
+ * @param[out] stats pointer to the statistics to be filled
+ */
+void callback_executor_get_stats(callback_executor_t* executor, callback_executor_stats_t* stats);
+
+/**
+ * @brief Register an new callback handler run on the executor
+ *
+ * The dispatch only queues the handler call and returns, the handler runs later on a worker thread. The payload
+ * must thus stay valid until the handler ran, e.g. until @ref callback_executor_flush returns. When the queue is
+ * full, the handler is called in the dispatching context instead. The handler has priority 0.
+ * The same threading rules as for @ref callback_register_handler apply.
+ *
+ * @param[in] callback pointer to the callback object
+ * @param[in] handler pointer to the actual callback handler
+ * @param[in] context pointer to some context for the callback handler
+ * @param[in] executor pointer to the executor running the handler
+ * @return true if registration was successfull
+ * @return false if handler or executor was invalid, the callback is frozen or no more memory to store it
+ */
+bool callback_register_async_handler(callback_t* callback,
+                                     callback_handler_t handler,
+                                     void* context,
+                                     callback_executor_t* executor);
+
+/**
+ * @brief Unregister a callback handler run on the executor
+ *
+ * The same rules as for @ref callback_unregister_handler apply. Calls already queued still run, flush the
+ * executor before releasing the handler context.
+ * @param[in] callback pointer to the callback object
+ * @param[in] handler pointer to the registered callback handler
+ * @param[in] context pointer to the context given at registration
+ * @return true if the handler was unregistered
+ * @return false if it was not registered, the callback is frozen or no more memory to store the handlers
+ */
+bool callback_unregister_async_handler(callback_t* callback, callback_handler_t handler, void* context);
+
+/**
+ * @}
+ */
+
+#endif  // CALLBACK_EXECUTOR_H
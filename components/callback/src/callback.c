@@ -20,48 +20,445 @@
  * SOFTWARE.
  */
 #include "callback.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdlib.h>
-#include "linked-list.h"
+#include <string.h>
+#include "callback-executor.h"
+#include "intrusive-list.h"
+
+typedef enum callback_entry_kind {
+    CALLBACK_ENTRY_PLAIN,    /* Never stops the dispatch */
+    CALLBACK_ENTRY_PRIORITY, /* Stops the dispatch of a handled payload */
+    CALLBACK_ENTRY_BATCH,    /* Receives all pending payloads of a batch in one call */
+    CALLBACK_ENTRY_ASYNC,    /* Runs on an executor worker */
+} callback_entry_kind_t;
 
 typedef struct callback_entry {
-    callback_handler_t handler;
+    union {
+        callback_handler_t plain;
+        callback_priority_handler_t priority;
+        callback_batch_handler_t batch;
+    } handler;
     void* context;
+    int priority;
+    callback_entry_kind_t kind;
+    callback_executor_t* executor;
 } callback_entry_t;
 
+/* Immutable array of handlers, replaced as a whole by every registration change (copy-on-write). */
+typedef struct callback_snapshot {
+    intrusive_list_node_t node; /* Links the snapshot into the retired list once replaced */
+    size_t retired_at;          /* Grace period counter value when the snapshot was replaced */
+    size_t count;
+    callback_entry_t entries[];
+} callback_snapshot_t;
+
+/*
+ * Dispatchers announce themselves in the reader counter of the current epoch. A replaced snapshot goes to the
+ * retired list, and writers advance the epoch whenever the readers of the previous one have drained. After two
+ * such advances no dispatcher can still see the replaced snapshot, so it is freed.
+ */
 typedef struct callback {
-    linked_list_t* list;
+    _Atomic(callback_snapshot_t*) snapshot;
+    atomic_bool frozen;
+    atomic_uint epoch;
+    atomic_size_t readers[2];
+    pthread_mutex_t lock; /* Serializes writers */
+    size_t grace_periods;
+    intrusive_list_t retired;
 } callback_t;
 
+/* Number of dispatches in progress on this thread, a writer called from a handler must not wait for readers. */
+static _Thread_local unsigned dispatch_depth;
+
+static callback_snapshot_t* snapshot_create(size_t count) {
+    callback_snapshot_t* snapshot = calloc(1, sizeof(callback_snapshot_t) + count * sizeof(callback_entry_t));
+    if (snapshot) {
+        snapshot->count = count;
+    }
+    return snapshot;
+}
+
+static unsigned read_lock(callback_t* callbacks) {
+    for (;;) {
+        unsigned epoch = atomic_load_explicit(&callbacks->epoch, memory_order_seq_cst);
+        atomic_fetch_add_explicit(&callbacks->readers[epoch], 1, memory_order_seq_cst);
+        /* A writer may have advanced the epoch in between, the reader must be counted where it will look. */
+        if (atomic_load_explicit(&callbacks->epoch, memory_order_seq_cst) == epoch) {
+            dispatch_depth++;
+            return epoch;
+        }
+        atomic_fetch_sub_explicit(&callbacks->readers[epoch], 1, memory_order_seq_cst);
+    }
+}
+
+static void read_unlock(callback_t* callbacks, unsigned epoch) {
+    dispatch_depth--;
+    atomic_fetch_sub_explicit(&callbacks->readers[epoch], 1, memory_order_release);
+}
+
+/* Must be called with the writer lock held. */
+static void reclaim(callback_t* callbacks) {
+    if (intrusive_list_is_empty(&callbacks->retired)) {
+        return;
+    }
+    unsigned epoch = atomic_load_explicit(&callbacks->epoch, memory_order_relaxed);
+    if (atomic_load_explicit(&callbacks->readers[epoch ^ 1], memory_order_seq_cst) == 0) {
+        atomic_store_explicit(&callbacks->epoch, epoch ^ 1, memory_order_seq_cst);
+        callbacks->grace_periods++;
+    }
+    intrusive_list_node_t* node;
+    intrusive_list_node_t* next;
+    INTRUSIVE_LIST_FOR_EACH_SAFE(&callbacks->retired, node, next) {
+        callback_snapshot_t* snapshot = intrusive_list_entry(node, callback_snapshot_t, node);
+        if (callbacks->grace_periods - snapshot->retired_at < 2) {
+            break;
+        }
+        intrusive_list_remove(node);
+        free(snapshot);
+    }
+}
+
+/* Must be called with the writer lock held, returns the grace period after which the replaced snapshot is freed. */
+static size_t publish(callback_t* callbacks, callback_snapshot_t* snapshot) {
+    callback_snapshot_t* old = atomic_exchange_explicit(&callbacks->snapshot, snapshot, memory_order_seq_cst);
+    old->retired_at = callbacks->grace_periods;
+    intrusive_list_push_back(&callbacks->retired, &old->node);
+    reclaim(callbacks);
+    return old->retired_at + 2;
+}
+
+/*
+ * Waits until the replaced snapshot is freed, so retired snapshots do not pile up while writers outpace the
+ * grace periods. The lock is released in between, handlers of the pending dispatches may still register.
+ * Writers called from a handler skip the wait, their own dispatch would never finish.
+ */
+static void synchronize(callback_t* callbacks, size_t grace_period) {
+    if (dispatch_depth > 0) {
+        return;
+    }
+    for (;;) {
+        pthread_mutex_lock(&callbacks->lock);
+        reclaim(callbacks);
+        bool done = (callbacks->grace_periods >= grace_period);
+        pthread_mutex_unlock(&callbacks->lock);
+        if (done) {
+            return;
+        }
+        sched_yield();
+    }
+}
+
 callback_t* callback_create(void) {
     callback_t* callbacks = calloc(1, sizeof(callback_t));
-    if (callbacks) {
-        callbacks->list = linked_list_create();
+    if (!callbacks) {
+        return NULL;
+    }
+    callback_snapshot_t* snapshot = snapshot_create(0);
+    if (!snapshot || pthread_mutex_init(&callbacks->lock, NULL) != 0) {
+        free(snapshot);
+        free(callbacks);
+        return NULL;
     }
+    atomic_init(&callbacks->snapshot, snapshot);
+    atomic_init(&callbacks->frozen, false);
+    atomic_init(&callbacks->epoch, 0);
+    atomic_init(&callbacks->readers[0], 0);
+    atomic_init(&callbacks->readers[1], 0);
+    intrusive_list_init(&callbacks->retired);
     return callbacks;
 }
 
+void callback_destroy(callback_t* callbacks) {
+    if (!callbacks) {
+        return;
+    }
+    intrusive_list_node_t* node;
+    intrusive_list_node_t* next;
+    INTRUSIVE_LIST_FOR_EACH_SAFE(&callbacks->retired, node, next) {
+        free(intrusive_list_entry(node, callback_snapshot_t, node));
+    }
+    free(atomic_load_explicit(&callbacks->snapshot, memory_order_relaxed));
+    pthread_mutex_destroy(&callbacks->lock);
+    free(callbacks);
+}
+
+/* Inserts the entry after all entries of the same or higher priority, so dispatch never has to sort. */
+static bool insert_entry(callback_t* callbacks, const callback_entry_t* entry) {
+    size_t grace_period = 0;
+    pthread_mutex_lock(&callbacks->lock);
+    callback_snapshot_t* old = atomic_load_explicit(&callbacks->snapshot, memory_order_relaxed);
+    callback_snapshot_t* snapshot = NULL;
+    if (!atomic_load_explicit(&callbacks->frozen, memory_order_relaxed)) {
+        snapshot = snapshot_create(old->count + 1);
+    }
+    if (snapshot) {
+        size_t index = 0;
+        while (index < old->count && old->entries[index].priority >= entry->priority) {
+            index++;
+        }
+        memcpy(snapshot->entries, old->entries, index * sizeof(callback_entry_t));
+        snapshot->entries[index] = *entry;
+        memcpy(&snapshot->entries[index + 1], &old->entries[index], (old->count - index) * sizeof(callback_entry_t));
+        grace_period = publish(callbacks, snapshot);
+    }
+    pthread_mutex_unlock(&callbacks->lock);
+    if (!snapshot) {
+        return false;
+    }
+    synchronize(callbacks, grace_period);
+    return true;
+}
+
+static bool same_entry(const callback_entry_t* a, const callback_entry_t* b) {
+    if (a->kind != b->kind || a->context != b->context) {
+        return false;
+    }
+    switch (a->kind) {
+        case CALLBACK_ENTRY_PLAIN:
+        case CALLBACK_ENTRY_ASYNC:
+            return a->handler.plain == b->handler.plain;
+        case CALLBACK_ENTRY_PRIORITY:
+            return a->handler.priority == b->handler.priority;
+        case CALLBACK_ENTRY_BATCH:
+            return a->handler.batch == b->handler.batch;
+    }
+    return false;
+}
+
+/* Removes the first entry with the same handler and context. */
+static bool remove_entry(callback_t* callbacks, const callback_entry_t* entry) {
+    bool result = false;
+    size_t grace_period = 0;
+    pthread_mutex_lock(&callbacks->lock);
+    callback_snapshot_t* old = atomic_load_explicit(&callbacks->snapshot, memory_order_relaxed);
+    size_t index = 0;
+    while (index < old->count && !same_entry(&old->entries[index], entry)) {
+        index++;
+    }
+    if (index < old->count && !atomic_load_explicit(&callbacks->frozen, memory_order_relaxed)) {
+        callback_snapshot_t* snapshot = snapshot_create(old->count - 1);
+        if (snapshot) {
+            memcpy(snapshot->entries, old->entries, index * sizeof(callback_entry_t));
+            memcpy(&snapshot->entries[index],
+                   &old->entries[index + 1],
+                   (old->count - index - 1) * sizeof(callback_entry_t));
+            grace_period = publish(callbacks, snapshot);
+            result = true;
+        }
+    }
+    pthread_mutex_unlock(&callbacks->lock);
+    if (result) {
+        synchronize(callbacks, grace_period);
+    }
+    return result;
+}
+
 bool callback_register_handler(callback_t* callbacks, callback_handler_t handler, void* context) {
     if (!callbacks || !handler) {
         return false;
     }
-    callback_entry_t* entry = calloc(1, sizeof(callback_entry_t));
-    if (!entry) {
+    callback_entry_t entry = {.handler.plain = handler, .context = context, .kind = CALLBACK_ENTRY_PLAIN};
+    return insert_entry(callbacks, &entry);
+}
+
+bool callback_register_priority_handler(callback_t* callbacks,
+                                        callback_priority_handler_t handler,
+                                        void* context,
+                                        int priority) {
+    if (!callbacks || !handler) {
+        return false;
+    }
+    callback_entry_t entry = {
+        .handler.priority = handler, .context = context, .priority = priority, .kind = CALLBACK_ENTRY_PRIORITY};
+    return insert_entry(callbacks, &entry);
+}
+
+bool callback_register_batch_handler(callback_t* callbacks, callback_batch_handler_t handler, void* context) {
+    if (!callbacks || !handler) {
+        return false;
+    }
+    callback_entry_t entry = {.handler.batch = handler, .context = context, .kind = CALLBACK_ENTRY_BATCH};
+    return insert_entry(callbacks, &entry);
+}
+
+bool callback_unregister_handler(callback_t* callbacks, callback_handler_t handler, void* context) {
+    if (!callbacks || !handler) {
+        return false;
+    }
+    callback_entry_t entry = {.handler.plain = handler, .context = context, .kind = CALLBACK_ENTRY_PLAIN};
+    return remove_entry(callbacks, &entry);
+}
+
+bool callback_unregister_priority_handler(callback_t* callbacks, callback_priority_handler_t handler, void* context) {
+    if (!callbacks || !handler) {
+        return false;
+    }
+    callback_entry_t entry = {.handler.priority = handler, .context = context, .kind = CALLBACK_ENTRY_PRIORITY};
+    return remove_entry(callbacks, &entry);
+}
+
+bool callback_unregister_batch_handler(callback_t* callbacks, callback_batch_handler_t handler, void* context) {
+    if (!callbacks || !handler) {
+        return false;
+    }
+    callback_entry_t entry = {.handler.batch = handler, .context = context, .kind = CALLBACK_ENTRY_BATCH};
+    return remove_entry(callbacks, &entry);
+}
+
+bool callback_register_async_handler(callback_t* callbacks,
+                                     callback_handler_t handler,
+                                     void* context,
+                                     callback_executor_t* executor) {
+    if (!callbacks || !handler || !executor) {
+        return false;
+    }
+    callback_entry_t entry = {
+        .handler.plain = handler, .context = context, .kind = CALLBACK_ENTRY_ASYNC, .executor = executor};
+    return insert_entry(callbacks, &entry);
+}
+
+bool callback_unregister_async_handler(callback_t* callbacks, callback_handler_t handler, void* context) {
+    if (!callbacks || !handler) {
+        return false;
+    }
+    callback_entry_t entry = {.handler.plain = handler, .context = context, .kind = CALLBACK_ENTRY_ASYNC};
+    return remove_entry(callbacks, &entry);
+}
+
+bool callback_freeze(callback_t* callbacks) {
+    if (!callbacks) {
         return false;
     }
-    entry->handler = handler;
-    entry->context = context;
-    linked_list_append(callbacks->list, entry);
+    pthread_mutex_lock(&callbacks->lock);
+    atomic_store_explicit(&callbacks->frozen, true, memory_order_release);
+    reclaim(callbacks);
+    pthread_mutex_unlock(&callbacks->lock);
     return true;
 }
 
-void callback_dispatch(callback_t* callbacks, void* payload) {
+bool callback_is_frozen(const callback_t* callbacks) {
+    return callbacks && atomic_load_explicit(&callbacks->frozen, memory_order_acquire);
+}
+
+/* A full executor applies backpressure, the handler runs in the dispatching context. */
+static void run_async(const callback_entry_t* entry, void* payload) {
+    if (!callback_executor_submit(entry->executor, entry->handler.plain, entry->context, payload)) {
+        entry->handler.plain(entry->context, payload);
+    }
+}
+
+static bool dispatch(const callback_snapshot_t* snapshot, void* payload) {
+    const callback_entry_t* entries = snapshot->entries;
+    const size_t count = snapshot->count;
+    for (size_t i = 0; i < count; i++) {
+        switch (entries[i].kind) {
+            case CALLBACK_ENTRY_PLAIN:
+                entries[i].handler.plain(entries[i].context, payload);
+                break;
+            case CALLBACK_ENTRY_PRIORITY:
+                if (entries[i].handler.priority(entries[i].context, payload)) {
+                    return true;
+                }
+                break;
+            case CALLBACK_ENTRY_BATCH:
+                entries[i].handler.batch(entries[i].context, &payload, 1);
+                break;
+            case CALLBACK_ENTRY_ASYNC:
+                run_async(&entries[i], payload);
+                break;
+        }
+    }
+    return false;
+}
+
+/*
+ * Handler-major loop over one chunk: each handler runs over all pending payloads before the next one starts,
+ * so its code and context stay hot. Payloads handled by a priority handler are dropped from the pending array.
+ */
+static size_t dispatch_chunk(const callback_snapshot_t* snapshot, void* const* payloads, size_t count) {
+    void* pending[CALLBACK_BATCH_CHUNK_SIZE];
+    memcpy(pending, payloads, count * sizeof(void*));
+    size_t remaining = count;
+    const callback_entry_t* entries = snapshot->entries;
+    const size_t entries_count = snapshot->count;
+    for (size_t i = 0; i < entries_count && remaining > 0; i++) {
+        switch (entries[i].kind) {
+            case CALLBACK_ENTRY_PLAIN:
+                for (size_t j = 0; j < remaining; j++) {
+                    entries[i].handler.plain(entries[i].context, pending[j]);
+                }
+                break;
+            case CALLBACK_ENTRY_PRIORITY: {
+                size_t kept = 0;
+                for (size_t j = 0; j < remaining; j++) {
+                    if (!entries[i].handler.priority(entries[i].context, pending[j])) {
+                        pending[kept++] = pending[j];
+                    }
+                }
+                remaining = kept;
+                break;
+            }
+            case CALLBACK_ENTRY_BATCH:
+                entries[i].handler.batch(entries[i].context, pending, remaining);
+                break;
+            case CALLBACK_ENTRY_ASYNC:
+                for (size_t j = 0; j < remaining; j++) {
+                    run_async(&entries[i], pending[j]);
+                }
+                break;
+        }
+    }
+    return count - remaining;
+}
+
+static size_t dispatch_batch(const callback_snapshot_t* snapshot, void* const* payloads, size_t count) {
+    size_t handled = 0;
+    for (size_t offset = 0; offset < count; offset += CALLBACK_BATCH_CHUNK_SIZE) {
+        size_t chunk = count - offset;
+        if (chunk > CALLBACK_BATCH_CHUNK_SIZE) {
+            chunk = CALLBACK_BATCH_CHUNK_SIZE;
+        }
+        handled += dispatch_chunk(snapshot, &payloads[offset], chunk);
+    }
+    return handled;
+}
+
+bool callback_dispatch(callback_t* callbacks, void* payload) {
     if (!callbacks) {
+        return false;
+    }
+    /* A frozen snapshot is never replaced, so it can be used without announcing the reader. */
+    if (atomic_load_explicit(&callbacks->frozen, memory_order_acquire)) {
+        return dispatch(atomic_load_explicit(&callbacks->snapshot, memory_order_relaxed), payload);
+    }
+    unsigned epoch = read_lock(callbacks);
+    bool handled = dispatch(atomic_load_explicit(&callbacks->snapshot, memory_order_seq_cst), payload);
+    read_unlock(callbacks, epoch);
+    return handled;
+}
+
+size_t callback_dispatch_batch(callback_t* callbacks, void* const* payloads, size_t count) {
+    if (!callbacks || (!payloads && count > 0)) {
+        return 0;
+    }
+    if (atomic_load_explicit(&callbacks->frozen, memory_order_acquire)) {
+        return dispatch_batch(atomic_load_explicit(&callbacks->snapshot, memory_order_relaxed), payloads, count);
+    }
+    unsigned epoch = read_lock(callbacks);
+    size_t handled = dispatch_batch(atomic_load_explicit(&callbacks->snapshot, memory_order_seq_cst), payloads, count);
+    read_unlock(callbacks, epoch);
+    return handled;
+}
+
+void callback_static_dispatch(const callback_static_t* callback, void* payload) {
+    if (!callback) {
         return;
     }
-    for (linked_list_iterator_t* it = linked_list_iterator_begin(callbacks->list); it;
-         it = linked_list_iterator_next(it)) {
-        callback_entry_t* entry = linked_list_get(it);
-        entry->handler(entry->context, payload);
+    for (size_t i = 0; i < callback->count; i++) {
+        callback->entries[i].handler(callback->entries[i].context, payload);
     }
 }
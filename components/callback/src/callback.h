@@ -23,6 +23,7 @@
 #define CALLBACK_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -40,6 +41,32 @@
  */
 typedef void (*callback_handler_t)(void* context, void* payload);
 
+/**
+ * @brief Priority callback handler type
+ *
+ * This is a callback pointer which can stop the dispatch.
+ * @param[in] context pointer to some context passed during registration
+ * @param[in] payload pointer to some payload associated with the event ID
+ * @return true if the payload was handled and no further handlers shall be called
+ * @return false to pass the payload on to the next handler
+ */
+typedef bool (*callback_priority_handler_t)(void* context, void* payload);
+
+/**
+ * @brief Maximum number of payloads passed to a batch handler in one call
+ */
+#define CALLBACK_BATCH_CHUNK_SIZE (64)
+
+/**
+ * @brief Batch callback handler type
+ *
+ * This is a callback pointer receiving many payloads in one call.
+ * @param[in] context pointer to some context passed during registration
+ * @param[in] payloads array of payload pointers
+ * @param[in] count number of payloads in the array
+ */
+typedef void (*callback_batch_handler_t)(void* context, void* const* payloads, size_t count);
+
 /**
  * @brief Callback structure type
  *
@@ -52,25 +79,112 @@ typedef struct callback callback_t;
  */
 callback_t* callback_create(void);
 
+/**
+ * @brief Destroy the callback and all its handler registrations
+ * @note No dispatch may be in progress on the callback.
+ * @param[in] callback pointer to the callback structure
+ */
+void callback_destroy(callback_t* callback);
+
 /**
  * @brief Register an new callback handler
  *
- * @note This function is not thread safe! Consider registering all handlers in
- * the initialization part of your project.
+ * Handlers can be registered at any time, also from other threads or handlers while dispatches are in progress.
+ * Dispatches that already started do not call the new handler. Outside of a handler the call returns once the
+ * dispatches that started before it have finished and the previous handlers array is freed.
  *
  * @param[in] callback pointer to the callback object
  * @param[in] handler pointer to the actual callback handler
  * @param[in] context pointer to some context for the callback handler
  * @return true if registration was successfull
- * @return false if handler was invalid or no more memory to store it
+ * @return false if handler was invalid, the callback is frozen or no more memory to store it
  */
 bool callback_register_handler(callback_t* callback, callback_handler_t handler, void* context);
 
+/**
+ * @brief Unregister a callback handler
+ *
+ * Removes the first registration with the same handler and context. It can be called at any time, also from
+ * other threads or from the handler itself while dispatches are in progress. Dispatches that already started
+ * may still call the handler once, the dispatches started after the return do not. Outside of a handler the
+ * call returns once those dispatches have finished, so the handler context can be released right after it.
+ *
+ * @param[in] callback pointer to the callback object
+ * @param[in] handler pointer to the registered callback handler
+ * @param[in] context pointer to the context given at registration
+ * @return true if the handler was unregistered
+ * @return false if it was not registered, the callback is frozen or no more memory to store the handlers
+ */
+bool callback_unregister_handler(callback_t* callback, callback_handler_t handler, void* context);
+
+/**
+ * @brief Register a new callback handler with a priority
+ *
+ * Handlers are called from the highest priority down, handlers of equal priority in registration order.
+ * Plain handlers have priority 0. The order is resolved here, so the dispatch does no sorting.
+ * The same threading rules as for @ref callback_register_handler apply.
+ *
+ * @param[in] callback pointer to the callback object
+ * @param[in] handler pointer to the actual callback handler, returning true stops the dispatch
+ * @param[in] context pointer to some context for the callback handler
+ * @param[in] priority priority of the handler
+ * @return true if registration was successfull
+ * @return false if handler was invalid, the callback is frozen or no more memory to store it
+ */
+bool callback_register_priority_handler(callback_t* callback,
+                                        callback_priority_handler_t handler,
+                                        void* context,
+                                        int priority);
+
+/**
+ * @brief Unregister a priority callback handler
+ *
+ * The same rules as for @ref callback_unregister_handler apply.
+ * @param[in] callback pointer to the callback object
+ * @param[in] handler pointer to the registered callback handler
+ * @param[in] context pointer to the context given at registration
+ * @return true if the handler was unregistered
+ * @return false if it was not registered, the callback is frozen or no more memory to store the handlers
+ */
+bool callback_unregister_priority_handler(callback_t* callback, callback_priority_handler_t handler, void* context);
+
+/**
+ * @brief Register a new batch callback handler
+ *
+ * A batch handler has priority 0. `callback_dispatch_batch` passes it all payloads of a batch which are not
+ * handled yet, in chunks of up to @ref CALLBACK_BATCH_CHUNK_SIZE, and `callback_dispatch` passes it a single
+ * payload array.
+ * The same threading rules as for @ref callback_register_handler apply.
+ *
+ * @param[in] callback pointer to the callback object
+ * @param[in] handler pointer to the actual callback handler
+ * @param[in] context pointer to some context for the callback handler
+ * @return true if registration was successfull
+ * @return false if handler was invalid, the callback is frozen or no more memory to store it
+ */
+bool callback_register_batch_handler(callback_t* callback, callback_batch_handler_t handler, void* context);
+
+/**
+ * @brief Unregister a batch callback handler
+ *
+ * The same rules as for @ref callback_unregister_handler apply.
+ * @param[in] callback pointer to the callback object
+ * @param[in] handler pointer to the registered callback handler
+ * @param[in] context pointer to the context given at registration
+ * @return true if the handler was unregistered
+ * @return false if it was not registered, the callback is frozen or no more memory to store the handlers
+ */
+bool callback_unregister_batch_handler(callback_t* callback, callback_batch_handler_t handler, void* context);
+
 /**
  * @brief Dispatch callback
  *
- * It calls each handler registered.
- * @note This code is platform-agnostic. If this function was called from e.g.
+ * It calls the handlers registered in priority order, until a priority handler reports the payload as handled.
+ * Dispatching never takes a lock, it works on an immutable snapshot of the
+ * handlers array which registration changes replace.
+ * @note The library is not platform-agnostic: it requires C11 atomics, `_Thread_local` and POSIX
+ * threads, and links `Threads::Threads`. Registration changes are serialized with a pthread mutex, dispatching
+ * only uses atomics, apart from handing payloads to an executor. If this function was called from e.g.
  * - ISR
  * - another thread
  * It is the handlers job to cross thread/interrupt barriers correctly (e.g. through queues, semaphores etc.).
@@ -78,8 +192,83 @@ bool callback_register_handler(callback_t* callback, callback_handler_t handler,
  *
  * @param[in] callback pointer to the callback object
  * @param[in] payload pointer to possible payload associated with the event ID
+ * @return true if a priority handler handled the payload
+ * @return false if all handlers were called
+ */
+bool callback_dispatch(callback_t* callback, void* payload);
+
+/**
+ * @brief Dispatch callback for many payloads
+ *
+ * Same as calling @ref callback_dispatch for each payload, but the handlers are walked once per chunk of
+ * @ref CALLBACK_BATCH_CHUNK_SIZE payloads: each handler is called for all payloads of the chunk before the next
+ * handler, and batch handlers get the payloads in one call. Payloads handled by a priority handler are not passed
+ * to the later handlers. The order of the calls thus differs from separate dispatches, the order seen by each
+ * handler does not.
+ *
+ * @param[in] callback pointer to the callback object
+ * @param[in] payloads array of payload pointers
+ * @param[in] count number of payloads in the array
+ * @return number of payloads handled by a priority handler
+ */
+size_t callback_dispatch_batch(callback_t* callback, void* const* payloads, size_t count);
+
+/**
+ * @brief Freeze the callback handlers
+ *
+ * Seals the registered handlers, no more handlers can be registered or unregistered afterwards. The handlers
+ * array is then never replaced, so `callback_dispatch` skips the reader accounting on every call.
+ * Freezing an already frozen callback does nothing.
+ *
+ * @param[in] callback pointer to the callback object
+ * @return true if the callback is frozen
+ * @return false if the callback was invalid
+ */
+bool callback_freeze(callback_t* callback);
+
+/**
+ * @brief Check if the callback handlers are frozen
+ * @param[in] callback pointer to the callback object
+ * @return true if @ref callback_freeze succeeded on the callback
+ */
+bool callback_is_frozen(const callback_t* callback);
+
+typedef struct callback_static_entry {
+    callback_handler_t handler; /**< Callback handler */
+    void* context;              /**< Context passed to the handler */
+} callback_static_entry_t; /**< Static callback handler entry definition */
+
+typedef struct callback_static {
+    const callback_static_entry_t* entries; /**< Handlers in dispatch order */
+    size_t count;                           /**< Number of handlers */
+} callback_static_t; /**< Static callback definition */
+
+/**
+ * @brief Define a single static handler entry
+ * @param handler pointer to the actual callback handler
+ * @param context pointer to some context with static storage duration
+ */
+#define CALLBACK_STATIC_ENTRY(handler, context) {(handler), (context)}
+
+/**
+ * @brief Define a const callback object with a fixed set of handlers
+ *
+ * The handlers are placed in read-only memory, so no heap is used and no registration is needed at startup.
+ * @param name name of the callback object
+ * @param ... handler entries defined with @ref CALLBACK_STATIC_ENTRY
+ */
+#define CALLBACK_STATIC_DEFINE(name, ...)                                  \
+    static const callback_static_entry_t name##_entries[] = {__VA_ARGS__}; \
+    const callback_static_t name = {name##_entries, sizeof(name##_entries) / sizeof(name##_entries[0])}
+
+/**
+ * @brief Dispatch static callback
+ *
+ * It calls each handler of the static callback in the order of definition, in the caller context.
+ * @param[in] callback pointer to the static callback object
+ * @param[in] payload pointer to possible payload
  */
-void callback_dispatch(callback_t* callback, void* payload);
+void callback_static_dispatch(const callback_static_t* callback, void* payload);
 
 /**
  * @}
@@ -20,10 +20,15 @@
  * SOFTWARE.
  */
 #include "callback.h"
+#include <pthread.h>
+#include <sched.h>
 #include <setjmp.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "callback-executor.h"
 #include "cmocka.h"
 
 static void test_callback_handler(void* context, void* payload) {
@@ -42,6 +47,7 @@ static void test_create_callbacks(void** state) {
     (void)state;  // unused
     callback_t* cbs = callback_create();
     assert_ptr_not_equal(cbs, NULL);
+    callback_destroy(cbs);
 }
 
 static void test_register_invalid_callback(void** state) {
@@ -50,6 +56,7 @@ static void test_register_invalid_callback(void** state) {
     callback_t* cbs = callback_create();
     assert_false(callback_register_handler(cbs, NULL, NULL));
     callback_dispatch(NULL, NULL);
+    callback_destroy(cbs);
 }
 
 static void test_register_callbacks(void** state) {
@@ -84,6 +91,413 @@ static void test_register_callbacks(void** state) {
     expect_value(test_another_callback_handler, context, &some_context);
     expect_value(test_another_callback_handler, payload, &some_payload);
     callback_dispatch(cbs, &some_payload);
+    callback_destroy(cbs);
+}
+
+static void test_freeze_callbacks(void** state) {
+    (void)state;  // unused
+    callback_t* cbs = callback_create();
+    uint8_t some_context;
+    uint8_t some_payload;
+
+    assert_false(callback_freeze(NULL));
+    assert_true(callback_register_handler(cbs, test_callback_handler, &some_context));
+    assert_true(callback_register_handler(cbs, test_another_callback_handler, NULL));
+    assert_false(callback_is_frozen(cbs));
+    assert_true(callback_freeze(cbs));
+    assert_true(callback_is_frozen(cbs));
+    assert_true(callback_freeze(cbs));
+    assert_false(callback_register_handler(cbs, test_callback_handler, NULL));
+    assert_false(callback_unregister_handler(cbs, test_callback_handler, &some_context));
+
+    expect_function_call(test_callback_handler);
+    expect_value(test_callback_handler, context, &some_context);
+    expect_value(test_callback_handler, payload, &some_payload);
+    expect_function_call(test_another_callback_handler);
+    expect_value(test_another_callback_handler, context, NULL);
+    expect_value(test_another_callback_handler, payload, &some_payload);
+    callback_dispatch(cbs, &some_payload);
+    callback_destroy(cbs);
+
+    cbs = callback_create();
+    assert_true(callback_freeze(cbs));
+    callback_dispatch(cbs, &some_payload);
+    callback_destroy(cbs);
+}
+
+static void test_unregister_callbacks(void** state) {
+    (void)state;  // unused
+    callback_t* cbs = callback_create();
+    uint8_t some_context;
+    uint8_t some_payload;
+
+    assert_false(callback_unregister_handler(NULL, test_callback_handler, NULL));
+    assert_false(callback_unregister_handler(cbs, test_callback_handler, NULL));
+    assert_true(callback_register_handler(cbs, test_callback_handler, NULL));
+    assert_true(callback_register_handler(cbs, test_callback_handler, &some_context));
+    assert_true(callback_register_handler(cbs, test_another_callback_handler, &some_context));
+    assert_false(callback_unregister_handler(cbs, test_another_callback_handler, NULL));
+    assert_true(callback_unregister_handler(cbs, test_callback_handler, &some_context));
+
+    expect_function_call(test_callback_handler);
+    expect_value(test_callback_handler, context, NULL);
+    expect_value(test_callback_handler, payload, &some_payload);
+    expect_function_call(test_another_callback_handler);
+    expect_value(test_another_callback_handler, context, &some_context);
+    expect_value(test_another_callback_handler, payload, &some_payload);
+    callback_dispatch(cbs, &some_payload);
+
+    assert_true(callback_unregister_handler(cbs, test_callback_handler, NULL));
+    assert_true(callback_unregister_handler(cbs, test_another_callback_handler, &some_context));
+    callback_dispatch(cbs, &some_payload);
+    callback_destroy(cbs);
+}
+
+typedef struct self_removing {
+    callback_t* cbs;
+    int calls;
+} self_removing_t;
+
+static void self_removing_handler(void* context, void* payload) {
+    (void)payload;
+    self_removing_t* self = context;
+    self->calls++;
+    assert_true(callback_unregister_handler(self->cbs, self_removing_handler, self));
+}
+
+static void test_unregister_from_handler(void** state) {
+    (void)state;  // unused
+    callback_t* cbs = callback_create();
+    self_removing_t first = {cbs, 0};
+    self_removing_t second = {cbs, 0};
+    assert_true(callback_register_handler(cbs, self_removing_handler, &first));
+    assert_true(callback_register_handler(cbs, self_removing_handler, &second));
+    callback_dispatch(cbs, NULL);
+    callback_dispatch(cbs, NULL);
+    assert_int_equal(first.calls, 1);
+    assert_int_equal(second.calls, 1);
+    callback_destroy(cbs);
+}
+
+typedef struct priority_record {
+    int order[8];
+    size_t count;
+} priority_record_t;
+
+typedef struct priority_context {
+    priority_record_t* record;
+    int id;
+    bool handles;
+} priority_context_t;
+
+static bool priority_handler(void* context, void* payload) {
+    priority_context_t* self = context;
+    (void)payload;
+    self->record->order[self->record->count++] = self->id;
+    return self->handles;
+}
+
+static void plain_handler(void* context, void* payload) {
+    priority_handler(context, payload);
+}
+
+static void test_priority_callbacks(void** state) {
+    (void)state;  // unused
+    callback_t* cbs = callback_create();
+    priority_record_t record = {0};
+    priority_context_t low = {&record, 1, false};
+    priority_context_t plain = {&record, 2, false};
+    priority_context_t high = {&record, 3, false};
+    priority_context_t same_high = {&record, 4, false};
+    priority_context_t handling = {&record, 5, true};
+
+    assert_false(callback_register_priority_handler(cbs, NULL, NULL, 0));
+    assert_true(callback_register_priority_handler(cbs, priority_handler, &low, -10));
+    assert_true(callback_register_handler(cbs, plain_handler, &plain));
+    assert_true(callback_register_priority_handler(cbs, priority_handler, &high, 10));
+    assert_true(callback_register_priority_handler(cbs, priority_handler, &same_high, 10));
+    assert_false(callback_dispatch(cbs, NULL));
+    assert_int_equal(record.count, 4);
+    assert_memory_equal(record.order, ((int[]){3, 4, 2, 1}), 4 * sizeof(int));
+
+    record.count = 0;
+    assert_true(callback_register_priority_handler(cbs, priority_handler, &handling, 5));
+    assert_true(callback_dispatch(cbs, NULL));
+    assert_int_equal(record.count, 3);
+    assert_memory_equal(record.order, ((int[]){3, 4, 5}), 3 * sizeof(int));
+
+    record.count = 0;
+    assert_false(callback_unregister_handler(cbs, plain_handler, &handling));
+    assert_true(callback_unregister_priority_handler(cbs, priority_handler, &handling));
+    assert_false(callback_unregister_priority_handler(cbs, priority_handler, &handling));
+    assert_true(callback_freeze(cbs));
+    assert_false(callback_dispatch(cbs, NULL));
+    assert_int_equal(record.count, 4);
+    callback_destroy(cbs);
+}
+
+#define BATCH_PAYLOADS (100)
+
+typedef struct batch_record {
+    size_t calls;
+    size_t payloads;
+    uintptr_t sum;
+} batch_record_t;
+
+static void batch_plain_handler(void* context, void* payload) {
+    batch_record_t* record = context;
+    record->calls++;
+    record->payloads++;
+    record->sum += (uintptr_t)payload;
+}
+
+static bool batch_even_handler(void* context, void* payload) {
+    batch_plain_handler(context, payload);
+    return ((uintptr_t)payload % 2) == 0;
+}
+
+static void batch_handler(void* context, void* const* payloads, size_t count) {
+    batch_record_t* record = context;
+    assert_true(count <= CALLBACK_BATCH_CHUNK_SIZE);
+    record->calls++;
+    record->payloads += count;
+    for (size_t i = 0; i < count; i++) {
+        record->sum += (uintptr_t)payloads[i];
+    }
+}
+
+static void test_batch_callbacks(void** state) {
+    (void)state;  // unused
+    callback_t* cbs = callback_create();
+    void* payloads[BATCH_PAYLOADS];
+    uintptr_t sum = 0;
+    uintptr_t odd_sum = 0;
+    for (uintptr_t i = 0; i < BATCH_PAYLOADS; i++) {
+        payloads[i] = (void*)(i + 1);
+        sum += i + 1;
+        odd_sum += ((i + 1) % 2 ? i + 1 : 0);
+    }
+    batch_record_t plain = {0};
+    batch_record_t even = {0};
+    batch_record_t batch = {0};
+
+    assert_int_equal(callback_dispatch_batch(NULL, payloads, BATCH_PAYLOADS), 0);
+    assert_int_equal(callback_dispatch_batch(cbs, NULL, 1), 0);
+    assert_false(callback_register_batch_handler(cbs, NULL, NULL));
+    assert_true(callback_register_handler(cbs, batch_plain_handler, &plain));
+    assert_true(callback_register_priority_handler(cbs, batch_even_handler, &even, 0));
+    assert_true(callback_register_batch_handler(cbs, batch_handler, &batch));
+
+    assert_int_equal(callback_dispatch_batch(cbs, payloads, BATCH_PAYLOADS), BATCH_PAYLOADS / 2);
+    assert_int_equal(plain.payloads, BATCH_PAYLOADS);
+    assert_int_equal(plain.sum, sum);
+    assert_int_equal(even.payloads, BATCH_PAYLOADS);
+    assert_int_equal(batch.calls, 2);
+    assert_int_equal(batch.payloads, BATCH_PAYLOADS / 2);
+    assert_int_equal(batch.sum, odd_sum);
+
+    assert_false(callback_dispatch(cbs, payloads[0]));
+    assert_int_equal(batch.calls, 3);
+    assert_int_equal(batch.sum, odd_sum + 1);
+
+    assert_true(callback_unregister_batch_handler(cbs, batch_handler, &batch));
+    assert_false(callback_unregister_batch_handler(cbs, batch_handler, &batch));
+    assert_int_equal(callback_dispatch_batch(cbs, payloads, 0), 0);
+    callback_destroy(cbs);
+}
+
+#define ASYNC_PAYLOADS (1000)
+
+typedef struct async_record {
+    callback_executor_t* executor;
+    pthread_t caller;
+    atomic_size_t calls;
+    atomic_size_t foreign_calls;
+    atomic_size_t children;
+    atomic_bool started;
+    atomic_bool gate;
+} async_record_t;
+
+static void async_record_init(async_record_t* record, callback_executor_t* executor) {
+    record->executor = executor;
+    record->caller = pthread_self();
+    atomic_init(&record->calls, 0);
+    atomic_init(&record->foreign_calls, 0);
+    atomic_init(&record->children, 0);
+    atomic_init(&record->started, false);
+    atomic_init(&record->gate, true);
+}
+
+static void async_child_handler(void* context, void* payload) {
+    (void)payload;
+    atomic_fetch_add(&((async_record_t*)context)->children, 1);
+}
+
+static void async_handler(void* context, void* payload) {
+    async_record_t* record = context;
+    atomic_fetch_add(&record->calls, 1);
+    if (!pthread_equal(pthread_self(), record->caller)) {
+        atomic_store(&record->started, true);
+        while (!atomic_load(&record->gate)) {
+            sched_yield();
+        }
+        atomic_fetch_add(&record->foreign_calls, 1);
+    }
+    if (payload) {
+        assert_false(callback_executor_flush(record->executor));
+        assert_true(callback_executor_submit(record->executor, async_child_handler, record, NULL));
+    }
+}
+
+static void test_async_callbacks(void** state) {
+    (void)state;  // unused
+    callback_executor_t* executor = callback_executor_create(NULL);
+    assert_ptr_not_equal(executor, NULL);
+    callback_t* cbs = callback_create();
+    async_record_t record;
+    async_record_init(&record, executor);
+    uint8_t some_context;
+
+    assert_false(callback_register_async_handler(cbs, async_handler, &record, NULL));
+    assert_true(callback_register_async_handler(cbs, async_handler, &record, executor));
+    assert_true(callback_register_handler(cbs, test_callback_handler, &some_context));
+    assert_false(callback_unregister_handler(cbs, async_handler, &record));
+    for (size_t i = 0; i < ASYNC_PAYLOADS; i++) {
+        expect_function_call(test_callback_handler);
+        expect_value(test_callback_handler, context, &some_context);
+        expect_value(test_callback_handler, payload, &some_context);
+        assert_false(callback_dispatch(cbs, &some_context));
+    }
+    assert_true(callback_executor_flush(executor));
+    assert_int_equal(atomic_load(&record.calls), ASYNC_PAYLOADS);
+    assert_int_equal(atomic_load(&record.foreign_calls), ASYNC_PAYLOADS);
+    assert_int_equal(atomic_load(&record.children), ASYNC_PAYLOADS);
+
+    callback_executor_stats_t stats;
+    callback_executor_get_stats(executor, &stats);
+    assert_int_equal(stats.submitted, 2 * ASYNC_PAYLOADS);
+    assert_int_equal(stats.completed, 2 * ASYNC_PAYLOADS);
+    assert_int_equal(stats.rejected, 0);
+
+    assert_true(callback_unregister_async_handler(cbs, async_handler, &record));
+    callback_destroy(cbs);
+    callback_executor_destroy(executor);
+}
+
+static void test_async_callbacks_backpressure(void** state) {
+    (void)state;  // unused
+    callback_executor_t* executor = callback_executor_create(&(callback_executor_config_t){1, 1});
+    callback_t* cbs = callback_create();
+    async_record_t record;
+    async_record_init(&record, executor);
+    assert_true(callback_register_async_handler(cbs, async_handler, &record, executor));
+
+    /* The only worker is blocked in the first call and the queue holds the second, the third runs inline. */
+    atomic_store(&record.gate, false);
+    callback_dispatch(cbs, NULL);
+    while (!atomic_load(&record.started)) {
+        sched_yield();
+    }
+    callback_dispatch(cbs, NULL);
+    callback_dispatch(cbs, NULL);
+    assert_int_equal(atomic_load(&record.calls), 2);
+    atomic_store(&record.gate, true);
+    assert_true(callback_executor_flush(executor));
+    assert_int_equal(atomic_load(&record.calls), 3);
+    assert_int_equal(atomic_load(&record.foreign_calls), 2);
+
+    callback_executor_stats_t stats;
+    callback_executor_get_stats(executor, &stats);
+    assert_int_equal(stats.submitted, 2);
+    assert_int_equal(stats.rejected, 1);
+    callback_destroy(cbs);
+    callback_executor_destroy(executor);
+}
+
+#define STRESS_DISPATCHERS (4)
+#define STRESS_HANDLERS (8)
+#define STRESS_ROUNDS (500)
+
+typedef struct stress {
+    callback_t* cbs;
+    atomic_bool done;
+    atomic_size_t calls[STRESS_HANDLERS];
+} stress_t;
+
+static void stress_handler(void* context, void* payload) {
+    atomic_fetch_add_explicit((atomic_size_t*)context, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit((atomic_size_t*)payload, 1, memory_order_relaxed);
+}
+
+static void* stress_dispatcher(void* argument) {
+    stress_t* stress = argument;
+    atomic_size_t calls;
+    atomic_init(&calls, 0);
+    /* Yielding keeps the writer progressing when there are fewer cores than threads. */
+    while (!atomic_load(&stress->done)) {
+        callback_dispatch(stress->cbs, &calls);
+        sched_yield();
+    }
+    return NULL;
+}
+
+static void test_unregister_during_dispatch(void** state) {
+    (void)state;  // unused
+    stress_t stress = {.cbs = callback_create()};
+    atomic_init(&stress.done, false);
+    for (size_t i = 0; i < STRESS_HANDLERS; i++) {
+        atomic_init(&stress.calls[i], 0);
+    }
+    pthread_t dispatchers[STRESS_DISPATCHERS];
+    for (size_t i = 0; i < STRESS_DISPATCHERS; i++) {
+        assert_int_equal(pthread_create(&dispatchers[i], NULL, stress_dispatcher, &stress), 0);
+    }
+    /* Replaced snapshots are freed while dispatchers run, the sanitizers catch any use after free. */
+    for (size_t round = 0; round < STRESS_ROUNDS; round++) {
+        for (size_t i = 0; i < STRESS_HANDLERS; i++) {
+            assert_true(callback_register_handler(stress.cbs, stress_handler, &stress.calls[i]));
+            sched_yield();
+        }
+        for (size_t i = 0; i < STRESS_HANDLERS; i++) {
+            assert_true(callback_unregister_handler(stress.cbs, stress_handler, &stress.calls[i]));
+        }
+    }
+    atomic_store(&stress.done, true);
+    for (size_t i = 0; i < STRESS_DISPATCHERS; i++) {
+        pthread_join(dispatchers[i], NULL);
+    }
+
+    size_t before[STRESS_HANDLERS];
+    for (size_t i = 0; i < STRESS_HANDLERS; i++) {
+        before[i] = atomic_load(&stress.calls[i]);
+    }
+    atomic_size_t calls;
+    atomic_init(&calls, 0);
+    callback_dispatch(stress.cbs, &calls);
+    assert_int_equal(atomic_load(&calls), 0);
+    for (size_t i = 0; i < STRESS_HANDLERS; i++) {
+        assert_int_equal(atomic_load(&stress.calls[i]), before[i]);
+    }
+    callback_destroy(stress.cbs);
+}
+
+static uint8_t static_context;
+
+CALLBACK_STATIC_DEFINE(static_callback,
+                       CALLBACK_STATIC_ENTRY(test_callback_handler, &static_context),
+                       CALLBACK_STATIC_ENTRY(test_another_callback_handler, NULL));
+
+static void test_static_callback(void** state) {
+    (void)state;  // unused
+    uint8_t some_payload;
+    expect_function_call(test_callback_handler);
+    expect_value(test_callback_handler, context, &static_context);
+    expect_value(test_callback_handler, payload, &some_payload);
+    expect_function_call(test_another_callback_handler);
+    expect_value(test_another_callback_handler, context, NULL);
+    expect_value(test_another_callback_handler, payload, &some_payload);
+    callback_static_dispatch(&static_callback, &some_payload);
+    callback_static_dispatch(NULL, &some_payload);
 }
 
 int main(void) {
@@ -91,6 +505,15 @@ int main(void) {
         cmocka_unit_test(test_create_callbacks),
         cmocka_unit_test(test_register_invalid_callback),
         cmocka_unit_test(test_register_callbacks),
+        cmocka_unit_test(test_freeze_callbacks),
+        cmocka_unit_test(test_unregister_callbacks),
+        cmocka_unit_test(test_unregister_from_handler),
+        cmocka_unit_test(test_unregister_during_dispatch),
+        cmocka_unit_test(test_priority_callbacks),
+        cmocka_unit_test(test_batch_callbacks),
+        cmocka_unit_test(test_async_callbacks),
+        cmocka_unit_test(test_async_callbacks_backpressure),
+        cmocka_unit_test(test_static_callback),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,141 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cli-script.h"
+#include "cli.h"
+
+#define BENCHMARK_INPUT_SIZE (1 << 22)
+#define BENCHMARK_ROUNDS (8)
+
+static const size_t chunk_sizes[] = {16, 256, 4096};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void print(const char* format, ...) {
+    (void)format;
+}
+
+static size_t executed;
+
+static int command(cli_t* cli, int argc, char** argv) {
+    (void)cli;
+    (void)argv;
+    executed += (size_t)argc;
+    return 0;
+}
+
+/* Typical configuration lines terminated with CR LF, the LF is an omitted character. */
+static size_t fill_input(char* input, size_t size) {
+    static const char* lines[] = {
+        "set uart0 baudrate 115200\r\n",
+        "set gpio12 mode output pull none\r\n",
+        "diag\r\n",
+        "set adc3 samples 64 interval 10\r\n",
+    };
+    size_t length = 0;
+    for (size_t i = 0;; i++) {
+        const char* line = lines[i % (sizeof(lines) / sizeof(lines[0]))];
+        size_t line_length = strlen(line);
+        if (length + line_length > size) {
+            return length;
+        }
+        memcpy(input + length, line, line_length);
+        length += line_length;
+    }
+}
+
+static cli_t* create_cli(void) {
+    cli_config_t config = {.print = print};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "set", "Set a value", command);
+    cli_register(cli, "diag", "Run diagnostics", command);
+    return cli;
+}
+
+static void report(const char* name, size_t chunk, size_t length, double elapsed) {
+    printf("%-10s chunk %5zu: %8.1f MB/s\n", name, chunk, (double)length * BENCHMARK_ROUNDS / elapsed / 1e6);
+}
+
+int main(void) {
+    char* input = malloc(BENCHMARK_INPUT_SIZE);
+    size_t length = fill_input(input, BENCHMARK_INPUT_SIZE);
+
+    cli_t* cli = create_cli();
+    executed = 0;
+    double start = now_seconds();
+    for (size_t round = 0; round < BENCHMARK_ROUNDS; round++) {
+        for (size_t i = 0; i < length; i++) {
+            cli_process(cli, input[i]);
+        }
+    }
+    report("per-char", 1, length, now_seconds() - start);
+    size_t expected = executed;
+    cli_destroy(cli);
+
+    for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+        cli = create_cli();
+        executed = 0;
+        start = now_seconds();
+        for (size_t round = 0; round < BENCHMARK_ROUNDS; round++) {
+            for (size_t i = 0; i < length; i += chunk_sizes[c]) {
+                size_t size = (length - i < chunk_sizes[c] ? length - i : chunk_sizes[c]);
+                cli_process_buffer(cli, input + i, size);
+            }
+        }
+        report("buffer", chunk_sizes[c], length, now_seconds() - start);
+        if (executed != expected) {
+            printf("unexpected parameters count %zu instead of %zu\n", executed, expected);
+        }
+        cli_destroy(cli);
+    }
+
+    /* The script is split in place, so every round executes a fresh copy, copying is not measured. */
+    char* script = malloc(length + 1);
+    cli = create_cli();
+    executed = 0;
+    double elapsed = 0;
+    cli_script_result_t result = {0};
+    for (size_t round = 0; round < BENCHMARK_ROUNDS; round++) {
+        memcpy(script, input, length);
+        start = now_seconds();
+        cli_script_run(cli, script, length, NULL, &result);
+        elapsed += now_seconds() - start;
+    }
+    report("script", length, length, elapsed);
+    printf("script %.0f lines/s\n", (double)result.lines / elapsed);
+    if (executed != expected) {
+        printf("unexpected parameters count %zu instead of %zu\n", executed, expected);
+    }
+    cli_destroy(cli);
+    free(script);
+    free(input);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Grzegorz Grzęda
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cli-script.h"
+#include <string.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+static const cli_script_config_t default_config = {.policy = CLI_SCRIPT_STOP_ON_ERROR};
+
+/* Returns the first printable character of the line, NULL for blank and comment lines. */
+static char* find_command(char* line, const char* end) {
+    while (line < end && (unsigned char)(*line - '!') > ('~' - '!')) {
+        line++;
+    }
+    return ((line == end || *line == '#') ? NULL : line);
+}
+
+static int run_line(cli_t* cli,
+                    char* line,
+                    const char* end,
+                    const cli_script_config_t* config,
+                    cli_script_result_t* result) {
+    result->lines++;
+    char* command = find_command(line, end);
+    if (!command) {
+        return 0;
+    }
+    result->executed++;
+    /* The command name is the first parameter, so it is terminated in place after the execution. */
+    int code = cli_execute(cli, command, (size_t)(end - command));
+    if (code == 0) {
+        return 0;
+    }
+    result->failed++;
+    if (!result->first_failed_line) {
+        result->first_failed_line = result->lines;
+    }
+    if (config->error) {
+        config->error(config->error_context, result->lines, command, code);
+    }
+    result->stopped = (config->policy == CLI_SCRIPT_STOP_ON_ERROR);
+    return code;
+}
+
+int cli_script_run(cli_t* cli,
+                   char* data,
+                   size_t size,
+                   const cli_script_config_t* config,
+                   cli_script_result_t* result) {
+    if (!cli || !result || (!data && size > 0)) {
+        return CLI_RETURN_ERROR_PARAMETER_BUFFER_EMPTY;
+    }
+    if (!config) {
+        config = &default_config;
+    }
+    uint64_t start = (config->clock ? config->clock() : 0);
+    int first_failure = 0;
+    char* line = data;
+    char* end = data + size;
+    while (line < end && !result->stopped) {
+        char* line_end = memchr(line, '\n', (size_t)(end - line));
+        if (!line_end) {
+            if (config->stream) {
+                break;
+            }
+            line_end = end;
+        }
+        int code = run_line(cli, line, line_end, config, result);
+        if (!first_failure) {
+            first_failure = code;
+        }
+        line = line_end + 1;
+    }
+    result->consumed = (size_t)((line < end ? line : end) - data);
+    if (config->clock) {
+        result->elapsed_us += config->clock() - start;
+        if (result->elapsed_us > 0) {
+            result->lines_per_second = (uint64_t)result->lines * 1000000u / result->elapsed_us;
+        }
+    }
+    return first_failure;
+}
+
+#if defined(__linux__)
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/*
+ * One character more than the file is reserved, so the last line can be terminated in place even when the
+ * file ends exactly at a page boundary. The file is mapped over the beginning of the reservation.
+ */
+static char* map_file(int fd, size_t size) {
+    char* data = mmap(NULL, size + 1, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    if (size > 0) {
+        if (mmap(data, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(data, size + 1);
+            return NULL;
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+    return data;
+}
+
+int cli_script_run_file(cli_t* cli, const char* path, const cli_script_config_t* config, cli_script_result_t* result) {
+    if (!cli || !path || !result) {
+        return CLI_RETURN_ERROR_SCRIPT_FILE;
+    }
+    *result = (cli_script_result_t){0};
+    cli_script_config_t file_config = (config ? *config : default_config);
+    file_config.stream = false;
+    if (!file_config.clock) {
+        file_config.clock = monotonic_us;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return CLI_RETURN_ERROR_SCRIPT_FILE;
+    }
+    struct stat status;
+    char* data = NULL;
+    size_t size = 0;
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode)) {
+        size = (size_t)status.st_size;
+        data = map_file(fd, size);
+    }
+    close(fd);
+    if (!data) {
+        return CLI_RETURN_ERROR_SCRIPT_FILE;
+    }
+    int code = cli_script_run(cli, data, size, &file_config, result);
+    munmap(data, size + 1);
+    return code;
+}
+#endif
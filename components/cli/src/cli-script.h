@@ -0,0 +1,122 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Grzegorz Grzęda
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CLI_SCRIPT_H
+#define CLI_SCRIPT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cli.h"
+
+/**
+ * @defgroup cli_script CLI script runner
+ * @ingroup cli
+ * @brief Execution of command scripts on a CLI instance
+ *
+ * A script is executed line by line with @ref cli_execute, so the lines are split in place and never copied
+ * through the input buffer. Lines end with `\n`, blank lines and lines starting with `#` are skipped.
+ * @{
+ */
+#define CLI_RETURN_ERROR_SCRIPT_FILE -6 /**< Script file could not be read */
+
+typedef enum cli_script_policy {
+    CLI_SCRIPT_STOP_ON_ERROR,     /**< Stop at the first failed line */
+    CLI_SCRIPT_CONTINUE_ON_ERROR, /**< Execute all lines, reporting the failed ones */
+} cli_script_policy_t; /**< Handling of failed lines */
+
+/**
+ * @brief Failed line report function type
+ * @param[in] context pointer to the context given in the configuration
+ * @param[in] line number of the failed line, counted from 1
+ * @param[in] command C-Str with the command name of the line
+ * @param[in] result non zero return code of the line
+ */
+typedef void (*cli_script_error_t)(void* context, size_t line, const char* command, int result);
+
+/**
+ * @brief Monotonic clock function type
+ * @return current time in microseconds
+ */
+typedef uint64_t (*cli_script_clock_t)(void);
+
+typedef struct cli_script_config {
+    cli_script_policy_t policy; /**< Handling of failed lines */
+    cli_script_error_t error;   /**< Failed line report function, optional */
+    void* error_context;        /**< Context passed to the report function */
+    cli_script_clock_t clock;   /**< Clock for the execution rate, optional */
+    bool stream;                /**< Keep the last line without line end for the next block */
+} cli_script_config_t; /**< CLI script configuration structure definition */
+
+typedef struct cli_script_result {
+    size_t lines;              /**< Number of lines read, including skipped ones */
+    size_t executed;           /**< Number of executed lines */
+    size_t failed;             /**< Number of lines with a non zero return code */
+    size_t first_failed_line;  /**< Number of the first failed line, 0 if none failed */
+    size_t consumed;           /**< Number of characters read from the last block */
+    bool stopped;              /**< Execution stopped at a failed line */
+    uint64_t elapsed_us;       /**< Execution time in microseconds, 0 without a clock */
+    uint64_t lines_per_second; /**< Execution rate, 0 without a clock */
+} cli_script_result_t; /**< CLI script result structure definition */
+
+/**
+ * @brief Execute a script block
+ *
+ * The counters are added to the result, so a script executed in several blocks with the same result keeps its
+ * line numbers and once stopped stays stopped. In stream mode the last line without line end is not executed,
+ * `consumed` tells where it starts and it has to be passed again at the beginning of the next block. Otherwise
+ * it is executed as the last line, which needs `data[size]` to be writable.
+ * @param[in] cli pointer to CLI instance
+ * @param[in,out] data pointer to the script characters, split in place
+ * @param[in] size number of script characters
+ * @param[in] config pointer to the configuration, NULL to stop on the first error
+ * @param[in,out] result pointer to the result, zeroed before the first block
+ * @return 0 if all lines of the block succeeded
+ * @return return code of the first failed line of the block
+ */
+int cli_script_run(cli_t* cli,
+                   char* data,
+                   size_t size,
+                   const cli_script_config_t* config,
+                   cli_script_result_t* result);
+
+#if defined(__linux__)
+/**
+ * @brief Execute a script file
+ *
+ * The file is mapped into memory privately, so splitting the lines does not change the file. Without a clock
+ * in the configuration the monotonic system clock is used.
+ * @param[in] cli pointer to CLI instance
+ * @param[in] path C-Str with the path of the script file
+ * @param[in] config pointer to the configuration, NULL to stop on the first error, stream mode is ignored
+ * @param[out] result pointer to the result
+ * @return 0 if all lines succeeded
+ * @return return code of the first failed line
+ * @return CLI_RETURN_ERROR_SCRIPT_FILE if the file could not be mapped
+ */
+int cli_script_run_file(cli_t* cli, const char* path, const cli_script_config_t* config, cli_script_result_t* result);
+#endif
+
+/**
+ * @}
+ */
+
+#endif  // CLI_SCRIPT_H
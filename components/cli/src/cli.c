@@ -20,20 +20,57 @@
  * SOFTWARE.
  */
 #include "cli.h"
-#include <ctype.h>
+#include <limits.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "linked-list.h"
+#include "intrusive-list.h"
 
 const char* HELP_COMMAND_NAME = "help";
 const char* HELP_COMMAND_HELP = "Print available commands";
 
+#define CLI_INDEX_NONE UINT32_MAX
+
+enum { CLI_INDEX_LOWER, CLI_INDEX_EQUAL, CLI_INDEX_HIGHER };
+
+/*
+ * Ternary search tree node, one per character of a registered name. Nodes live in one growing array and are
+ * linked by index, so a lookup walks a compact block of memory in about the length of the name.
+ */
+typedef struct cli_index_node {
+    char split;
+    uint32_t children[3];    /* Lower, equal and higher split characters */
+    struct cli_entry* entry; /* Command whose name ends at this node */
+} cli_index_node_t;
+
+/*
+ * Commands and their index. A frozen registry is never written again, so any number of sessions can look up
+ * commands in it from their own threads without locking.
+ */
+typedef struct cli_registry {
+    intrusive_list_t commands;
+    cli_index_node_t* index;
+    uint32_t index_size;
+    uint32_t index_capacity;
+    bool frozen;
+} cli_registry_t;
+
+#define CLI_OMIT_WORD_BITS (sizeof(unsigned int) * CHAR_BIT)
+
 typedef struct cli {
     cli_print_t print;
-    linked_list_t* commands;
+    cli_write_t write;
+    void* write_context;
+    char* output;
+    size_t output_end;
+    size_t output_size;
+    const cli_registry_t* registry;
+    cli_registry_t* own_registry; /* Registry created with the instance, NULL for a session */
+    void* context;
     char* buffer;
     size_t buffer_end;
     size_t buffer_size;
@@ -42,156 +79,591 @@ typedef struct cli {
     int parameter_count;
     char enter_character;
     const char* omit_characters;
+    unsigned int omit[(UCHAR_MAX + 1) / CLI_OMIT_WORD_BITS]; /* Bit set of omit_characters */
 } cli_t;
 
 typedef struct cli_entry {
+    intrusive_list_node_t node;
     const char* name;
     const char* help;
     cli_command_t command;
 } cli_entry_t;
 
+static uint32_t index_add_node(cli_registry_t* registry, char split) {
+    if (registry->index_size == registry->index_capacity) {
+        uint32_t capacity = (registry->index_capacity ? registry->index_capacity * 2 : 64);
+        cli_index_node_t* index = realloc(registry->index, capacity * sizeof(cli_index_node_t));
+        if (!index) {
+            return CLI_INDEX_NONE;
+        }
+        registry->index = index;
+        registry->index_capacity = capacity;
+    }
+    cli_index_node_t* node = &registry->index[registry->index_size];
+    node->split = split;
+    node->children[CLI_INDEX_LOWER] = CLI_INDEX_NONE;
+    node->children[CLI_INDEX_EQUAL] = CLI_INDEX_NONE;
+    node->children[CLI_INDEX_HIGHER] = CLI_INDEX_NONE;
+    node->entry = NULL;
+    return registry->index_size++;
+}
+
+/* Adds the entry under its name, an already registered name keeps its first command. */
+static bool index_insert(cli_registry_t* registry, cli_entry_t* entry) {
+    const char* name = entry->name;
+    if (*name == '\0') {
+        return false;
+    }
+    uint32_t parent = CLI_INDEX_NONE;
+    int side = CLI_INDEX_EQUAL;
+    uint32_t current = (registry->index_size ? 0 : CLI_INDEX_NONE);
+    for (;;) {
+        if (current == CLI_INDEX_NONE) {
+            /* Adding may move the array, the parent is linked by index afterwards. */
+            current = index_add_node(registry, *name);
+            if (current == CLI_INDEX_NONE) {
+                return false;
+            }
+            if (parent != CLI_INDEX_NONE) {
+                registry->index[parent].children[side] = current;
+            }
+        }
+        cli_index_node_t* node = &registry->index[current];
+        if (*name < node->split) {
+            side = CLI_INDEX_LOWER;
+        } else if (*name > node->split) {
+            side = CLI_INDEX_HIGHER;
+        } else if (name[1] != '\0') {
+            side = CLI_INDEX_EQUAL;
+            name++;
+        } else {
+            if (!node->entry) {
+                node->entry = entry;
+            }
+            return true;
+        }
+        parent = current;
+        current = node->children[side];
+    }
+}
+
+/* Returns the node matching the last character of the prefix. */
+static const cli_index_node_t* index_find(const cli_registry_t* registry, const char* prefix) {
+    if (*prefix == '\0') {
+        return NULL;
+    }
+    uint32_t current = (registry->index_size ? 0 : CLI_INDEX_NONE);
+    while (current != CLI_INDEX_NONE) {
+        const cli_index_node_t* node = &registry->index[current];
+        if (*prefix < node->split) {
+            current = node->children[CLI_INDEX_LOWER];
+        } else if (*prefix > node->split) {
+            current = node->children[CLI_INDEX_HIGHER];
+        } else if (prefix[1] != '\0') {
+            current = node->children[CLI_INDEX_EQUAL];
+            prefix++;
+        } else {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+/* Visits the names below a node in lexical order. */
+static void index_collect(const cli_registry_t* registry,
+                          uint32_t current,
+                          const char** matches,
+                          size_t capacity,
+                          size_t* count) {
+    while (current != CLI_INDEX_NONE) {
+        const cli_index_node_t* node = &registry->index[current];
+        index_collect(registry, node->children[CLI_INDEX_LOWER], matches, capacity, count);
+        if (node->entry) {
+            if (*count < capacity) {
+                matches[*count] = node->entry->name;
+            }
+            (*count)++;
+        }
+        index_collect(registry, node->children[CLI_INDEX_EQUAL], matches, capacity, count);
+        current = node->children[CLI_INDEX_HIGHER];
+    }
+}
+
+static void output_bytes(cli_t* cli, const char* data, size_t size) {
+    while (size > 0) {
+        if (cli->output_end == cli->output_size) {
+            cli_flush(cli);
+        }
+        size_t chunk = cli->output_size - cli->output_end;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(cli->output + cli->output_end, data, chunk);
+        cli->output_end += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+static void output_padding(cli_t* cli, char c, size_t count) {
+    for (; count > 0; count--) {
+        output_bytes(cli, &c, 1);
+    }
+}
+
+static void output_field(cli_t* cli, const char* data, size_t size, size_t width, bool left, char pad) {
+    size_t padding = (width > size ? width - size : 0);
+    if (!left) {
+        /* Zero padding goes after the sign. */
+        if (pad == '0' && size > 0 && *data == '-') {
+            output_bytes(cli, data, 1);
+            data++;
+            size--;
+        }
+        output_padding(cli, pad, padding);
+    }
+    output_bytes(cli, data, size);
+    if (left) {
+        output_padding(cli, ' ', padding);
+    }
+}
+
+static size_t format_unsigned(char* end, unsigned long long value, unsigned base, bool upper) {
+    const char* digits = (upper ? "0123456789ABCDEF" : "0123456789abcdef");
+    size_t length = 0;
+    do {
+        *--end = digits[value % base];
+        value /= base;
+        length++;
+    } while (value > 0);
+    return length;
+}
+
+void cli_vprintf(cli_t* cli, const char* format, va_list args) {
+    if (!cli || !format) {
+        return;
+    }
+    while (*format) {
+        const char* percent = strchr(format, '%');
+        if (!percent) {
+            output_bytes(cli, format, strlen(format));
+            return;
+        }
+        output_bytes(cli, format, (size_t)(percent - format));
+        format = percent + 1;
+
+        bool left = false;
+        char pad = ' ';
+        for (; *format == '-' || *format == '0'; format++) {
+            if (*format == '-') {
+                left = true;
+            } else {
+                pad = '0';
+            }
+        }
+        size_t width = 0;
+        if (*format == '*') {
+            int value = va_arg(args, int);
+            left |= (value < 0);
+            width = (size_t)(value < 0 ? -(long)value : value);
+            format++;
+        }
+        for (; *format >= '0' && *format <= '9'; format++) {
+            width = width * 10 + (size_t)(*format - '0');
+        }
+        if (left) {
+            pad = ' ';
+        }
+        int length = 0;
+        for (; *format == 'l' || *format == 'z'; format++) {
+            length = (*format == 'z' ? 3 : length + 1);
+        }
+
+        char number[24];
+        char* end = number + sizeof(number);
+        switch (*format) {
+            case 'd':
+            case 'i': {
+                long long value = (length == 0   ? va_arg(args, int)
+                                   : length == 1 ? va_arg(args, long)
+                                   : length == 2 ? va_arg(args, long long)
+                                                 : (long long)va_arg(args, size_t));
+                unsigned long long magnitude = (unsigned long long)value;
+                if (value < 0) {
+                    magnitude = 0ull - magnitude;
+                }
+                size_t size = format_unsigned(end, magnitude, 10, false);
+                if (value < 0) {
+                    *(end - size - 1) = '-';
+                    size++;
+                }
+                output_field(cli, end - size, size, width, left, pad);
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X': {
+                unsigned long long value = (length == 0   ? va_arg(args, unsigned)
+                                            : length == 1 ? va_arg(args, unsigned long)
+                                            : length == 2 ? va_arg(args, unsigned long long)
+                                                          : va_arg(args, size_t));
+                size_t size = format_unsigned(end, value, (*format == 'u' ? 10 : 16), *format == 'X');
+                output_field(cli, end - size, size, width, left, pad);
+                break;
+            }
+            case 'p': {
+                size_t size = format_unsigned(end, (uintptr_t)va_arg(args, void*), 16, false);
+                output_field(cli, "0x", 2, 0, false, ' ');
+                output_field(cli, end - size, size, (width > 2 ? width - 2 : 0), left, pad);
+                break;
+            }
+            case 'c': {
+                char c = (char)va_arg(args, int);
+                output_field(cli, &c, 1, width, left, ' ');
+                break;
+            }
+            case 's': {
+                const char* string = va_arg(args, const char*);
+                if (!string) {
+                    string = "(null)";
+                }
+                output_field(cli, string, strlen(string), width, left, ' ');
+                break;
+            }
+            case '%':
+                output_bytes(cli, "%", 1);
+                break;
+            default:
+                /* Unsupported conversions are printed as they are. */
+                output_bytes(cli, percent, (size_t)(format - percent + (*format ? 1 : 0)));
+                break;
+        }
+        if (*format) {
+            format++;
+        }
+    }
+}
+
+void cli_printf(cli_t* cli, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    cli_vprintf(cli, format, args);
+    va_end(args);
+}
+
+void cli_write(cli_t* cli, const char* data, size_t size) {
+    if (!cli || (!data && size > 0)) {
+        return;
+    }
+    output_bytes(cli, data, size);
+}
+
+void cli_flush(cli_t* cli) {
+    if (!cli || cli->output_end == 0) {
+        return;
+    }
+    if (cli->write) {
+        cli->write(cli->write_context, cli->output, cli->output_end);
+    } else if (cli->print) {
+        cli->print("%.*s", (int)cli->output_end, cli->output);
+    }
+    cli->output_end = 0;
+}
+
 static int command_help(cli_t* cli, int argc, char** argv) {
     (void)argc;
     (void)argv;
     size_t max_cmd_length = 0;
-    for (linked_list_iterator_t* it = linked_list_iterator_begin(cli->commands); it;
-         it = linked_list_iterator_next(it)) {
-        cli_entry_t* entry = linked_list_get(it);
+    intrusive_list_node_t* node;
+    INTRUSIVE_LIST_FOR_EACH(&cli->registry->commands, node) {
+        cli_entry_t* entry = intrusive_list_entry(node, cli_entry_t, node);
         size_t size = strlen(entry->name);
         if (size > max_cmd_length) {
             max_cmd_length = size;
         }
     }
-    cli->print("Available commands:\n");
-    for (linked_list_iterator_t* it = linked_list_iterator_begin(cli->commands); it;
-         it = linked_list_iterator_next(it)) {
-        cli_entry_t* entry = linked_list_get(it);
-        cli->print(" %*s - %s\n", max_cmd_length, entry->name, entry->help);
+    cli_printf(cli, "Available commands:\n");
+    INTRUSIVE_LIST_FOR_EACH(&cli->registry->commands, node) {
+        cli_entry_t* entry = intrusive_list_entry(node, cli_entry_t, node);
+        cli_printf(cli, " %*s - %s\n", (int)max_cmd_length, entry->name, entry->help);
     }
     return 0;
 }
 
-static char* get_first_non_white_character(char* input) {
-    while (*input) {
-        if (isgraph(*input) != 0) {
-            break;
-        }
-        input++;
-    }
-    return input;
-}
-
-static char* get_first_white_character(char* input) {
-    while (*input) {
-        if (isgraph(*input) == 0) {
-            break;
-        }
-        input++;
-    }
-    return input;
+/* Same as isgraph in the C locale, without a library call per character. */
+static bool is_graph(char c) {
+    return (unsigned char)(c - '!') <= ('~' - '!');
 }
 
-static int parse_arguments(cli_t* cli) {
-    if (cli->buffer_end < 1) {
-        return CLI_RETURN_ERROR_PARAMETER_BUFFER_EMPTY;
-    }
+/* Splits the characters up to the end in place, a parameter ending at the end is terminated there as well. */
+static int tokenize(cli_t* cli, char* ptr, char* end) {
     cli->parameter_count = 0;
-    for (char* ptr = cli->buffer; *ptr || (ptr < (cli->buffer + cli->buffer_end));) {
-        ptr = get_first_non_white_character(ptr);
-        if (*ptr == '\0') {
-            break;
+    while (ptr < end) {
+        if (!is_graph(*ptr)) {
+            ptr++;
+            continue;
         }
         if ((size_t)(cli->parameter_count) >= cli->parameter_buffer_size) {
             return CLI_RETURN_ERROR_PARAMETER_COUNT_EXCEEDED;
         }
         cli->parameter_buffer[cli->parameter_count++] = ptr;
-        ptr = get_first_white_character(ptr);
-        if (*ptr == '\0') {
-            break;
+        while (ptr < end && is_graph(*ptr)) {
+            ptr++;
         }
         *(ptr++) = '\0';
     }
-    cli->buffer_end = 0;
     return CLI_RETURN_CONTINUE;
 }
 
+static int parse_arguments(cli_t* cli) {
+    if (cli->buffer_end < 1) {
+        return CLI_RETURN_ERROR_PARAMETER_BUFFER_EMPTY;
+    }
+    int result = tokenize(cli, cli->buffer, cli->buffer + cli->buffer_end);
+    cli->buffer_end = 0;
+    return result;
+}
+
 static int execute_command(cli_t* cli) {
     if (cli->parameter_count < 1) {
         return CLI_RETURN_ERROR_COMMAND_NOT_FOUND;
     }
-    for (linked_list_iterator_t* it = linked_list_iterator_begin(cli->commands); it;
-         it = linked_list_iterator_next(it)) {
-        cli_entry_t* entry = linked_list_get(it);
-        if (strcmp(cli->parameter_buffer[0], entry->name) == 0) {
-            return entry->command(cli, cli->parameter_count, cli->parameter_buffer);
-        }
+    const cli_index_node_t* node = index_find(cli->registry, cli->parameter_buffer[0]);
+    if (node && node->entry) {
+        return node->entry->command(cli, cli->parameter_count, cli->parameter_buffer);
     }
     command_help(cli, 0, 0);
     return CLI_RETURN_ERROR_COMMAND_NOT_FOUND;
 }
 
-cli_t* cli_create(cli_config_t* config) {
-    if (!config) {
+cli_registry_t* cli_registry_create(void) {
+    cli_registry_t* registry = calloc(1, sizeof(cli_registry_t));
+    if (!registry) {
         return NULL;
     }
-    cli_t* cli = calloc(1, sizeof(cli_t));
-    if (!cli) {
+    intrusive_list_init(&registry->commands);
+    if (!cli_registry_register(registry, HELP_COMMAND_NAME, HELP_COMMAND_HELP, command_help)) {
+        free(registry);
         return NULL;
     }
-    cli->buffer_size =
+    return registry;
+}
+
+void cli_registry_destroy(cli_registry_t* registry) {
+    if (!registry) {
+        return;
+    }
+    intrusive_list_node_t* node;
+    intrusive_list_node_t* next;
+    INTRUSIVE_LIST_FOR_EACH_SAFE(&registry->commands, node, next) {
+        free(intrusive_list_entry(node, cli_entry_t, node));
+    }
+    free(registry->index);
+    free(registry);
+}
+
+bool cli_registry_register(cli_registry_t* registry, const char* name, const char* help, cli_command_t command) {
+    if (!registry || registry->frozen || !command || !name || *name == '\0') {
+        return false;
+    }
+    cli_entry_t* entry = calloc(1, sizeof(cli_entry_t));
+    if (!entry) {
+        return false;
+    }
+    entry->name = name;
+    entry->help = help;
+    entry->command = command;
+    /* A command missing from the index could never be executed, so it is not listed either. */
+    if (!index_insert(registry, entry)) {
+        free(entry);
+        return false;
+    }
+    intrusive_list_push_back(&registry->commands, &entry->node);
+    return true;
+}
+
+void cli_registry_freeze(cli_registry_t* registry) {
+    if (!registry || registry->frozen) {
+        return;
+    }
+    /* The index does not grow anymore, so the spare capacity is given back. */
+    if (registry->index_size > 0 && registry->index_size < registry->index_capacity) {
+        cli_index_node_t* index = realloc(registry->index, registry->index_size * sizeof(cli_index_node_t));
+        if (index) {
+            registry->index = index;
+            registry->index_capacity = registry->index_size;
+        }
+    }
+    registry->frozen = true;
+}
+
+bool cli_registry_is_frozen(const cli_registry_t* registry) {
+    return registry && registry->frozen;
+}
+
+size_t cli_registry_complete(const cli_registry_t* registry,
+                             const char* prefix,
+                             const char** matches,
+                             size_t capacity) {
+    if (!registry || !prefix || (!matches && capacity > 0)) {
+        return 0;
+    }
+    size_t count = 0;
+    if (*prefix == '\0') {
+        index_collect(registry, (registry->index_size ? 0 : CLI_INDEX_NONE), matches, capacity, &count);
+        return count;
+    }
+    const cli_index_node_t* node = index_find(registry, prefix);
+    if (!node) {
+        return 0;
+    }
+    if (node->entry) {
+        if (capacity > 0) {
+            matches[0] = node->entry->name;
+        }
+        count++;
+    }
+    index_collect(registry, node->children[CLI_INDEX_EQUAL], matches, capacity, &count);
+    return count;
+}
+
+/* The instance and all its buffers are a single allocation, which is all the memory a session adds. */
+static cli_t* create_instance(cli_config_t* config, const cli_registry_t* registry) {
+    size_t buffer_size =
         (config->max_input_buffer_size ? config->max_input_buffer_size : CLI_DEFAULT_MAX_INPUT_BUFFER_SIZE);
-    cli->parameter_buffer_size =
+    size_t parameter_buffer_size =
         (config->max_parameter_count ? config->max_parameter_count : CLI_DEFAULT_MAX_PARAMETER_COUNT);
-    cli->buffer = calloc(cli->buffer_size, sizeof(char));
-    if (!cli->buffer) {
-        free(cli);
-        return NULL;
-    }
-    cli->parameter_buffer = calloc(cli->parameter_buffer_size, sizeof(char*));
-    if (!cli->parameter_buffer) {
-        free(cli->buffer);
-        free(cli);
+    size_t output_size = (config->output_buffer_size ? config->output_buffer_size : CLI_DEFAULT_OUTPUT_BUFFER_SIZE);
+    /* The input buffer has room for the terminator of a full line. */
+    cli_t* cli = calloc(1, sizeof(cli_t) + parameter_buffer_size * sizeof(char*) + buffer_size + 1 + output_size);
+    if (!cli) {
         return NULL;
     }
+    cli->parameter_buffer = (char**)(cli + 1);
+    cli->parameter_buffer_size = parameter_buffer_size;
+    cli->buffer = (char*)(cli->parameter_buffer + parameter_buffer_size);
+    cli->buffer_size = buffer_size;
+    cli->output = cli->buffer + buffer_size + 1;
+    cli->output_size = output_size;
+    cli->registry = registry;
+    cli->context = config->context;
     cli->print = config->print;
+    cli->write = config->write;
+    cli->write_context = config->write_context;
     cli->enter_character = (config->enter_character ? config->enter_character : CLI_DEFAULT_ENTER_CHARACTER);
     cli->omit_characters = (config->omit_characters ? config->omit_characters : CLI_DEFAULT_OMIT_CHARACTERS);
-    cli_register(cli, HELP_COMMAND_NAME, HELP_COMMAND_HELP, command_help);
+    for (const char* omit = cli->omit_characters; *omit; omit++) {
+        unsigned char c = (unsigned char)*omit;
+        cli->omit[c / CLI_OMIT_WORD_BITS] |= 1u << (c % CLI_OMIT_WORD_BITS);
+    }
+    return cli;
+}
+
+cli_t* cli_create(cli_config_t* config) {
+    if (!config) {
+        return NULL;
+    }
+    cli_registry_t* registry = cli_registry_create();
+    if (!registry) {
+        return NULL;
+    }
+    cli_t* cli = create_instance(config, registry);
+    if (!cli) {
+        cli_registry_destroy(registry);
+        return NULL;
+    }
+    cli->own_registry = registry;
     return cli;
 }
 
+cli_t* cli_create_session(cli_config_t* config, const cli_registry_t* registry) {
+    if (!config || !cli_registry_is_frozen(registry)) {
+        return NULL;
+    }
+    return create_instance(config, registry);
+}
+
 void cli_destroy(cli_t* cli) {
     if (!cli) {
         return;
     }
-    linked_list_destroy(cli->commands);
-    free(cli->buffer);
-    free(cli->parameter_buffer);
+    cli_flush(cli);
+    cli_registry_destroy(cli->own_registry);
     free(cli);
 }
 
 void cli_register(cli_t* cli, const char* name, const char* help, cli_command_t command) {
-    if (!cli || !command || !name) {
+    if (!cli) {
         return;
     }
-    cli_entry_t* entry = calloc(1, sizeof(cli_entry_t));
-    if (!entry) {
-        return;
+    cli_registry_register(cli->own_registry, name, help, command);
+}
+
+size_t cli_complete(const cli_t* cli, const char* prefix, const char** matches, size_t capacity) {
+    if (!cli) {
+        return 0;
     }
-    entry->name = name;
-    entry->help = help;
-    entry->command = command;
-    linked_list_append(cli->commands, entry);
+    return cli_registry_complete(cli->registry, prefix, matches, capacity);
 }
 
-int cli_process(cli_t* cli, char c) {
-    if ((c == cli->enter_character) && (cli->buffer_end > 0)) {
-        cli->buffer[cli->buffer_end] = '\0';
-        int parse_result = parse_arguments(cli);
-        if (parse_result != CLI_RETURN_CONTINUE) {
-            return parse_result;
+void* cli_get_context(const cli_t* cli) {
+    return (cli ? cli->context : NULL);
+}
+
+int cli_execute(cli_t* cli, char* line, size_t size) {
+    if (!cli || (!line && size > 0)) {
+        return CLI_RETURN_ERROR_PARAMETER_BUFFER_EMPTY;
+    }
+    int result = tokenize(cli, line, line + size);
+    if (result == CLI_RETURN_CONTINUE) {
+        result = execute_command(cli);
+    }
+    cli_flush(cli);
+    return result;
+}
+
+/* The output of a line is flushed once the line was executed. */
+static int execute_line(cli_t* cli) {
+    cli->buffer[cli->buffer_end] = '\0';
+    int result = parse_arguments(cli);
+    cli->buffer_end = 0;
+    if (result == CLI_RETURN_CONTINUE) {
+        result = execute_command(cli);
+    }
+    cli_flush(cli);
+    return result;
+}
+
+static inline bool is_omitted(const cli_t* cli, unsigned char c) {
+    return (cli->omit[c / CLI_OMIT_WORD_BITS] >> (c % CLI_OMIT_WORD_BITS)) & 1u;
+}
+
+/* Copies a line segment without the omitted characters, returns false if it did not fit. */
+static bool append_segment(cli_t* cli, const char* data, size_t size) {
+    char* destination = cli->buffer + cli->buffer_end;
+    size_t space = cli->buffer_size - cli->buffer_end;
+    size_t copied = 0;
+    size_t i = 0;
+    /* Every character is stored, but only kept ones advance the write position, so there is no branch. */
+    for (; i < size && copied < space; i++) {
+        unsigned char c = (unsigned char)data[i];
+        destination[copied] = (char)c;
+        copied += !is_omitted(cli, c);
+    }
+    cli->buffer_end += copied;
+    for (; i < size; i++) {
+        if (!is_omitted(cli, (unsigned char)data[i])) {
+            return false;
         }
-        return execute_command(cli);
+    }
+    return true;
+}
+
+int cli_process(cli_t* cli, char c) {
+    if (c == cli->enter_character) {
+        return (cli->buffer_end > 0 ? execute_line(cli) : CLI_RETURN_CONTINUE);
+    } else if (is_omitted(cli, (unsigned char)c)) {
+        return CLI_RETURN_CONTINUE;
     } else {
         if (cli->buffer_end < cli->buffer_size) {
             cli->buffer[cli->buffer_end] = c;
@@ -200,4 +672,29 @@ int cli_process(cli_t* cli, char c) {
         }
         return CLI_RETURN_ERROR_PARAMETER_BUFFER_OVERFLOW;
     }
+}
+
+int cli_process_buffer(cli_t* cli, const char* data, size_t size) {
+    if (!cli || (!data && size > 0)) {
+        return CLI_RETURN_CONTINUE;
+    }
+    int result = CLI_RETURN_CONTINUE;
+    bool overflow = false;
+    const char* end = data + size;
+    while (data < end) {
+        const char* enter = memchr(data, cli->enter_character, (size_t)(end - data));
+        if (!enter) {
+            overflow |= !append_segment(cli, data, (size_t)(end - data));
+            break;
+        }
+        overflow |= !append_segment(cli, data, (size_t)(enter - data));
+        data = enter + 1;
+        if (cli->buffer_end > 0) {
+            result = execute_line(cli);
+        }
+    }
+    if (overflow && result == CLI_RETURN_CONTINUE) {
+        return CLI_RETURN_ERROR_PARAMETER_BUFFER_OVERFLOW;
+    }
+    return result;
 }
\ No newline at end of file
@@ -22,6 +22,8 @@
 #ifndef CLI_H
 #define CLI_H
 
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -33,6 +35,7 @@
 #define CLI_DEFAULT_MAX_PARAMETER_COUNT 10    /**< Default maximum number of parameters */
 #define CLI_DEFAULT_ENTER_CHARACTER '\r'      /**< Default enter character */
 #define CLI_DEFAULT_OMIT_CHARACTERS "\t\n"    /**< Default omit characters */
+#define CLI_DEFAULT_OUTPUT_BUFFER_SIZE 256    /**< Default size of output buffer */
 
 #define CLI_RETURN_ERROR_COMMAND_NOT_FOUND -1         /**< Command not found */
 #define CLI_RETURN_ERROR_PARAMETER_COUNT_EXCEEDED -2  /**< Exceeded maximum number of parameters */
@@ -42,14 +45,28 @@
 
 typedef void (*cli_print_t)(const char* format, ...); /**< Print function pointer */
 
+/**
+ * @brief Output write function type
+ * @param[in] context pointer to the context given in the configuration
+ * @param[in] data pointer to the output characters, not terminated
+ * @param[in] size number of output characters
+ */
+typedef void (*cli_write_t)(void* context, const char* data, size_t size);
+
 typedef struct cli cli_t;
 
+typedef struct cli_registry cli_registry_t; /**< Command registry shared by CLI sessions */
+
 typedef struct cli_config {
-    cli_print_t print;            /**< Print function */
+    cli_print_t print;            /**< Print function, used for the output when there is no write function */
     size_t max_input_buffer_size; /**< Maximum input buffer size */
     size_t max_parameter_count;
     char enter_character;
     const char* omit_characters;
+    cli_write_t write;            /**< Bulk output write function */
+    void* write_context;          /**< Context passed to the write function */
+    size_t output_buffer_size;    /**< Output buffer size */
+    void* context;                /**< User context of the instance, see @ref cli_get_context */
 } cli_config_t; /**< CLI configuration structure definition */
 
 /**
@@ -70,6 +87,19 @@ typedef int (*cli_command_t)(cli_t* cli, int argc, char** argv);
  */
 cli_t* cli_create(cli_config_t* config);
 
+/**
+ * @brief Create a CLI session using a shared command registry
+ *
+ * The session holds only its input, parameter and output buffers, the commands are looked up in the registry.
+ * Sessions of the same registry can be used from different threads at the same time, each session itself is
+ * not thread safe. The registry has to outlive its sessions.
+ * @param[in] config pointer to configuration structure
+ * @param[in] registry pointer to a frozen command registry
+ * @return pointer to CLI instance
+ * @return NULL in case of errors or if the registry is not frozen
+ */
+cli_t* cli_create_session(cli_config_t* config, const cli_registry_t* registry);
+
 /**
  * @brief Destroy a CLI instance
  * @param[in] cli pointer to the CLI instance
@@ -78,6 +108,8 @@ void cli_destroy(cli_t* cli);
 
 /**
  * @brief Register a new command
+ *
+ * Only instances from @ref cli_create have their own commands, for a session this does nothing.
  * @param[in] cli pointer to CLI instance
  * @param[in] name C-Str with command name to display with help command
  * @param[in] help C-Str with help text to display with help command
@@ -85,6 +117,79 @@ void cli_destroy(cli_t* cli);
  */
 void cli_register(cli_t* cli, const char* name, const char* help, cli_command_t command);
 
+/**
+ * @brief Find the commands starting with a prefix
+ *
+ * The commands are looked up in the same index as during execution, so this costs about the length of the
+ * prefix plus the number of matches.
+ * @param[in] cli pointer to CLI instance
+ * @param[in] prefix C-Str with the beginning of a command name, empty for all commands
+ * @param[out] matches array filled with the names of the matching commands in lexical order
+ * @param[in] capacity number of names fitting into the array
+ * @return number of matching commands, which can be larger than the capacity
+ */
+size_t cli_complete(const cli_t* cli, const char* prefix, const char** matches, size_t capacity);
+
+/**
+ * @brief Get the user context of a CLI instance
+ * @param[in] cli pointer to CLI instance
+ * @return context given in the configuration
+ */
+void* cli_get_context(const cli_t* cli);
+
+/**
+ * @brief Create an empty command registry, containing only the help command
+ * @return pointer to the registry
+ * @return NULL in case of errors
+ */
+cli_registry_t* cli_registry_create(void);
+
+/**
+ * @brief Destroy a command registry, after all of its sessions were destroyed
+ * @param[in] registry pointer to the registry
+ */
+void cli_registry_destroy(cli_registry_t* registry);
+
+/**
+ * @brief Register a new command in a registry
+ * @param[in] registry pointer to the registry
+ * @param[in] name C-Str with command name to display with help command
+ * @param[in] help C-Str with help text to display with help command
+ * @param[in] command pointer to the command handler
+ * @return true if the command was registered
+ * @return false in case of errors or if the registry is frozen
+ */
+bool cli_registry_register(cli_registry_t* registry, const char* name, const char* help, cli_command_t command);
+
+/**
+ * @brief Freeze a registry
+ *
+ * A frozen registry does not accept commands anymore and is only read, which makes it safe for lookups from
+ * many threads without locking. Sessions can only be created for a frozen registry.
+ * @param[in] registry pointer to the registry
+ */
+void cli_registry_freeze(cli_registry_t* registry);
+
+/**
+ * @brief Check if a registry is frozen
+ * @param[in] registry pointer to the registry
+ * @return true if the registry is frozen
+ */
+bool cli_registry_is_frozen(const cli_registry_t* registry);
+
+/**
+ * @brief Find the commands of a registry starting with a prefix, as @ref cli_complete
+ * @param[in] registry pointer to the registry
+ * @param[in] prefix C-Str with the beginning of a command name, empty for all commands
+ * @param[out] matches array filled with the names of the matching commands in lexical order
+ * @param[in] capacity number of names fitting into the array
+ * @return number of matching commands, which can be larger than the capacity
+ */
+size_t cli_registry_complete(const cli_registry_t* registry,
+                             const char* prefix,
+                             const char** matches,
+                             size_t capacity);
+
 /**
  * @brief Process the CLI with new input character
  * @param[in] cli pointer to CLI instance
@@ -94,6 +199,69 @@ void cli_register(cli_t* cli, const char* name, const char* help, cli_command_t
  */
 int cli_process(cli_t* cli, char c);
 
+/**
+ * @brief Process the CLI with a block of input characters
+ *
+ * Equivalent to calling @ref cli_process for every character, but the line ends are searched with `memchr` and
+ * whole line segments are copied into the input buffer at once, without the omitted characters. Every line
+ * completed within the block is executed. Characters not fitting into the input buffer are dropped.
+ * @param[in] cli pointer to CLI instance
+ * @param[in] data pointer to the input characters
+ * @param[in] size number of input characters
+ * @return return code from the last executed command or from CLI in case of its error
+ * @return CLI_RETURN_ERROR_PARAMETER_BUFFER_OVERFLOW if no line was executed and characters were dropped
+ * @return CLI_RETURN_CONTINUE if no line was completed
+ */
+int cli_process_buffer(cli_t* cli, const char* data, size_t size);
+
+/**
+ * @brief Execute a line without copying it into the input buffer
+ *
+ * The line is split into parameters in place, the characters separating them are overwritten with terminators.
+ * Every character outside of the printable ASCII range separates parameters. The input buffer and any partial
+ * line in it are left untouched.
+ * @param[in] cli pointer to CLI instance
+ * @param[in,out] line pointer to the line characters, `line[size]` has to be writable as well
+ * @param[in] size number of line characters, without the line end
+ * @return return code from CLI in case of error
+ * @return return code from executed command
+ */
+int cli_execute(cli_t* cli, char* line, size_t size);
+
+/**
+ * @brief Print formatted output into the CLI output buffer
+ *
+ * The output is buffered and handed to the write function in blocks: when the buffer is full, once the
+ * current input line was executed, or on @ref cli_flush. Supported are the `%d`, `%i`, `%u`, `%x`, `%X`,
+ * `%c`, `%s`, `%p` and `%%` conversions with the `-` and `0` flags, a field width or `*`, and the `l`,
+ * `ll` and `z` length modifiers.
+ * @param[in] cli pointer to CLI instance
+ * @param[in] format C-Str with the format
+ */
+void cli_printf(cli_t* cli, const char* format, ...);
+
+/**
+ * @brief Print formatted output into the CLI output buffer
+ * @param[in] cli pointer to CLI instance
+ * @param[in] format C-Str with the format, as for @ref cli_printf
+ * @param[in] args arguments of the format
+ */
+void cli_vprintf(cli_t* cli, const char* format, va_list args);
+
+/**
+ * @brief Write characters into the CLI output buffer
+ * @param[in] cli pointer to CLI instance
+ * @param[in] data pointer to the characters
+ * @param[in] size number of characters
+ */
+void cli_write(cli_t* cli, const char* data, size_t size);
+
+/**
+ * @brief Hand the buffered output to the write function
+ * @param[in] cli pointer to CLI instance
+ */
+void cli_flush(cli_t* cli);
+
 /**
  * @}
  */
@@ -1,18 +1,568 @@
 #include "cli.h"
+#include <poll.h>
+#include <pthread.h>
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "cli-script.h"
 #include "cmocka.h"
 
+static int printed_lines;
+
+static void test_print(const char* format, ...) {
+    (void)format;
+    printed_lines++;
+}
+
+static int called_command;
+static int called_argc;
+
+static int command_first(cli_t* cli, int argc, char** argv) {
+    (void)cli;
+    (void)argv;
+    called_command = 1;
+    called_argc = argc;
+    return 1;
+}
+
+static int command_second(cli_t* cli, int argc, char** argv) {
+    (void)cli;
+    (void)argv;
+    called_command = 2;
+    called_argc = argc;
+    return 2;
+}
+
+static int process_line(cli_t* cli, const char* line) {
+    for (; *line; line++) {
+        cli_process(cli, *line);
+    }
+    return cli_process(cli, '\r');
+}
+
 static void null_test(void** state) {
     (void)state;  // unused
 }
 
+static void test_command_lookup(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "set", "Set a value", command_first);
+    cli_register(cli, "setup", "Set up", command_second);
+    cli_register(cli, "set", "Duplicate", command_second);
+    cli_register(cli, "", "Empty", command_second);
+
+    assert_int_equal(process_line(cli, "set a b"), 1);
+    assert_int_equal(called_command, 1);
+    assert_int_equal(called_argc, 3);
+    assert_int_equal(process_line(cli, "  setup"), 2);
+    assert_int_equal(called_argc, 1);
+
+    printed_lines = 0;
+    called_command = 0;
+    assert_int_equal(process_line(cli, "se"), CLI_RETURN_ERROR_COMMAND_NOT_FOUND);
+    assert_int_equal(process_line(cli, "setups"), CLI_RETURN_ERROR_COMMAND_NOT_FOUND);
+    assert_int_equal(called_command, 0);
+    assert_true(printed_lines > 0);
+    assert_int_equal(process_line(cli, "help"), 0);
+    cli_destroy(cli);
+}
+
+static void test_command_completion(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print};
+    cli_t* cli = cli_create(&config);
+    const char* names[] = {"status", "set", "setup", "reset", "stop", "set-mode"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        cli_register(cli, names[i], "", command_first);
+    }
+
+    const char* matches[8];
+    assert_int_equal(cli_complete(cli, "se", matches, 8), 3);
+    assert_string_equal(matches[0], "set");
+    assert_string_equal(matches[1], "set-mode");
+    assert_string_equal(matches[2], "setup");
+    assert_int_equal(cli_complete(cli, "st", matches, 1), 2);
+    assert_string_equal(matches[0], "status");
+    assert_int_equal(cli_complete(cli, "setup", matches, 8), 1);
+    assert_int_equal(cli_complete(cli, "x", matches, 8), 0);
+    assert_int_equal(cli_complete(cli, "setupx", matches, 8), 0);
+    assert_int_equal(cli_complete(cli, "", matches, 8), 7);
+    assert_string_equal(matches[0], "help");
+    assert_string_equal(matches[6], "stop");
+    assert_int_equal(cli_complete(cli, "s", NULL, 0), 5);
+    assert_int_equal(cli_complete(NULL, "s", matches, 8), 0);
+    cli_destroy(cli);
+}
+
+static void test_many_commands(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print};
+    cli_t* cli = cli_create(&config);
+    static char names[500][16];
+    for (size_t i = 0; i < 500; i++) {
+        snprintf(names[i], sizeof(names[i]), "diag-%zu", (i * 7919) % 500);
+        cli_register(cli, names[i], "", (i == 250 ? command_second : command_first));
+    }
+    assert_int_equal(process_line(cli, names[250]), 2);
+    assert_int_equal(process_line(cli, names[499]), 1);
+    assert_int_equal(cli_complete(cli, "diag-", NULL, 0), 500);
+    assert_int_equal(cli_complete(cli, "diag-49", NULL, 0), 11);
+    cli_destroy(cli);
+}
+
+static void test_process_buffer(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print, .max_input_buffer_size = 16, .max_parameter_count = 3};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "first", "", command_first);
+    cli_register(cli, "second", "", command_second);
+
+    assert_int_equal(cli_process_buffer(cli, NULL, 0), CLI_RETURN_CONTINUE);
+    assert_int_equal(cli_process_buffer(cli, "fir", 3), CLI_RETURN_CONTINUE);
+    called_command = 0;
+    const char* block = "st a\tb\r\n\r\nsecond x y\r\nfirst";
+    assert_int_equal(cli_process_buffer(cli, block, strlen(block)), 2);
+    assert_int_equal(called_command, 2);
+    assert_int_equal(called_argc, 3);
+    assert_int_equal(cli_process(cli, '\r'), 1);
+    assert_int_equal(called_argc, 1);
+
+    /* A too long line is truncated like with cli_process, and too many parameters reset the line. */
+    assert_int_equal(cli_process_buffer(cli, "first 0123456789abcdef", 22), CLI_RETURN_ERROR_PARAMETER_BUFFER_OVERFLOW);
+    assert_int_equal(cli_process_buffer(cli, "\r", 1), 1);
+    assert_int_equal(called_argc, 2);
+    assert_int_equal(cli_process_buffer(cli, "first 1 2 3\r", 12), CLI_RETURN_ERROR_PARAMETER_COUNT_EXCEEDED);
+    assert_int_equal(cli_process_buffer(cli, "second\r", 7), 2);
+    assert_int_equal(called_argc, 1);
+    cli_destroy(cli);
+}
+
+static void test_process_full_line(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print, .max_input_buffer_size = 5};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "first", "", command_first);
+    assert_int_equal(process_line(cli, "first"), 1);
+    for (const char* c = "firstx"; *c; c++) {
+        cli_process(cli, *c);
+    }
+    assert_int_equal(cli_process(cli, '\r'), 1);
+    cli_destroy(cli);
+}
+
+typedef struct captured_output {
+    char data[1024];
+    size_t size;
+    int writes;
+} captured_output_t;
+
+static void capture_write(void* context, const char* data, size_t size) {
+    captured_output_t* output = context;
+    assert_true(output->size + size < sizeof(output->data));
+    memcpy(output->data + output->size, data, size);
+    output->size += size;
+    output->data[output->size] = '\0';
+    output->writes++;
+}
+
+static int command_verbose(cli_t* cli, int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    for (int i = 0; i < 20; i++) {
+        cli_printf(cli, "line %02d\n", i);
+    }
+    return 0;
+}
+
+static void test_output_buffer(void** state) {
+    (void)state;  // unused
+    captured_output_t output = {0};
+    cli_config_t config = {.write = capture_write, .write_context = &output, .output_buffer_size = 128};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "verbose", "", command_verbose);
+
+    assert_int_equal(process_line(cli, "verbose"), 0);
+    assert_int_equal(output.size, 20 * 8);
+    assert_int_equal(output.writes, 2);
+    assert_memory_equal(output.data, "line 00\nline 01\n", 16);
+    assert_memory_equal(output.data + 19 * 8, "line 19\n", 8);
+
+    output.size = 0;
+    output.writes = 0;
+    cli_printf(cli, "[%5s|%-5s|%c|%%|%s]", "ab", "cd", 'x', (const char*)NULL);
+    cli_printf(cli, "[%d|%i|%05d|%-4d|%u|%x|%X]", -12, 0, -42, 7, 3000000000u, 0xbeefu, 0xbeefu);
+    cli_printf(cli, "[%ld|%lld|%zu|%*d|%q]", -1234567890l, -9000000000ll, (size_t)77, 4, 5);
+    assert_int_equal(output.writes, 0);
+    cli_flush(cli);
+    assert_int_equal(output.writes, 1);
+    assert_string_equal(output.data,
+                        "[   ab|cd   |x|%|(null)]"
+                        "[-12|0|-0042|7   |3000000000|beef|BEEF]"
+                        "[-1234567890|-9000000000|77|   5|%q]");
+    cli_flush(cli);
+    assert_int_equal(output.writes, 1);
+
+    output.size = 0;
+    cli_write(cli, "0123456789", 10);
+    cli_destroy(cli);
+    assert_string_equal(output.data, "0123456789");
+}
+
+static void test_registry(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print, .context = &called_command};
+    cli_registry_t* registry = cli_registry_create();
+    assert_true(cli_registry_register(registry, "first", "", command_first));
+    assert_false(cli_registry_register(registry, NULL, "", command_first));
+    assert_false(cli_registry_register(registry, "", "", command_first));
+    assert_false(cli_registry_is_frozen(registry));
+    assert_null(cli_create_session(&config, registry));
+
+    cli_registry_freeze(registry);
+    assert_true(cli_registry_is_frozen(registry));
+    assert_false(cli_registry_register(registry, "second", "", command_second));
+    cli_t* first = cli_create_session(&config, registry);
+    cli_t* second = cli_create_session(&config, registry);
+    assert_non_null(first);
+    assert_non_null(second);
+    assert_ptr_equal(cli_get_context(first), &called_command);
+    cli_register(first, "second", "", command_second);
+
+    /* Sessions share the commands, but not their input. */
+    cli_process_buffer(first, "fir", 3);
+    assert_int_equal(process_line(second, "first a"), 1);
+    assert_int_equal(called_argc, 2);
+    assert_int_equal(process_line(first, "st"), 1);
+    assert_int_equal(called_argc, 1);
+    assert_int_equal(process_line(second, "second"), CLI_RETURN_ERROR_COMMAND_NOT_FOUND);
+    const char* matches[4];
+    assert_int_equal(cli_complete(first, "", matches, 4), 2);
+    assert_int_equal(cli_registry_complete(registry, "f", matches, 4), 1);
+    assert_string_equal(matches[0], "first");
+
+    /* Help lists its title and the two commands, but no command without a name. */
+    captured_output_t output = {0};
+    cli_config_t captured_config = {.write = capture_write, .write_context = &output};
+    cli_t* captured = cli_create_session(&captured_config, registry);
+    assert_int_equal(process_line(captured, "help"), 0);
+    size_t lines = 0;
+    for (size_t i = 0; i < output.size; i++) {
+        lines += (output.data[i] == '\n');
+    }
+    assert_int_equal(lines, 3);
+    cli_destroy(captured);
+    cli_destroy(first);
+    cli_destroy(second);
+    cli_registry_destroy(registry);
+}
+
+#define SESSION_COUNT 256
+#define SESSION_THREAD_COUNT 8
+#define SESSION_ROUNDS 4
+
+typedef struct session {
+    cli_t* cli;
+    int fd;
+    int id;
+} session_t;
+
+static void session_write(void* context, const char* data, size_t size) {
+    const session_t* session = context;
+    while (size > 0) {
+        ssize_t written = write(session->fd, data, size);
+        assert_true(written > 0);
+        data += written;
+        size -= (size_t)written;
+    }
+}
+
+static int command_echo(cli_t* cli, int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        cli_printf(cli, "%s%s", (i > 1 ? " " : ""), argv[i]);
+    }
+    cli_printf(cli, "\n");
+    return 0;
+}
+
+static int command_whoami(cli_t* cli, int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    const session_t* session = cli_get_context(cli);
+    cli_printf(cli, "session %d\n", session->id);
+    return 0;
+}
+
+/* Serves every SESSION_THREAD_COUNT-th session until the client closed all of them. */
+static void* serve_sessions(void* argument) {
+    session_t* sessions = argument;
+    struct pollfd fds[SESSION_COUNT / SESSION_THREAD_COUNT];
+    session_t* served[SESSION_COUNT / SESSION_THREAD_COUNT];
+    nfds_t open = 0;
+    for (size_t i = 0; i < SESSION_COUNT; i += SESSION_THREAD_COUNT) {
+        fds[open] = (struct pollfd){.fd = sessions[i].fd, .events = POLLIN};
+        served[open++] = &sessions[i];
+    }
+    while (open > 0) {
+        if (poll(fds, open, -1) < 0) {
+            return NULL;
+        }
+        for (nfds_t i = 0; i < open; i++) {
+            if (!fds[i].revents) {
+                continue;
+            }
+            char data[64];
+            ssize_t size = read(fds[i].fd, data, sizeof(data));
+            if (size > 0) {
+                cli_process_buffer(served[i]->cli, data, (size_t)size);
+                continue;
+            }
+            open--;
+            fds[i] = fds[open];
+            served[i] = served[open];
+            i--;
+        }
+    }
+    return NULL;
+}
+
+static void read_reply(int fd, const char* expected) {
+    char reply[64];
+    size_t size = strlen(expected);
+    size_t received = 0;
+    while (received < size) {
+        ssize_t chunk = read(fd, reply + received, size - received);
+        assert_true(chunk > 0);
+        received += (size_t)chunk;
+    }
+    assert_memory_equal(reply, expected, size);
+}
+
+static void test_concurrent_sessions(void** state) {
+    (void)state;  // unused
+    cli_registry_t* registry = cli_registry_create();
+    cli_registry_register(registry, "echo", "Print the parameters", command_echo);
+    cli_registry_register(registry, "whoami", "Print the session", command_whoami);
+    cli_registry_freeze(registry);
+
+    static session_t sessions[SESSION_COUNT];
+    int clients[SESSION_COUNT];
+    for (int i = 0; i < SESSION_COUNT; i++) {
+        int fds[2];
+        assert_int_equal(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        clients[i] = fds[0];
+        sessions[i].fd = fds[1];
+        sessions[i].id = i;
+        cli_config_t config = {.write = session_write, .write_context = &sessions[i], .context = &sessions[i]};
+        sessions[i].cli = cli_create_session(&config, registry);
+        assert_non_null(sessions[i].cli);
+    }
+    pthread_t threads[SESSION_THREAD_COUNT];
+    for (int i = 0; i < SESSION_THREAD_COUNT; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, serve_sessions, &sessions[i]), 0);
+    }
+
+    /* All sessions have their requests in flight before the first reply is read. */
+    for (int round = 0; round < SESSION_ROUNDS; round++) {
+        char request[64];
+        char expected[64];
+        for (int i = 0; i < SESSION_COUNT; i++) {
+            int size = snprintf(request, sizeof(request), "echo %d\t%d\r\nwhoami\r\n", i, round);
+            assert_int_equal(write(clients[i], request, (size_t)size), size);
+        }
+        for (int i = 0; i < SESSION_COUNT; i++) {
+            snprintf(expected, sizeof(expected), "%d%d\nsession %d\n", i, round, i);
+            read_reply(clients[i], expected);
+        }
+    }
+
+    for (int i = 0; i < SESSION_COUNT; i++) {
+        close(clients[i]);
+    }
+    for (int i = 0; i < SESSION_THREAD_COUNT; i++) {
+        assert_int_equal(pthread_join(threads[i], NULL), 0);
+    }
+    for (int i = 0; i < SESSION_COUNT; i++) {
+        cli_destroy(sessions[i].cli);
+        close(sessions[i].fd);
+    }
+    cli_registry_destroy(registry);
+}
+
+static void test_execute_in_place(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print, .max_parameter_count = 3};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "first", "", command_first);
+    cli_register(cli, "second", "", command_second);
+
+    cli_process_buffer(cli, "seco", 4);
+    char line[] = " first a\tb";
+    assert_int_equal(cli_execute(cli, line, strlen(line)), 1);
+    assert_int_equal(called_argc, 3);
+    assert_memory_equal(line, " first\0a\0b", sizeof(line));
+    char too_long[] = "first 1 2 3";
+    assert_int_equal(cli_execute(cli, too_long, strlen(too_long)), CLI_RETURN_ERROR_PARAMETER_COUNT_EXCEEDED);
+    assert_int_equal(process_line(cli, "nd"), 2);
+    cli_destroy(cli);
+}
+
+typedef struct script_failures {
+    size_t lines[4];
+    int results[4];
+    size_t count;
+} script_failures_t;
+
+static void script_error(void* context, size_t line, const char* command, int result) {
+    script_failures_t* failures = context;
+    assert_true(failures->count < 4);
+    assert_string_equal(command, (result == CLI_RETURN_ERROR_COMMAND_NOT_FOUND ? "unknown" : "second"));
+    failures->lines[failures->count] = line;
+    failures->results[failures->count++] = result;
+}
+
+static int command_succeed(cli_t* cli, int argc, char** argv) {
+    (void)cli;
+    (void)argv;
+    called_command = 3;
+    called_argc = argc;
+    return 0;
+}
+
+static uint64_t script_clock(void) {
+    static uint64_t now;
+    return (now += 1000);
+}
+
+static void test_script_run(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "first", "", command_succeed);
+    cli_register(cli, "second", "", command_second);
+    char script[] = "# settings\r\nfirst a b\r\n\r\n  unknown x\nsecond\nfirst last";
+    char copy[sizeof(script)];
+    memcpy(copy, script, sizeof(script));
+
+    script_failures_t failures = {0};
+    cli_script_config_t script_config = {.policy = CLI_SCRIPT_CONTINUE_ON_ERROR,
+                                         .error = script_error,
+                                         .error_context = &failures,
+                                         .clock = script_clock};
+    cli_script_result_t result = {0};
+    assert_int_equal(cli_script_run(cli, script, strlen(script), &script_config, &result),
+                     CLI_RETURN_ERROR_COMMAND_NOT_FOUND);
+    assert_int_equal(result.lines, 6);
+    assert_int_equal(result.executed, 4);
+    assert_int_equal(result.failed, 2);
+    assert_int_equal(result.first_failed_line, 4);
+    assert_int_equal(result.consumed, strlen(copy));
+    assert_false(result.stopped);
+    assert_int_equal(result.elapsed_us, 1000);
+    assert_int_equal(result.lines_per_second, 6000);
+    assert_int_equal(failures.count, 2);
+    assert_int_equal(failures.lines[1], 5);
+    assert_int_equal(failures.results[1], 2);
+    assert_int_equal(called_command, 3);
+    assert_int_equal(called_argc, 2);
+
+    result = (cli_script_result_t){0};
+    assert_int_equal(cli_script_run(cli, copy, strlen(copy), NULL, &result), CLI_RETURN_ERROR_COMMAND_NOT_FOUND);
+    assert_int_equal(result.lines, 4);
+    assert_true(result.stopped);
+    assert_int_equal(result.consumed, strlen("# settings\r\nfirst a b\r\n\r\n  unknown x\n"));
+    cli_destroy(cli);
+}
+
+static void test_script_stream(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "first", "", command_succeed);
+    const char* script = "first\nfirst 1\nfirst 1 2\nfirst 1 2 3\nmissing\nfirst\n";
+    size_t length = strlen(script);
+
+    /* Blocks of a fixed size, the unfinished line is moved to the front of the next block. */
+    char block[16];
+    size_t kept = 0;
+    size_t position = 0;
+    cli_script_config_t script_config = {.stream = true};
+    cli_script_result_t result = {0};
+    int failure = 0;
+    while (position < length && !result.stopped) {
+        size_t size = sizeof(block) - kept;
+        size = (length - position < size ? length - position : size);
+        memcpy(block + kept, script + position, size);
+        position += size;
+        int code = cli_script_run(cli, block, kept + size, &script_config, &result);
+        failure = (failure ? failure : code);
+        kept = kept + size - result.consumed;
+        memmove(block, block + result.consumed, kept);
+    }
+    assert_int_equal(failure, CLI_RETURN_ERROR_COMMAND_NOT_FOUND);
+    assert_int_equal(called_argc, 4);
+    assert_int_equal(result.lines, 5);
+    assert_int_equal(result.first_failed_line, 5);
+    assert_true(result.stopped);
+    assert_int_equal(result.elapsed_us, 0);
+    cli_destroy(cli);
+}
+
+#if defined(__linux__)
+static void test_script_file(void** state) {
+    (void)state;  // unused
+    cli_config_t config = {.print = test_print};
+    cli_t* cli = cli_create(&config);
+    cli_register(cli, "first", "", command_succeed);
+    char path[] = "/tmp/cli-script-XXXXXX";
+    int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    /* The last line fills the file up to a page boundary, without a line end. */
+    static char script[4096];
+    memset(script, ' ', sizeof(script));
+    for (size_t i = 0; i < 100; i++) {
+        memcpy(script + i * 10, "first a b\n", 10);
+    }
+    memcpy(script + sizeof(script) - 7, "first c", 7);
+    assert_int_equal(write(fd, script, sizeof(script)), sizeof(script));
+    close(fd);
+
+    cli_script_result_t result;
+    assert_int_equal(cli_script_run_file(cli, path, NULL, &result), 0);
+    assert_int_equal(result.lines, 101);
+    assert_int_equal(result.executed, 101);
+    assert_int_equal(called_argc, 2);
+    unlink(path);
+    assert_int_equal(cli_script_run_file(cli, path, NULL, &result), CLI_RETURN_ERROR_SCRIPT_FILE);
+    cli_destroy(cli);
+}
+#endif
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(null_test),
+        cmocka_unit_test(test_command_lookup),
+        cmocka_unit_test(test_command_completion),
+        cmocka_unit_test(test_many_commands),
+        cmocka_unit_test(test_process_buffer),
+        cmocka_unit_test(test_process_full_line),
+        cmocka_unit_test(test_output_buffer),
+        cmocka_unit_test(test_registry),
+        cmocka_unit_test(test_concurrent_sessions),
+        cmocka_unit_test(test_execute_in_place),
+        cmocka_unit_test(test_script_run),
+        cmocka_unit_test(test_script_stream),
+#if defined(__linux__)
+        cmocka_unit_test(test_script_file),
+#endif
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
-}
\ No newline at end of file
+}
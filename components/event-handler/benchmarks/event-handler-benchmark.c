@@ -0,0 +1,151 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "event-handler-mpsc.h"
+#include "event-handler-pool.h"
+#include "event-handler.h"
+
+#define MPSC_QUEUE_DEPTH (4096)
+#define MPSC_EVENTS_PER_PRODUCER (1000000)
+#define MPSC_DEFAULT_MAX_PRODUCERS (8)
+#define POOL_IDS (1024)
+#define POOL_EVENTS (1000000)
+#define POOL_HANDLER_WORK (200)
+#define POOL_MAX_WORKERS (16)
+
+typedef struct producer_context {
+    event_handler_mpsc_t* mpsc;
+    uint16_t id;
+} producer_context_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void counting_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)id;
+    (void)payload;
+    (void)size;
+    (*(size_t*)context)++;
+}
+
+static void* producer(void* arg) {
+    producer_context_t* context = arg;
+    for (uint32_t i = 0; i < MPSC_EVENTS_PER_PRODUCER; i++) {
+        while (!event_handler_mpsc_post(context->mpsc, context->id, &i, sizeof(i))) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void benchmark_mpsc(size_t producer_count) {
+    event_handler_t* handler = event_handler_create();
+    event_handler_mpsc_t* mpsc = event_handler_mpsc_create(handler, MPSC_QUEUE_DEPTH, sizeof(uint32_t));
+    size_t received = 0;
+    for (size_t i = 0; i < producer_count; i++) {
+        event_handler_register(handler, (uint16_t)i, &received, counting_handler);
+    }
+    pthread_t* threads = calloc(producer_count, sizeof(pthread_t));
+    producer_context_t* contexts = calloc(producer_count, sizeof(producer_context_t));
+
+    double start = now_seconds();
+    for (size_t i = 0; i < producer_count; i++) {
+        contexts[i].mpsc = mpsc;
+        contexts[i].id = (uint16_t)i;
+        pthread_create(&threads[i], NULL, producer, &contexts[i]);
+    }
+    size_t expected = producer_count * MPSC_EVENTS_PER_PRODUCER;
+    while (received < expected) {
+        if (event_handler_mpsc_run(mpsc) == 0) {
+            sched_yield();
+        }
+    }
+    double elapsed = now_seconds() - start;
+    for (size_t i = 0; i < producer_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("mpsc: %2zu producer(s): %10.0f events/s\n", producer_count, (double)expected / elapsed);
+    free(contexts);
+    free(threads);
+    event_handler_mpsc_destroy(mpsc);
+    event_handler_destroy(handler);
+}
+
+static void busy_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)context;
+    (void)size;
+    uint32_t value;
+    memcpy(&value, payload, sizeof(value));
+    volatile uint32_t sink = value;
+    for (uint32_t i = 0; i < POOL_HANDLER_WORK; i++) {
+        sink = sink * 31 + id;
+    }
+}
+
+static void benchmark_pool(size_t worker_count) {
+    event_handler_t* handler = event_handler_create();
+    for (uint16_t id = 0; id < POOL_IDS; id++) {
+        event_handler_register(handler, id, NULL, busy_handler);
+    }
+    event_handler_pool_config_t config = {.worker_count = worker_count, .max_payload_size = sizeof(uint32_t)};
+    event_handler_pool_t* pool = event_handler_pool_create(handler, &config);
+
+    double start = now_seconds();
+    for (uint32_t i = 0; i < POOL_EVENTS; i++) {
+        while (!event_handler_pool_post(pool, (uint16_t)(i % POOL_IDS), &i, sizeof(i))) {
+            sched_yield();
+        }
+    }
+    event_handler_pool_flush(pool);
+    double elapsed = now_seconds() - start;
+
+    printf("pool: %2zu worker(s):  %10.0f events/s\n", worker_count, (double)POOL_EVENTS / elapsed);
+    event_handler_pool_destroy(pool);
+    event_handler_destroy(handler);
+}
+
+int main(int argc, char** argv) {
+    size_t max_producers = (argc > 1) ? strtoul(argv[1], NULL, 10) : MPSC_DEFAULT_MAX_PRODUCERS;
+    for (size_t producers = 1; producers <= max_producers; producers++) {
+        benchmark_mpsc(producers);
+    }
+    for (size_t workers = 1; workers <= POOL_MAX_WORKERS; workers *= 2) {
+        benchmark_pool(workers);
+    }
+    return 0;
+}
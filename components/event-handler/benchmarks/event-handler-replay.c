@@ -0,0 +1,120 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event-handler-trace.h"
+#include "event-handler.h"
+
+#define REPLAY_QUEUE_DEPTH (1024)
+
+static void touching_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)id;
+    uint64_t* checksum = context;
+    const unsigned char* bytes = payload;
+    for (size_t i = 0; i < size; i++) {
+        *checksum += bytes[i];
+    }
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "Usage: %s <trace file> [--post] [--realtime]\n", name);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    event_handler_replay_config_t config = {.path = EVENT_HANDLER_REPLAY_SEND};
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--post") == 0) {
+            config.path = EVENT_HANDLER_REPLAY_POST;
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            config.realtime = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    event_handler_trace_reader_t* reader = event_handler_trace_reader_open(argv[1]);
+    if (!reader) {
+        fprintf(stderr, "Cannot open trace %s\n", argv[1]);
+        return 1;
+    }
+
+    /* First pass finds the IDs to register handlers for and the biggest payload the queue has to hold. */
+    static bool seen[UINT16_MAX + 1];
+    size_t max_payload_size = 1;
+    event_handler_trace_record_t record;
+    const void* payload;
+    while (event_handler_trace_reader_next(reader, &record, &payload)) {
+        seen[record.id] = true;
+        if (record.captured > max_payload_size) {
+            max_payload_size = record.captured;
+        }
+    }
+    event_handler_trace_reader_rewind(reader);
+
+    event_handler_queue_config_t queue_config = {.depth = REPLAY_QUEUE_DEPTH, .max_payload_size = max_payload_size};
+    event_handler_t* handler = (config.path == EVENT_HANDLER_REPLAY_POST ? event_handler_create_with_queue(&queue_config)
+                                                                         : event_handler_create());
+    uint64_t checksum = 0;
+    size_t ids = 0;
+    for (size_t id = 0; id <= UINT16_MAX; id++) {
+        if (seen[id]) {
+            event_handler_register(handler, (uint16_t)id, &checksum, touching_handler);
+            ids++;
+        }
+    }
+
+    event_handler_replay_stats_t stats;
+    if (!event_handler_trace_replay(handler, reader, &config, &stats)) {
+        fprintf(stderr, "Replay failed\n");
+        return 1;
+    }
+    double seconds = (double)stats.elapsed / 1e9;
+    printf("replay %s%s: %llu events, %zu ids, %llu failed\n",
+           (config.path == EVENT_HANDLER_REPLAY_POST ? "post" : "send"),
+           (config.realtime ? " realtime" : ""),
+           (unsigned long long)stats.events,
+           ids,
+           (unsigned long long)stats.failed);
+    printf("  %.3f s, %.0f events/s, %.2f MB/s\n",
+           seconds,
+           seconds > 0 ? (double)stats.events / seconds : 0.0,
+           seconds > 0 ? (double)stats.bytes / seconds / 1e6 : 0.0);
+    printf("  dispatch latency: mean %.0f ns, max %llu ns (checksum %llu)\n",
+           stats.events ? (double)stats.total_latency / (double)stats.events : 0.0,
+           (unsigned long long)stats.max_latency,
+           (unsigned long long)checksum);
+
+    event_handler_destroy(handler);
+    event_handler_trace_reader_close(reader);
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#include "event-handler-instrumentation.h"
+#include "event-handler-private.h"
+
+#if EVENT_HANDLER_INSTRUMENTATION
+
+static size_t latency_bucket(uint64_t duration) {
+    size_t bucket = (duration ? (size_t)(64 - __builtin_clzll(duration)) : 0);
+    return (bucket < EVENT_HANDLER_LATENCY_BUCKETS ? bucket : EVENT_HANDLER_LATENCY_BUCKETS - 1);
+}
+
+void event_handler_latency_record(event_handler_latency_t* latency, uint64_t duration) {
+    atomic_fetch_add_explicit(&latency->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&latency->total, duration, memory_order_relaxed);
+    atomic_fetch_add_explicit(&latency->histogram[latency_bucket(duration)], 1, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&latency->max, memory_order_relaxed);
+    while (duration > max &&
+           !atomic_compare_exchange_weak_explicit(
+               &latency->max, &max, duration, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void latency_read(event_handler_latency_t* latency, event_handler_latency_stats_t* stats, bool reset) {
+    stats->count = (reset ? atomic_exchange_explicit(&latency->count, 0, memory_order_relaxed)
+                          : atomic_load_explicit(&latency->count, memory_order_relaxed));
+    stats->total = (reset ? atomic_exchange_explicit(&latency->total, 0, memory_order_relaxed)
+                          : atomic_load_explicit(&latency->total, memory_order_relaxed));
+    stats->max = (reset ? atomic_exchange_explicit(&latency->max, 0, memory_order_relaxed)
+                        : atomic_load_explicit(&latency->max, memory_order_relaxed));
+    for (size_t i = 0; i < EVENT_HANDLER_LATENCY_BUCKETS; i++) {
+        stats->histogram[i] = (reset ? atomic_exchange_explicit(&latency->histogram[i], 0, memory_order_relaxed)
+                                     : atomic_load_explicit(&latency->histogram[i], memory_order_relaxed));
+    }
+}
+
+bool event_handler_get_event_stats(event_handler_t* handler, uint16_t id, event_handler_latency_stats_t* stats) {
+    if (!handler || !stats) {
+        return false;
+    }
+    event_handler_bucket_t* bucket = event_handler_find_bucket(handler, id);
+    if (!bucket || bucket->count == 0) {
+        return false;
+    }
+    latency_read(&bucket->latency, stats, false);
+    return true;
+}
+
+bool event_handler_get_callback_stats(event_handler_t* handler,
+                                      uint16_t id,
+                                      void* context,
+                                      event_handler_callback_t callback,
+                                      event_handler_latency_stats_t* stats) {
+    if (!handler || !stats) {
+        return false;
+    }
+    event_handler_bucket_t* bucket = event_handler_find_bucket(handler, id);
+    if (!bucket) {
+        return false;
+    }
+    for (size_t i = 0; i < bucket->count; i++) {
+        if (bucket->entries[i].callback == callback && bucket->entries[i].context == context) {
+            latency_read(&bucket->entries[i].latency, stats, false);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t event_handler_snapshot_stats(event_handler_t* handler,
+                                    event_handler_latency_record_t* records,
+                                    size_t capacity,
+                                    bool reset) {
+    if (!handler) {
+        return 0;
+    }
+    size_t count = 0;
+    event_handler_latency_stats_t discarded;
+    for (size_t i = 0; i < handler->table_size; i++) {
+        event_handler_bucket_t* bucket = handler->table[i];
+        if (!bucket) {
+            continue;
+        }
+        if (reset) {
+            latency_read(&bucket->latency, &discarded, true);
+        }
+        for (size_t j = 0; j < bucket->count; j++, count++) {
+            if (records && count < capacity) {
+                records[count].id = bucket->id;
+                records[count].callback = bucket->entries[j].callback;
+                records[count].context = bucket->entries[j].context;
+                latency_read(&bucket->entries[j].latency, &records[count].stats, reset);
+            } else if (reset) {
+                latency_read(&bucket->entries[j].latency, &discarded, true);
+            }
+        }
+    }
+    return count;
+}
+
+void event_handler_reset_stats(event_handler_t* handler) {
+    event_handler_snapshot_stats(handler, NULL, 0, true);
+}
+
+#else
+
+bool event_handler_get_event_stats(event_handler_t* handler, uint16_t id, event_handler_latency_stats_t* stats) {
+    (void)handler;
+    (void)id;
+    (void)stats;
+    return false;
+}
+
+bool event_handler_get_callback_stats(event_handler_t* handler,
+                                      uint16_t id,
+                                      void* context,
+                                      event_handler_callback_t callback,
+                                      event_handler_latency_stats_t* stats) {
+    (void)handler;
+    (void)id;
+    (void)context;
+    (void)callback;
+    (void)stats;
+    return false;
+}
+
+size_t event_handler_snapshot_stats(event_handler_t* handler,
+                                    event_handler_latency_record_t* records,
+                                    size_t capacity,
+                                    bool reset) {
+    (void)handler;
+    (void)records;
+    (void)capacity;
+    (void)reset;
+    return 0;
+}
+
+void event_handler_reset_stats(event_handler_t* handler) {
+    (void)handler;
+}
+
+#endif
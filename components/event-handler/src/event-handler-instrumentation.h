@@ -0,0 +1,122 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#ifndef EVENT_HANDLER_INSTRUMENTATION_H
+#define EVENT_HANDLER_INSTRUMENTATION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "event-handler.h"
+
+/**
+ * @defgroup event_handler_instrumentation Event Handler instrumentation
+ * @ingroup event_handler
+ * @brief Dispatch counts and callback latency per event ID and per handler
+ *
+ * Instrumentation is compiled in only when the library is built with `EVENT_HANDLER_INSTRUMENTATION` set
+ * (CMake: `-DG2LABS_CDF_EVENT_HANDLER_INSTRUMENTATION=1`). Otherwise event_handler_send() has no extra work
+ * and the functions below report that no data is available.
+ *
+ * Times are taken with the clock set by event_handler_set_clock(), in its units. Without a clock only the
+ * dispatch counts are recorded.
+ * @{
+ */
+#ifndef EVENT_HANDLER_INSTRUMENTATION
+#define EVENT_HANDLER_INSTRUMENTATION 0 /**< Set to 1 to compile the instrumentation in */
+#endif
+
+#define EVENT_HANDLER_LATENCY_BUCKETS 32 /**< Number of log2 latency histogram buckets */
+
+typedef struct event_handler_latency_stats {
+    uint64_t count; /**< Number of dispatches */
+    uint64_t total; /**< Sum of callback times */
+    uint64_t max;   /**< Longest callback time */
+    /**
+     * Bucket 0 counts zero durations, bucket n counts durations in [2^(n-1), 2^n).
+     * The last bucket also counts everything longer.
+     */
+    uint64_t histogram[EVENT_HANDLER_LATENCY_BUCKETS];
+} event_handler_latency_stats_t; /**< Latency statistics structure definition */
+
+typedef struct event_handler_latency_record {
+    uint16_t id;                         /**< Event ID */
+    event_handler_callback_t callback;   /**< Handler callback */
+    void* context;                       /**< Handler context */
+    event_handler_latency_stats_t stats; /**< Handler statistics */
+} event_handler_latency_record_t; /**< Snapshot record of a single handler */
+
+/**
+ * @brief Get statistics of all handlers called for an event ID
+ *
+ * The time of a dispatch is the time spent in all dynamically registered handlers of the ID.
+ * @param[in] handler pointer to the event handler
+ * @param[in] id event ID
+ * @param[out] stats pointer to statistics to fill
+ * @return true if statistics were retrieved
+ * @return false if instrumentation is disabled or no handler was registered for @p id
+ */
+bool event_handler_get_event_stats(event_handler_t* handler, uint16_t id, event_handler_latency_stats_t* stats);
+
+/**
+ * @brief Get statistics of a single handler
+ * @param[in] handler pointer to the event handler
+ * @param[in] id event ID the handler was registered for
+ * @param[in] context context the handler was registered with
+ * @param[in] callback callback the handler was registered with
+ * @param[out] stats pointer to statistics to fill
+ * @return true if statistics were retrieved
+ * @return false if instrumentation is disabled or no such handler was registered
+ */
+bool event_handler_get_callback_stats(event_handler_t* handler,
+                                      uint16_t id,
+                                      void* context,
+                                      event_handler_callback_t callback,
+                                      event_handler_latency_stats_t* stats);
+
+/**
+ * @brief Copy statistics of all registered handlers
+ * @param[in] handler pointer to the event handler
+ * @param[out] records array to fill, may be NULL to only count the handlers
+ * @param[in] capacity number of elements in @p records
+ * @param[in] reset clear the counters after copying them
+ * @return number of registered handlers, may be bigger than @p capacity
+ * @return 0 if instrumentation is disabled
+ */
+size_t event_handler_snapshot_stats(event_handler_t* handler,
+                                    event_handler_latency_record_t* records,
+                                    size_t capacity,
+                                    bool reset);
+
+/**
+ * @brief Clear all instrumentation counters
+ * @param[in] handler pointer to the event handler
+ */
+void event_handler_reset_stats(event_handler_t* handler);
+
+/**
+ * @}
+ */
+
+#endif  // EVENT_HANDLER_INSTRUMENTATION_H
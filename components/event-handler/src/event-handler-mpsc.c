@@ -0,0 +1,161 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#include "event-handler-mpsc.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if ATOMIC_LONG_LOCK_FREE != 2
+#error "event-handler MPSC queue requires lock-free atomics"
+#endif
+
+#define EVENT_HANDLER_MPSC_CACHE_LINE_SIZE (64)
+
+/**
+ * Bounded queue of cells with sequence numbers. A cell is free for the producer holding ticket `pos` when its
+ * sequence equals `pos`, and ready for the consumer when it equals `pos + 1`.
+ */
+typedef struct event_handler_mpsc_cell {
+    atomic_size_t sequence;
+    uint16_t id;
+    size_t size;
+    alignas(max_align_t) unsigned char payload[];
+} event_handler_mpsc_cell_t;
+
+typedef struct event_handler_mpsc {
+    alignas(EVENT_HANDLER_MPSC_CACHE_LINE_SIZE) atomic_size_t tail;
+    atomic_size_t dropped;
+    alignas(EVENT_HANDLER_MPSC_CACHE_LINE_SIZE) size_t head;
+    event_handler_t* handler;
+    size_t mask;
+    size_t max_payload_size;
+    size_t cell_size;
+    unsigned char* cells;
+} event_handler_mpsc_t;
+
+static event_handler_mpsc_cell_t* get_cell(event_handler_mpsc_t* mpsc, size_t position) {
+    return (event_handler_mpsc_cell_t*)(mpsc->cells + (position & mpsc->mask) * mpsc->cell_size);
+}
+
+event_handler_mpsc_t* event_handler_mpsc_create(event_handler_t* handler, size_t depth, size_t max_payload_size) {
+    if (!handler || depth == 0) {
+        return NULL;
+    }
+    event_handler_mpsc_t* mpsc = aligned_alloc(alignof(event_handler_mpsc_t), sizeof(event_handler_mpsc_t));
+    if (!mpsc) {
+        return NULL;
+    }
+    memset(mpsc, 0, sizeof(event_handler_mpsc_t));
+    size_t size = 1;
+    while (size < depth) {
+        size <<= 1;
+    }
+    mpsc->cell_size = sizeof(event_handler_mpsc_cell_t) + max_payload_size;
+    mpsc->cell_size = (mpsc->cell_size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    mpsc->cells = calloc(size, mpsc->cell_size);
+    if (!mpsc->cells) {
+        free(mpsc);
+        return NULL;
+    }
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&((event_handler_mpsc_cell_t*)(mpsc->cells + i * mpsc->cell_size))->sequence, i);
+    }
+    atomic_init(&mpsc->tail, 0);
+    atomic_init(&mpsc->dropped, 0);
+    mpsc->handler = handler;
+    mpsc->mask = size - 1;
+    mpsc->max_payload_size = max_payload_size;
+    return mpsc;
+}
+
+void event_handler_mpsc_destroy(event_handler_mpsc_t* mpsc) {
+    if (!mpsc) {
+        return;
+    }
+    free(mpsc->cells);
+    free(mpsc);
+}
+
+bool event_handler_mpsc_post(event_handler_mpsc_t* mpsc, uint16_t id, const void* payload, size_t size) {
+    if (!mpsc || size > mpsc->max_payload_size || (size > 0 && !payload)) {
+        return false;
+    }
+    event_handler_mpsc_cell_t* cell;
+    size_t position = atomic_load_explicit(&mpsc->tail, memory_order_relaxed);
+    for (;;) {
+        cell = get_cell(mpsc, position);
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mpsc->tail, &position, position + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            atomic_fetch_add_explicit(&mpsc->dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            position = atomic_load_explicit(&mpsc->tail, memory_order_relaxed);
+        }
+    }
+    cell->id = id;
+    cell->size = size;
+    if (size > 0) {
+        memcpy(cell->payload, payload, size);
+    }
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    return true;
+}
+
+bool event_handler_mpsc_run_once(event_handler_mpsc_t* mpsc) {
+    if (!mpsc) {
+        return false;
+    }
+    event_handler_mpsc_cell_t* cell = get_cell(mpsc, mpsc->head);
+    if (atomic_load_explicit(&cell->sequence, memory_order_acquire) != mpsc->head + 1) {
+        return false;
+    }
+    /* The cell stays owned by the consumer until its sequence is advanced, so it is dispatched in place. */
+    event_handler_send(mpsc->handler, cell->id, cell->size ? cell->payload : NULL, cell->size);
+    atomic_store_explicit(&cell->sequence, mpsc->head + mpsc->mask + 1, memory_order_release);
+    mpsc->head++;
+    return true;
+}
+
+size_t event_handler_mpsc_run(event_handler_mpsc_t* mpsc) {
+    size_t count = 0;
+    while (event_handler_mpsc_run_once(mpsc)) {
+        count++;
+    }
+    return count;
+}
+
+size_t event_handler_mpsc_dropped(event_handler_mpsc_t* mpsc) {
+    if (!mpsc) {
+        return 0;
+    }
+    return atomic_load_explicit(&mpsc->dropped, memory_order_relaxed);
+}
@@ -0,0 +1,111 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#ifndef EVENT_HANDLER_MPSC_H
+#define EVENT_HANDLER_MPSC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "event-handler.h"
+
+/**
+ * @defgroup event_handler_mpsc Event Handler MPSC queue
+ * @ingroup event_handler
+ * @brief Lock-free multi-producer single-consumer front-end for the event handler
+ *
+ * Producers only use atomic operations, so events may be posted from any thread and from signal handlers.
+ * A single consumer dispatches them to the callbacks registered in the event handler.
+ * @{
+ */
+
+/**
+ * @brief MPSC queue type
+ *
+ * This is a declaration of the MPSC queue structure type. Use only by pointer.
+ */
+typedef struct event_handler_mpsc event_handler_mpsc_t;
+
+/**
+ * @brief Create a new MPSC queue feeding the event handler
+ * @param[in] handler pointer to the event handler which dispatches the events
+ * @param[in] depth number of queue slots, rounded up to a power of two
+ * @param[in] max_payload_size maximum payload size copied inline into a slot
+ * @return pointer to the newly created queue
+ * @return NULL if the queue could not be created
+ */
+event_handler_mpsc_t* event_handler_mpsc_create(event_handler_t* handler, size_t depth, size_t max_payload_size);
+
+/**
+ * @brief Destroy the MPSC queue
+ *
+ * Events still pending in the queue are discarded.
+ * @param[in] mpsc pointer to the queue
+ */
+void event_handler_mpsc_destroy(event_handler_mpsc_t* mpsc);
+
+/**
+ * @brief Post event to the MPSC queue
+ *
+ * This function is lock-free and async-signal-safe.
+ * @param[in] mpsc pointer to the queue
+ * @param[in] id event ID to be posted
+ * @param[in] payload pointer to possible payload, copied into the queue slot
+ * @param[in] size size of the payload
+ * @return true if the event was queued
+ * @return false if the queue is full or the payload is too big
+ */
+bool event_handler_mpsc_post(event_handler_mpsc_t* mpsc, uint16_t id, const void* payload, size_t size);
+
+/**
+ * @brief Dispatch a single event from the MPSC queue
+ *
+ * Must be called from the consumer thread only.
+ * @param[in] mpsc pointer to the queue
+ * @return true if an event was dispatched
+ * @return false if no event was ready
+ */
+bool event_handler_mpsc_run_once(event_handler_mpsc_t* mpsc);
+
+/**
+ * @brief Dispatch events from the MPSC queue until no more are ready
+ *
+ * Must be called from the consumer thread only.
+ * @param[in] mpsc pointer to the queue
+ * @return number of dispatched events
+ */
+size_t event_handler_mpsc_run(event_handler_mpsc_t* mpsc);
+
+/**
+ * @brief Get number of events dropped because the queue was full
+ * @param[in] mpsc pointer to the queue
+ * @return number of dropped events
+ */
+size_t event_handler_mpsc_dropped(event_handler_mpsc_t* mpsc);
+
+/**
+ * @}
+ */
+
+#endif  // EVENT_HANDLER_MPSC_H
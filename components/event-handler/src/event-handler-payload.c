@@ -0,0 +1,243 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#include "event-handler-payload.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#define EVENT_HANDLER_PAYLOAD_NO_BLOCK (0)
+
+typedef struct event_handler_payload_class_state event_handler_payload_class_state_t;
+
+typedef struct event_handler_payload {
+    atomic_uint references;
+    atomic_uint_least32_t next;
+    event_handler_payload_class_state_t* owner;
+    size_t size;
+    alignas(max_align_t) unsigned char data[];
+} event_handler_payload_t;
+
+/**
+ * Blocks of a class live in one contiguous arena. Free blocks form a lock-free stack; its head packs a modification
+ * tag in the upper half and the 1-based block index in the lower half, which protects the stack against ABA.
+ */
+typedef struct event_handler_payload_class_state {
+    size_t block_size;
+    size_t block_count;
+    size_t stride;
+    unsigned char* blocks;
+    atomic_uint_least64_t free_head;
+    atomic_size_t in_use;
+    atomic_size_t peak;
+    atomic_size_t allocations;
+    atomic_size_t failures;
+} event_handler_payload_class_state_t;
+
+typedef struct event_handler_payload_pool {
+    size_t class_count;
+    event_handler_payload_class_state_t* classes;
+} event_handler_payload_pool_t;
+
+static event_handler_payload_t* get_block(event_handler_payload_class_state_t* state, uint32_t index) {
+    return (event_handler_payload_t*)(state->blocks + (size_t)(index - 1) * state->stride);
+}
+
+static void push_block(event_handler_payload_class_state_t* state, event_handler_payload_t* block) {
+    uint32_t index = (uint32_t)(((unsigned char*)block - state->blocks) / state->stride) + 1;
+    uint_least64_t head = atomic_load(&state->free_head);
+    uint_least64_t new_head;
+    do {
+        atomic_store_explicit(&block->next, (uint32_t)head, memory_order_relaxed);
+        new_head = (((head >> 32) + 1) << 32) | index;
+    } while (!atomic_compare_exchange_weak(&state->free_head, &head, new_head));
+}
+
+static event_handler_payload_t* pop_block(event_handler_payload_class_state_t* state) {
+    uint_least64_t head = atomic_load(&state->free_head);
+    uint_least64_t new_head;
+    event_handler_payload_t* block;
+    do {
+        uint32_t index = (uint32_t)head;
+        if (index == EVENT_HANDLER_PAYLOAD_NO_BLOCK) {
+            return NULL;
+        }
+        block = get_block(state, index);
+        new_head = (((head >> 32) + 1) << 32) | atomic_load_explicit(&block->next, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak(&state->free_head, &head, new_head));
+    return block;
+}
+
+static void update_peak(event_handler_payload_class_state_t* state, size_t in_use) {
+    size_t peak = atomic_load_explicit(&state->peak, memory_order_relaxed);
+    while (in_use > peak &&
+           !atomic_compare_exchange_weak_explicit(&state->peak, &peak, in_use, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+event_handler_payload_pool_t* event_handler_payload_pool_create(const event_handler_payload_class_t* classes,
+                                                                size_t class_count) {
+    if (!classes || class_count == 0) {
+        return NULL;
+    }
+    event_handler_payload_pool_t* pool = calloc(1, sizeof(event_handler_payload_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    pool->classes = calloc(class_count, sizeof(event_handler_payload_class_state_t));
+    if (!pool->classes) {
+        free(pool);
+        return NULL;
+    }
+    pool->class_count = class_count;
+    for (size_t i = 0; i < class_count; i++) {
+        event_handler_payload_class_state_t* state = &pool->classes[i];
+        state->block_size = classes[i].block_size;
+        state->block_count = classes[i].block_count;
+        state->stride = sizeof(event_handler_payload_t) + state->block_size;
+        state->stride = (state->stride + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+        atomic_init(&state->free_head, EVENT_HANDLER_PAYLOAD_NO_BLOCK);
+        atomic_init(&state->in_use, 0);
+        atomic_init(&state->peak, 0);
+        atomic_init(&state->allocations, 0);
+        atomic_init(&state->failures, 0);
+        if (state->block_count == 0 || state->block_count >= UINT32_MAX) {
+            event_handler_payload_pool_destroy(pool);
+            return NULL;
+        }
+        state->blocks = calloc(state->block_count, state->stride);
+        if (!state->blocks) {
+            event_handler_payload_pool_destroy(pool);
+            return NULL;
+        }
+        for (size_t block = state->block_count; block > 0; block--) {
+            event_handler_payload_t* payload = get_block(state, (uint32_t)block);
+            payload->owner = state;
+            push_block(state, payload);
+        }
+    }
+    return pool;
+}
+
+void event_handler_payload_pool_destroy(event_handler_payload_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+    for (size_t i = 0; i < pool->class_count; i++) {
+        free(pool->classes[i].blocks);
+    }
+    free(pool->classes);
+    free(pool);
+}
+
+bool event_handler_payload_pool_get_stats(event_handler_payload_pool_t* pool,
+                                          size_t class_index,
+                                          event_handler_payload_stats_t* stats) {
+    if (!pool || !stats || class_index >= pool->class_count) {
+        return false;
+    }
+    event_handler_payload_class_state_t* state = &pool->classes[class_index];
+    stats->block_size = state->block_size;
+    stats->block_count = state->block_count;
+    stats->in_use = atomic_load(&state->in_use);
+    stats->peak = atomic_load(&state->peak);
+    stats->allocations = atomic_load(&state->allocations);
+    stats->failures = atomic_load(&state->failures);
+    return true;
+}
+
+event_handler_payload_t* event_handler_payload_alloc(event_handler_payload_pool_t* pool, size_t size) {
+    if (!pool) {
+        return NULL;
+    }
+    event_handler_payload_class_state_t* fitting = NULL;
+    for (size_t i = 0; i < pool->class_count; i++) {
+        event_handler_payload_class_state_t* state = &pool->classes[i];
+        if (state->block_size < size) {
+            continue;
+        }
+        if (!fitting) {
+            fitting = state;
+        }
+        event_handler_payload_t* payload = pop_block(state);
+        if (payload) {
+            atomic_store_explicit(&payload->references, 1, memory_order_relaxed);
+            payload->size = size;
+            update_peak(state, atomic_fetch_add_explicit(&state->in_use, 1, memory_order_relaxed) + 1);
+            atomic_fetch_add_explicit(&state->allocations, 1, memory_order_relaxed);
+            return payload;
+        }
+    }
+    if (fitting) {
+        atomic_fetch_add_explicit(&fitting->failures, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+void event_handler_payload_retain(event_handler_payload_t* payload) {
+    if (!payload) {
+        return;
+    }
+    atomic_fetch_add_explicit(&payload->references, 1, memory_order_relaxed);
+}
+
+void event_handler_payload_release(event_handler_payload_t* payload) {
+    if (!payload) {
+        return;
+    }
+    if (atomic_fetch_sub_explicit(&payload->references, 1, memory_order_acq_rel) == 1) {
+        event_handler_payload_class_state_t* state = payload->owner;
+        atomic_fetch_sub_explicit(&state->in_use, 1, memory_order_relaxed);
+        push_block(state, payload);
+    }
+}
+
+void* event_handler_payload_data(event_handler_payload_t* payload) {
+    if (!payload) {
+        return NULL;
+    }
+    return payload->data;
+}
+
+size_t event_handler_payload_size(event_handler_payload_t* payload) {
+    if (!payload) {
+        return 0;
+    }
+    return payload->size;
+}
+
+event_handler_payload_t* event_handler_payload_from_data(void* data) {
+    if (!data) {
+        return NULL;
+    }
+    return (event_handler_payload_t*)((unsigned char*)data - offsetof(event_handler_payload_t, data));
+}
+
+bool event_handler_send_payload(event_handler_t* handler, uint16_t id, event_handler_payload_t* payload) {
+    if (!payload) {
+        return false;
+    }
+    return event_handler_send(handler, id, payload->data, payload->size);
+}
@@ -0,0 +1,174 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#ifndef EVENT_HANDLER_PAYLOAD_H
+#define EVENT_HANDLER_PAYLOAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "event-handler.h"
+
+/**
+ * @defgroup event_handler_payload Event Handler payload pool
+ * @ingroup event_handler
+ * @brief Refcounted zero-copy payloads for event fan-out
+ *
+ * The pool is made of block classes of fixed size, allocated once at creation. A payload handle starts with
+ * a single reference. Each party which keeps the payload past the call it received it in takes a reference
+ * with event_handler_payload_retain() and drops it with event_handler_payload_release(). The block returns
+ * to the pool when the last reference is released. Allocation and release are lock-free.
+ * @{
+ */
+
+/**
+ * @brief Payload pool type
+ *
+ * This is a declaration of the payload pool structure type. Use only by pointer.
+ */
+typedef struct event_handler_payload_pool event_handler_payload_pool_t;
+
+/**
+ * @brief Payload handle type
+ *
+ * This is a declaration of the payload handle structure type. Use only by pointer.
+ */
+typedef struct event_handler_payload event_handler_payload_t;
+
+typedef struct event_handler_payload_class {
+    size_t block_size;  /**< Payload capacity of a block in this class */
+    size_t block_count; /**< Number of blocks in this class */
+} event_handler_payload_class_t; /**< Payload pool block class definition */
+
+typedef struct event_handler_payload_stats {
+    size_t block_size;  /**< Payload capacity of a block in this class */
+    size_t block_count; /**< Number of blocks in this class */
+    size_t in_use;      /**< Blocks currently allocated */
+    size_t peak;        /**< Maximum number of blocks allocated at once */
+    size_t allocations; /**< Successful allocations */
+    size_t failures;    /**< Allocations for which this was the smallest fitting class and no block was free */
+} event_handler_payload_stats_t; /**< Payload pool class statistics structure definition */
+
+/**
+ * @brief Create a payload pool
+ * @param[in] classes array of block classes, sorted by ascending block size
+ * @param[in] class_count number of block classes
+ * @return pointer to the newly created pool
+ * @return NULL if the pool could not be created
+ */
+event_handler_payload_pool_t* event_handler_payload_pool_create(const event_handler_payload_class_t* classes,
+                                                                size_t class_count);
+
+/**
+ * @brief Destroy the payload pool
+ * @note All payloads must be released before the pool is destroyed.
+ * @param[in] pool pointer to the pool
+ */
+void event_handler_payload_pool_destroy(event_handler_payload_pool_t* pool);
+
+/**
+ * @brief Get statistics of a single block class
+ * @param[in] pool pointer to the pool
+ * @param[in] class_index index of the class as passed at creation
+ * @param[out] stats pointer to statistics to fill
+ * @return true if statistics were retrieved
+ * @return false if arguments were invalid
+ */
+bool event_handler_payload_pool_get_stats(event_handler_payload_pool_t* pool,
+                                          size_t class_index,
+                                          event_handler_payload_stats_t* stats);
+
+/**
+ * @brief Allocate a payload from the smallest class that fits
+ * @param[in] pool pointer to the pool
+ * @param[in] size payload size
+ * @return pointer to the payload handle holding one reference
+ * @return NULL if no block is available
+ */
+event_handler_payload_t* event_handler_payload_alloc(event_handler_payload_pool_t* pool, size_t size);
+
+/**
+ * @brief Take another reference to the payload
+ * @param[in] payload pointer to the payload handle
+ */
+void event_handler_payload_retain(event_handler_payload_t* payload);
+
+/**
+ * @brief Drop a reference to the payload, returning it to the pool when it was the last one
+ * @param[in] payload pointer to the payload handle
+ */
+void event_handler_payload_release(event_handler_payload_t* payload);
+
+/**
+ * @brief Get the payload data
+ * @param[in] payload pointer to the payload handle
+ * @return pointer to the payload data
+ */
+void* event_handler_payload_data(event_handler_payload_t* payload);
+
+/**
+ * @brief Get the payload size requested at allocation
+ * @param[in] payload pointer to the payload handle
+ * @return payload size
+ */
+size_t event_handler_payload_size(event_handler_payload_t* payload);
+
+/**
+ * @brief Get the payload handle from the data pointer passed to an event handler callback
+ * @note Only valid for events sent with event_handler_send_payload() or posted with a payload handle.
+ * @param[in] data pointer to the payload data
+ * @return pointer to the payload handle
+ */
+event_handler_payload_t* event_handler_payload_from_data(void* data);
+
+/**
+ * @brief Send a pooled payload to the handlers
+ *
+ * Every handler receives the same buffer. The caller keeps its reference.
+ * @param[in] handler pointer to the event handler
+ * @param[in] id event ID to be sent
+ * @param[in] payload pointer to the payload handle
+ * @return true if handler was executed for give event
+ * @return false otherwise
+ */
+bool event_handler_send_payload(event_handler_t* handler, uint16_t id, event_handler_payload_t* payload);
+
+/**
+ * @brief Post a pooled payload to the handler queue
+ *
+ * The queue takes its own reference and releases it once the event was dispatched or dropped,
+ * so no payload bytes are copied.
+ * @param[in] handler pointer to the event handler created with event_handler_create_with_queue()
+ * @param[in] id event ID to be posted
+ * @param[in] payload pointer to the payload handle
+ * @return true if the event was queued
+ * @return false if handler has no queue or the event was dropped
+ */
+bool event_handler_post_payload(event_handler_t* handler, uint16_t id, event_handler_payload_t* payload);
+
+/**
+ * @}
+ */
+
+#endif  // EVENT_HANDLER_PAYLOAD_H
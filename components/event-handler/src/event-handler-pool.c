@@ -0,0 +1,347 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#include "event-handler-pool.h"
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event-handler-payload.h"
+
+#define EVENT_HANDLER_POOL_BATCH_SIZE (32)
+
+typedef struct event_handler_pool_slot {
+    uint16_t id;
+    size_t size;
+    event_handler_payload_t* shared;
+    alignas(max_align_t) unsigned char payload[];
+} event_handler_pool_slot_t;
+
+typedef struct event_handler_pool_shard {
+    pthread_mutex_t lock;
+    atomic_bool claimed;
+    atomic_size_t pending;
+    size_t head;
+    unsigned char* slots;
+} event_handler_pool_shard_t;
+
+typedef struct event_handler_pool_worker {
+    event_handler_pool_t* pool;
+    size_t index;
+    pthread_t thread;
+    event_handler_pool_slot_t* scratch;
+} event_handler_pool_worker_t;
+
+typedef struct event_handler_pool {
+    event_handler_t* handler;
+    size_t worker_count;
+    size_t shard_count;
+    size_t shard_depth;
+    size_t max_payload_size;
+    size_t slot_size;
+    event_handler_pool_shard_t* shards;
+    event_handler_pool_worker_t* workers;
+    pthread_mutex_t lock;
+    pthread_cond_t work_available;
+    pthread_cond_t idle;
+    atomic_size_t outstanding;
+    atomic_size_t sleepers;
+    atomic_bool stop;
+} event_handler_pool_t;
+
+static size_t shard_index(const event_handler_pool_t* pool, uint16_t id) {
+    return (((uint32_t)id * 40503u) >> 4) & (pool->shard_count - 1);
+}
+
+static event_handler_pool_slot_t* get_slot(const event_handler_pool_t* pool,
+                                           event_handler_pool_shard_t* shard,
+                                           size_t index) {
+    return (event_handler_pool_slot_t*)(shard->slots + (index % pool->shard_depth) * pool->slot_size);
+}
+
+static bool take_event(event_handler_pool_t* pool, event_handler_pool_shard_t* shard, event_handler_pool_slot_t* out) {
+    pthread_mutex_lock(&shard->lock);
+    if (atomic_load(&shard->pending) == 0) {
+        pthread_mutex_unlock(&shard->lock);
+        return false;
+    }
+    event_handler_pool_slot_t* slot = get_slot(pool, shard, shard->head);
+    out->id = slot->id;
+    out->size = slot->size;
+    out->shared = slot->shared;
+    if (!slot->shared) {
+        memcpy(out->payload, slot->payload, slot->size);
+    }
+    shard->head = (shard->head + 1) % pool->shard_depth;
+    atomic_fetch_sub(&shard->pending, 1);
+    pthread_mutex_unlock(&shard->lock);
+    return true;
+}
+
+static void event_dispatched(event_handler_pool_t* pool) {
+    if (atomic_fetch_sub(&pool->outstanding, 1) == 1) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->idle);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/**
+ * Claim the shard and dispatch a batch of its events. Claiming guarantees a single worker per shard,
+ * which keeps events of one ID in order.
+ */
+static bool process_shard(event_handler_pool_worker_t* worker, event_handler_pool_shard_t* shard) {
+    if (atomic_load_explicit(&shard->pending, memory_order_relaxed) == 0 || atomic_exchange(&shard->claimed, true)) {
+        return false;
+    }
+    bool processed = false;
+    event_handler_pool_slot_t* event = worker->scratch;
+    for (size_t i = 0; i < EVENT_HANDLER_POOL_BATCH_SIZE && take_event(worker->pool, shard, event); i++) {
+        if (event->shared) {
+            event_handler_send(worker->pool->handler, event->id, event_handler_payload_data(event->shared),
+                               event->size);
+            event_handler_payload_release(event->shared);
+        } else {
+            event_handler_send(worker->pool->handler, event->id, event->size ? event->payload : NULL, event->size);
+        }
+        event_dispatched(worker->pool);
+        processed = true;
+    }
+    atomic_store(&shard->claimed, false);
+    return processed;
+}
+
+static bool process_shards(event_handler_pool_worker_t* worker) {
+    event_handler_pool_t* pool = worker->pool;
+    bool processed = false;
+    for (size_t i = worker->index; i < pool->shard_count; i += pool->worker_count) {
+        processed |= process_shard(worker, &pool->shards[i]);
+    }
+    if (processed) {
+        return true;
+    }
+    for (size_t i = 1; i < pool->shard_count; i++) {
+        size_t index = (worker->index + i) % pool->shard_count;
+        if ((index % pool->worker_count) != worker->index && process_shard(worker, &pool->shards[index])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool has_pending_events(event_handler_pool_t* pool) {
+    for (size_t i = 0; i < pool->shard_count; i++) {
+        if (atomic_load(&pool->shards[i].pending) > 0 && !atomic_load(&pool->shards[i].claimed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* worker_thread(void* arg) {
+    event_handler_pool_worker_t* worker = arg;
+    event_handler_pool_t* pool = worker->pool;
+    while (!atomic_load(&pool->stop)) {
+        if (process_shards(worker)) {
+            continue;
+        }
+        atomic_fetch_add(&pool->sleepers, 1);
+        pthread_mutex_lock(&pool->lock);
+        if (!atomic_load(&pool->stop) && !has_pending_events(pool)) {
+            pthread_cond_wait(&pool->work_available, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+        atomic_fetch_sub(&pool->sleepers, 1);
+    }
+    return NULL;
+}
+
+static void wake_workers(event_handler_pool_t* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void stop_workers(event_handler_pool_t* pool, size_t started) {
+    atomic_store(&pool->stop, true);
+    wake_workers(pool);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+}
+
+static void free_pool(event_handler_pool_t* pool) {
+    if (pool->shards) {
+        for (size_t i = 0; i < pool->shard_count; i++) {
+            pthread_mutex_destroy(&pool->shards[i].lock);
+            free(pool->shards[i].slots);
+        }
+    }
+    if (pool->workers) {
+        for (size_t i = 0; i < pool->worker_count; i++) {
+            free(pool->workers[i].scratch);
+        }
+    }
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool->shards);
+    free(pool);
+}
+
+static bool allocate_pool(event_handler_pool_t* pool) {
+    pool->shards = calloc(pool->shard_count, sizeof(event_handler_pool_shard_t));
+    pool->workers = calloc(pool->worker_count, sizeof(event_handler_pool_worker_t));
+    if (!pool->shards || !pool->workers) {
+        return false;
+    }
+    for (size_t i = 0; i < pool->shard_count; i++) {
+        pthread_mutex_init(&pool->shards[i].lock, NULL);
+        atomic_init(&pool->shards[i].claimed, false);
+        atomic_init(&pool->shards[i].pending, 0);
+        pool->shards[i].slots = calloc(pool->shard_depth, pool->slot_size);
+        if (!pool->shards[i].slots) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        pool->workers[i].scratch = calloc(1, pool->slot_size);
+        if (!pool->workers[i].scratch) {
+            return false;
+        }
+    }
+    return true;
+}
+
+event_handler_pool_t* event_handler_pool_create(event_handler_t* handler, const event_handler_pool_config_t* config) {
+    if (!handler || !config) {
+        return NULL;
+    }
+    event_handler_pool_t* pool = calloc(1, sizeof(event_handler_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    pool->handler = handler;
+    pool->worker_count = (config->worker_count ? config->worker_count : EVENT_HANDLER_POOL_DEFAULT_WORKER_COUNT);
+    size_t shard_count =
+        (config->shard_count ? config->shard_count : pool->worker_count * EVENT_HANDLER_POOL_SHARDS_PER_WORKER);
+    pool->shard_count = 1;
+    while (pool->shard_count < shard_count) {
+        pool->shard_count <<= 1;
+    }
+    pool->shard_depth = (config->shard_depth ? config->shard_depth : EVENT_HANDLER_POOL_DEFAULT_SHARD_DEPTH);
+    pool->max_payload_size =
+        (config->max_payload_size ? config->max_payload_size : EVENT_HANDLER_POOL_DEFAULT_PAYLOAD_SIZE);
+    pool->slot_size = sizeof(event_handler_pool_slot_t) + pool->max_payload_size;
+    pool->slot_size = (pool->slot_size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    atomic_init(&pool->outstanding, 0);
+    atomic_init(&pool->sleepers, 0);
+    atomic_init(&pool->stop, false);
+    if (!allocate_pool(pool)) {
+        free_pool(pool);
+        return NULL;
+    }
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        if (pthread_create(&pool->workers[i].thread, NULL, worker_thread, &pool->workers[i]) != 0) {
+            stop_workers(pool, i);
+            free_pool(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void event_handler_pool_destroy(event_handler_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+    event_handler_pool_flush(pool);
+    stop_workers(pool, pool->worker_count);
+    free_pool(pool);
+}
+
+static bool enqueue(event_handler_pool_t* pool,
+                    uint16_t id,
+                    const void* payload,
+                    size_t size,
+                    event_handler_payload_t* shared) {
+    event_handler_pool_shard_t* shard = &pool->shards[shard_index(pool, id)];
+    pthread_mutex_lock(&shard->lock);
+    size_t pending = atomic_load(&shard->pending);
+    if (pending == pool->shard_depth) {
+        pthread_mutex_unlock(&shard->lock);
+        return false;
+    }
+    event_handler_pool_slot_t* slot = get_slot(pool, shard, shard->head + pending);
+    slot->id = id;
+    slot->size = size;
+    slot->shared = shared;
+    if (!shared && size > 0) {
+        memcpy(slot->payload, payload, size);
+    }
+    atomic_fetch_add(&pool->outstanding, 1);
+    atomic_fetch_add(&shard->pending, 1);
+    pthread_mutex_unlock(&shard->lock);
+    if (atomic_load(&pool->sleepers) > 0) {
+        wake_workers(pool);
+    }
+    return true;
+}
+
+bool event_handler_pool_post(event_handler_pool_t* pool, uint16_t id, const void* payload, size_t size) {
+    if (!pool || size > pool->max_payload_size || (size > 0 && !payload)) {
+        return false;
+    }
+    return enqueue(pool, id, payload, size, NULL);
+}
+
+bool event_handler_pool_post_payload(event_handler_pool_t* pool, uint16_t id, event_handler_payload_t* payload) {
+    if (!pool || !payload) {
+        return false;
+    }
+    event_handler_payload_retain(payload);
+    if (!enqueue(pool, id, NULL, event_handler_payload_size(payload), payload)) {
+        event_handler_payload_release(payload);
+        return false;
+    }
+    return true;
+}
+
+void event_handler_pool_flush(event_handler_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->outstanding) > 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
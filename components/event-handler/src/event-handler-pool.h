@@ -0,0 +1,118 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#ifndef EVENT_HANDLER_POOL_H
+#define EVENT_HANDLER_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "event-handler-payload.h"
+#include "event-handler.h"
+
+/**
+ * @defgroup event_handler_pool Event Handler worker pool
+ * @ingroup event_handler
+ * @brief Multi-core event dispatch with per-ID ordering
+ *
+ * Posted events are sharded by a hash of their ID. A shard is dispatched by at most one worker thread at a time,
+ * so events of a single ID are handled in posting order, while different shards run in parallel.
+ * Workers prefer their own shards and steal whole shards from others when idle.
+ * @{
+ */
+#define EVENT_HANDLER_POOL_DEFAULT_WORKER_COUNT 4   /**< Default number of worker threads */
+#define EVENT_HANDLER_POOL_DEFAULT_SHARD_DEPTH 256  /**< Default number of slots per shard */
+#define EVENT_HANDLER_POOL_DEFAULT_PAYLOAD_SIZE 32  /**< Default inline payload capacity of a slot */
+#define EVENT_HANDLER_POOL_SHARDS_PER_WORKER 4      /**< Shards created per worker when not configured */
+
+/**
+ * @brief Worker pool type
+ *
+ * This is a declaration of the worker pool structure type. Use only by pointer.
+ */
+typedef struct event_handler_pool event_handler_pool_t;
+
+typedef struct event_handler_pool_config {
+    size_t worker_count;     /**< Number of worker threads */
+    size_t shard_count;      /**< Number of ID shards, rounded up to a power of two */
+    size_t shard_depth;      /**< Number of slots in each shard queue */
+    size_t max_payload_size; /**< Maximum payload size copied inline into a slot */
+} event_handler_pool_config_t; /**< Worker pool configuration structure definition */
+
+/**
+ * @brief Create a worker pool dispatching to the event handler
+ *
+ * @note Handlers must be registered before events are posted. The registered callbacks are called from the
+ * worker threads, concurrently for events of different shards.
+ * @param[in] handler pointer to the event handler with registered callbacks
+ * @param[in] config pointer to pool configuration, zeroed fields fall back to defaults
+ * @return pointer to the newly created worker pool
+ * @return NULL if the pool could not be created
+ */
+event_handler_pool_t* event_handler_pool_create(event_handler_t* handler, const event_handler_pool_config_t* config);
+
+/**
+ * @brief Destroy the worker pool
+ *
+ * Pending events are dispatched before the workers are stopped.
+ * @param[in] pool pointer to the worker pool
+ */
+void event_handler_pool_destroy(event_handler_pool_t* pool);
+
+/**
+ * @brief Post event to the worker pool
+ *
+ * This function is thread safe.
+ * @param[in] pool pointer to the worker pool
+ * @param[in] id event ID to be posted
+ * @param[in] payload pointer to possible payload, copied into the shard queue
+ * @param[in] size size of the payload
+ * @return true if the event was queued
+ * @return false if the shard queue is full or the payload is too big
+ */
+bool event_handler_pool_post(event_handler_pool_t* pool, uint16_t id, const void* payload, size_t size);
+
+/**
+ * @brief Post a pooled payload to the worker pool
+ *
+ * The pool takes its own reference and releases it once the event was dispatched, so no payload bytes are copied.
+ * @param[in] pool pointer to the worker pool
+ * @param[in] id event ID to be posted
+ * @param[in] payload pointer to the payload handle
+ * @return true if the event was queued
+ * @return false if the shard queue is full
+ */
+bool event_handler_pool_post_payload(event_handler_pool_t* pool, uint16_t id, event_handler_payload_t* payload);
+
+/**
+ * @brief Wait until every posted event was dispatched
+ * @param[in] pool pointer to the worker pool
+ */
+void event_handler_pool_flush(event_handler_pool_t* pool);
+
+/**
+ * @}
+ */
+
+#endif  // EVENT_HANDLER_POOL_H
@@ -0,0 +1,102 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#ifndef EVENT_HANDLER_PRIVATE_H
+#define EVENT_HANDLER_PRIVATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "event-handler-instrumentation.h"
+#include "event-handler-static.h"
+#include "event-handler-trace.h"
+#include "event-handler.h"
+
+#if EVENT_HANDLER_INSTRUMENTATION
+#include <stdatomic.h>
+#endif
+
+typedef struct event_handler_queue event_handler_queue_t;
+typedef struct event_handler_delivery_state event_handler_delivery_state_t;
+
+#if EVENT_HANDLER_INSTRUMENTATION
+/**
+ * Counters are updated with relaxed atomics, handlers of different IDs may be dispatched from many threads.
+ */
+typedef struct event_handler_latency {
+    atomic_uint_least64_t count;
+    atomic_uint_least64_t total;
+    atomic_uint_least64_t max;
+    atomic_uint_least64_t histogram[EVENT_HANDLER_LATENCY_BUCKETS];
+} event_handler_latency_t;
+
+void event_handler_latency_record(event_handler_latency_t* latency, uint64_t duration);
+#endif
+
+typedef struct event_handler_entry {
+    void* context;
+    event_handler_callback_t callback;
+#if EVENT_HANDLER_INSTRUMENTATION
+    event_handler_latency_t latency;
+#endif
+} event_handler_entry_t;
+
+/**
+ * All handlers registered for a single event ID, kept in a contiguous array in registration order.
+ */
+typedef struct event_handler_bucket {
+    uint16_t id;
+    size_t count;
+    size_t capacity;
+    event_handler_entry_t* entries;
+    event_handler_delivery_state_t* delivery;
+#if EVENT_HANDLER_INSTRUMENTATION
+    event_handler_latency_t latency;
+#endif
+} event_handler_bucket_t;
+
+/**
+ * Open-addressing (linear probing) table of buckets keyed by the event ID.
+ * The table stores bucket pointers, so buckets stay in place when the table grows.
+ */
+typedef struct event_handler {
+    event_handler_bucket_t** table;
+    size_t table_size;
+    size_t bucket_count;
+    event_handler_queue_t* queue;
+    const event_handler_static_table_t* static_table;
+    event_handler_clock_t clock;
+    event_handler_trace_t* trace;
+} event_handler_t;
+
+event_handler_bucket_t* event_handler_find_bucket(const event_handler_t* handler, uint16_t id);
+
+event_handler_bucket_t* event_handler_get_or_create_bucket(event_handler_t* handler, uint16_t id);
+
+event_handler_queue_t* event_handler_queue_create(const event_handler_queue_config_t* config);
+
+void event_handler_queue_destroy(event_handler_queue_t* queue);
+
+void event_handler_delivery_destroy(event_handler_delivery_state_t* delivery);
+
+#endif  // EVENT_HANDLER_PRIVATE_H
@@ -0,0 +1,417 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event-handler-payload.h"
+#include "event-handler-private.h"
+#include "event-handler.h"
+#include "intrusive-list.h"
+
+typedef struct event_handler_queue_slot {
+    uint16_t id;
+    size_t size;
+    event_handler_payload_t* shared;
+    alignas(max_align_t) unsigned char payload[];
+} event_handler_queue_slot_t;
+
+typedef struct event_handler_delivery_state {
+    event_handler_delivery_policy_t policy;
+    intrusive_list_node_t node; /* Debounce: linked on the queue list while an event waits in `held` */
+    uint16_t id;
+    bool pending; /* Coalesce: an event of this ID was queued at `position` */
+    size_t position;
+    uint64_t deadline;
+    uint64_t tokens; /* Rate limit: scaled by window, a single event costs `window` */
+    uint64_t refilled_at;
+    size_t held_size;
+    event_handler_payload_t* held_shared;
+    unsigned char held[];
+} event_handler_delivery_state_t;
+
+typedef struct event_handler_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_full;
+    event_handler_overflow_policy_t overflow_policy;
+    size_t depth;
+    size_t max_payload_size;
+    size_t slot_size;
+    size_t head;
+    size_t pending;
+    unsigned char* slots;
+    event_handler_queue_slot_t* scratch;
+    intrusive_list_t held;
+    event_handler_queue_stats_t stats;
+} event_handler_queue_t;
+
+static event_handler_queue_slot_t* get_slot(event_handler_queue_t* queue, size_t index) {
+    return (event_handler_queue_slot_t*)(queue->slots + (index % queue->depth) * queue->slot_size);
+}
+
+event_handler_queue_t* event_handler_queue_create(const event_handler_queue_config_t* config) {
+    event_handler_queue_t* queue = calloc(1, sizeof(event_handler_queue_t));
+    if (!queue) {
+        return NULL;
+    }
+    queue->depth = (config->depth ? config->depth : EVENT_HANDLER_DEFAULT_QUEUE_DEPTH);
+    queue->max_payload_size =
+        (config->max_payload_size ? config->max_payload_size : EVENT_HANDLER_DEFAULT_QUEUE_PAYLOAD_SIZE);
+    queue->overflow_policy = config->overflow_policy;
+    queue->slot_size = sizeof(event_handler_queue_slot_t) + queue->max_payload_size;
+    queue->slot_size = (queue->slot_size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    queue->slots = calloc(queue->depth + 1, queue->slot_size);
+    if (!queue->slots) {
+        free(queue);
+        return NULL;
+    }
+    /* The extra slot at the end is used by the consumer, so producers never overwrite a payload in dispatch. */
+    queue->scratch = (event_handler_queue_slot_t*)(queue->slots + queue->depth * queue->slot_size);
+    queue->stats.depth = queue->depth;
+    intrusive_list_init(&queue->held);
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    return queue;
+}
+
+void event_handler_queue_destroy(event_handler_queue_t* queue) {
+    if (!queue) {
+        return;
+    }
+    for (size_t i = 0; i < queue->pending; i++) {
+        event_handler_payload_release(get_slot(queue, queue->head + i)->shared);
+    }
+    pthread_cond_destroy(&queue->not_full);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->slots);
+    free(queue);
+}
+
+static bool make_room(event_handler_queue_t* queue) {
+    while (queue->pending == queue->depth) {
+        switch (queue->overflow_policy) {
+            case EVENT_HANDLER_OVERFLOW_DROP_OLDEST:
+                event_handler_payload_release(get_slot(queue, queue->head)->shared);
+                queue->head++;
+                queue->pending--;
+                queue->stats.dropped++;
+                break;
+            case EVENT_HANDLER_OVERFLOW_BLOCK:
+                pthread_cond_wait(&queue->not_full, &queue->lock);
+                break;
+            case EVENT_HANDLER_OVERFLOW_DROP_NEWEST:
+            default:
+                queue->stats.dropped++;
+                return false;
+        }
+    }
+    return true;
+}
+
+static size_t push(event_handler_queue_t* queue,
+                   uint16_t id,
+                   const void* payload,
+                   size_t size,
+                   event_handler_payload_t* shared) {
+    size_t position = queue->head + queue->pending;
+    event_handler_queue_slot_t* slot = get_slot(queue, position);
+    slot->id = id;
+    slot->size = size;
+    slot->shared = shared;
+    if (!shared && size > 0) {
+        memcpy(slot->payload, payload, size);
+    }
+    queue->pending++;
+    queue->stats.posted++;
+    if (queue->pending > queue->stats.high_water_mark) {
+        queue->stats.high_water_mark = queue->pending;
+    }
+    return position;
+}
+
+static void replace(event_handler_queue_t* queue,
+                    size_t position,
+                    const void* payload,
+                    size_t size,
+                    event_handler_payload_t* shared) {
+    event_handler_queue_slot_t* slot = get_slot(queue, position);
+    event_handler_payload_release(slot->shared);
+    slot->size = size;
+    slot->shared = shared;
+    if (!shared && size > 0) {
+        memcpy(slot->payload, payload, size);
+    }
+}
+
+static void hold(event_handler_queue_t* queue,
+                 event_handler_delivery_state_t* delivery,
+                 uint64_t now,
+                 const void* payload,
+                 size_t size,
+                 event_handler_payload_t* shared) {
+    event_handler_payload_release(delivery->held_shared);
+    delivery->held_size = size;
+    delivery->held_shared = shared;
+    if (!shared && size > 0) {
+        memcpy(delivery->held, payload, size);
+    }
+    delivery->deadline = now + delivery->policy.window;
+    if (intrusive_list_is_linked(&delivery->node)) {
+        queue->stats.debounced++;
+        return;
+    }
+    intrusive_list_push_back(&queue->held, &delivery->node);
+}
+
+static bool take_token(event_handler_delivery_state_t* delivery, uint64_t now) {
+    uint64_t capacity = (uint64_t)delivery->policy.burst * delivery->policy.window;
+    uint64_t elapsed = now - delivery->refilled_at;
+    delivery->refilled_at = now;
+    if (elapsed >= delivery->policy.window * (uint64_t)delivery->policy.burst) {
+        delivery->tokens = capacity;
+    } else {
+        delivery->tokens += elapsed * delivery->policy.rate;
+        if (delivery->tokens > capacity) {
+            delivery->tokens = capacity;
+        }
+    }
+    if (delivery->tokens < delivery->policy.window) {
+        return false;
+    }
+    delivery->tokens -= delivery->policy.window;
+    return true;
+}
+
+static bool enqueue(event_handler_t* handler,
+                    uint16_t id,
+                    const void* payload,
+                    size_t size,
+                    event_handler_payload_t* shared) {
+    event_handler_queue_t* queue = handler->queue;
+    event_handler_bucket_t* bucket = event_handler_find_bucket(handler, id);
+    event_handler_delivery_state_t* delivery = (bucket ? bucket->delivery : NULL);
+    pthread_mutex_lock(&queue->lock);
+    if (delivery) {
+        switch (delivery->policy.mode) {
+            case EVENT_HANDLER_DELIVERY_COALESCE:
+                /* Positions only grow, so anything at or past the head is still waiting in the ring. */
+                if (delivery->pending && delivery->position >= queue->head) {
+                    replace(queue, delivery->position, payload, size, shared);
+                    queue->stats.coalesced++;
+                    pthread_mutex_unlock(&queue->lock);
+                    return true;
+                }
+                break;
+            case EVENT_HANDLER_DELIVERY_DEBOUNCE:
+                hold(queue, delivery, handler->clock(), payload, size, shared);
+                pthread_mutex_unlock(&queue->lock);
+                return true;
+            case EVENT_HANDLER_DELIVERY_RATE_LIMIT:
+                if (!take_token(delivery, handler->clock())) {
+                    queue->stats.rate_limited++;
+                    pthread_mutex_unlock(&queue->lock);
+                    return false;
+                }
+                break;
+            case EVENT_HANDLER_DELIVERY_ALL:
+            default:
+                break;
+        }
+    }
+    if (!make_room(queue)) {
+        pthread_mutex_unlock(&queue->lock);
+        return false;
+    }
+    size_t position = push(queue, id, payload, size, shared);
+    if (delivery) {
+        delivery->pending = true;
+        delivery->position = position;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+static void release_held(event_handler_t* handler) {
+    event_handler_queue_t* queue = handler->queue;
+    if (intrusive_list_is_empty(&queue->held)) {
+        return;
+    }
+    uint64_t now = handler->clock();
+    intrusive_list_node_t* node;
+    intrusive_list_node_t* next;
+    INTRUSIVE_LIST_FOR_EACH_SAFE(&queue->held, node, next) {
+        event_handler_delivery_state_t* delivery = intrusive_list_entry(node, event_handler_delivery_state_t, node);
+        /* The consumer must not block on its own queue, a full ring keeps the event held until the next run. */
+        if ((int64_t)(now - delivery->deadline) < 0 || queue->pending == queue->depth) {
+            continue;
+        }
+        intrusive_list_remove(node);
+        push(queue, delivery->id, delivery->held, delivery->held_size, delivery->held_shared);
+        delivery->held_shared = NULL;
+    }
+}
+
+bool event_handler_set_delivery_policy(event_handler_t* handler,
+                                       uint16_t id,
+                                       const event_handler_delivery_policy_t* policy) {
+    if (!handler || !handler->queue) {
+        return false;
+    }
+    if (policy && policy->mode != EVENT_HANDLER_DELIVERY_ALL && policy->mode != EVENT_HANDLER_DELIVERY_COALESCE &&
+        !handler->clock) {
+        return false;
+    }
+    if (policy && policy->mode == EVENT_HANDLER_DELIVERY_RATE_LIMIT &&
+        (policy->window == 0 || policy->rate == 0 || policy->burst == 0)) {
+        return false;
+    }
+    event_handler_bucket_t* bucket = event_handler_get_or_create_bucket(handler, id);
+    if (!bucket) {
+        return false;
+    }
+    event_handler_delivery_state_t* delivery = NULL;
+    if (policy && policy->mode != EVENT_HANDLER_DELIVERY_ALL) {
+        size_t held_size = (policy->mode == EVENT_HANDLER_DELIVERY_DEBOUNCE ? handler->queue->max_payload_size : 0);
+        delivery = calloc(1, sizeof(event_handler_delivery_state_t) + held_size);
+        if (!delivery) {
+            return false;
+        }
+        delivery->policy = *policy;
+        delivery->id = id;
+        if (policy->mode == EVENT_HANDLER_DELIVERY_RATE_LIMIT) {
+            delivery->tokens = (uint64_t)policy->burst * policy->window;
+            delivery->refilled_at = handler->clock();
+        }
+    }
+    event_handler_queue_t* queue = handler->queue;
+    pthread_mutex_lock(&queue->lock);
+    event_handler_delivery_state_t* previous = bucket->delivery;
+    if (previous && intrusive_list_is_linked(&previous->node)) {
+        intrusive_list_remove(&previous->node);
+    }
+    bucket->delivery = delivery;
+    pthread_mutex_unlock(&queue->lock);
+    event_handler_delivery_destroy(previous);
+    return true;
+}
+
+void event_handler_delivery_destroy(event_handler_delivery_state_t* delivery) {
+    if (!delivery) {
+        return;
+    }
+    event_handler_payload_release(delivery->held_shared);
+    free(delivery);
+}
+
+bool event_handler_post(event_handler_t* handler, uint16_t id, const void* payload, size_t size) {
+    if (!handler || !handler->queue || (size > 0 && !payload)) {
+        return false;
+    }
+    if (size > handler->queue->max_payload_size) {
+        return false;
+    }
+    return enqueue(handler, id, payload, size, NULL);
+}
+
+bool event_handler_post_payload(event_handler_t* handler, uint16_t id, event_handler_payload_t* payload) {
+    if (!handler || !handler->queue || !payload) {
+        return false;
+    }
+    event_handler_payload_retain(payload);
+    if (!enqueue(handler, id, NULL, event_handler_payload_size(payload), payload)) {
+        event_handler_payload_release(payload);
+        return false;
+    }
+    return true;
+}
+
+bool event_handler_run_once(event_handler_t* handler) {
+    if (!handler || !handler->queue) {
+        return false;
+    }
+    event_handler_queue_t* queue = handler->queue;
+    pthread_mutex_lock(&queue->lock);
+    release_held(handler);
+    if (queue->pending == 0) {
+        pthread_mutex_unlock(&queue->lock);
+        return false;
+    }
+    event_handler_queue_slot_t* slot = get_slot(queue, queue->head);
+    event_handler_queue_slot_t* event = queue->scratch;
+    event->id = slot->id;
+    event->size = slot->size;
+    event->shared = slot->shared;
+    if (!slot->shared) {
+        memcpy(event->payload, slot->payload, slot->size);
+    }
+    queue->head++;
+    queue->pending--;
+    queue->stats.dispatched++;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+
+    if (event->shared) {
+        event_handler_send(handler, event->id, event_handler_payload_data(event->shared), event->size);
+        event_handler_payload_release(event->shared);
+    } else {
+        event_handler_send(handler, event->id, event->size ? event->payload : NULL, event->size);
+    }
+    return true;
+}
+
+size_t event_handler_run(event_handler_t* handler) {
+    size_t count = 0;
+    while (event_handler_run_once(handler)) {
+        count++;
+    }
+    return count;
+}
+
+bool event_handler_get_queue_stats(event_handler_t* handler, event_handler_queue_stats_t* stats) {
+    if (!handler || !handler->queue || !stats) {
+        return false;
+    }
+    pthread_mutex_lock(&handler->queue->lock);
+    *stats = handler->queue->stats;
+    stats->pending = handler->queue->pending;
+    pthread_mutex_unlock(&handler->queue->lock);
+    return true;
+}
+
+void event_handler_reset_queue_stats(event_handler_t* handler) {
+    if (!handler || !handler->queue) {
+        return;
+    }
+    event_handler_queue_t* queue = handler->queue;
+    pthread_mutex_lock(&queue->lock);
+    queue->stats.high_water_mark = queue->pending;
+    queue->stats.posted = 0;
+    queue->stats.dropped = 0;
+    queue->stats.dispatched = 0;
+    queue->stats.coalesced = 0;
+    queue->stats.debounced = 0;
+    queue->stats.rate_limited = 0;
+    pthread_mutex_unlock(&queue->lock);
+}
@@ -0,0 +1,133 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#ifndef EVENT_HANDLER_STATIC_H
+#define EVENT_HANDLER_STATIC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "event-handler.h"
+
+/**
+ * @defgroup event_handler_static Event Handler static routing
+ * @ingroup event_handler
+ * @brief Compile-time routing tables placed in read-only memory
+ *
+ * Routes are declared with macros which expand to const arrays, so they need no heap and no startup registration.
+ * The table is indexed directly by the event ID.
+ *
+ * @code
+ * EVENT_HANDLER_STATIC_ROUTES(button_routes,
+ *                             EVENT_HANDLER_STATIC_ROUTE(on_button, &leds),
+ *                             EVENT_HANDLER_STATIC_ROUTE(log_event, NULL));
+ * EVENT_HANDLER_STATIC_ROUTES(timer_routes, EVENT_HANDLER_STATIC_ROUTE(on_timer, NULL));
+ *
+ * EVENT_HANDLER_STATIC_TABLE(routes, EVENT_TIMER,
+ *                            EVENT_HANDLER_STATIC_SLOT(EVENT_BUTTON, button_routes),
+ *                            EVENT_HANDLER_STATIC_SLOT(EVENT_TIMER, timer_routes));
+ * @endcode
+ * @note Contexts must be addresses of objects with static storage duration.
+ * @{
+ */
+
+typedef struct event_handler_static_route {
+    event_handler_callback_t callback; /**< Event handling callback */
+    void* context;                     /**< Context passed to the callback */
+} event_handler_static_route_t; /**< Single static route definition */
+
+typedef struct event_handler_static_slot {
+    const event_handler_static_route_t* routes; /**< Routes of the event ID, in dispatch order */
+    size_t count;                               /**< Number of routes */
+} event_handler_static_slot_t; /**< Routes of a single event ID */
+
+typedef struct event_handler_static_table {
+    const event_handler_static_slot_t* slots; /**< Slots indexed by the event ID */
+    size_t slot_count;                        /**< Number of slots, the highest routed ID + 1 */
+} event_handler_static_table_t; /**< Static routing table definition */
+
+/**
+ * @brief Define a single route entry
+ * @param callback event handling callback
+ * @param context pointer to some context for the callback
+ */
+#define EVENT_HANDLER_STATIC_ROUTE(callback, context) {(callback), (context)}
+
+/**
+ * @brief Define a const array of routes for one event ID
+ * @param name name of the array
+ * @param ... route entries defined with @ref EVENT_HANDLER_STATIC_ROUTE
+ */
+#define EVENT_HANDLER_STATIC_ROUTES(name, ...) static const event_handler_static_route_t name[] = {__VA_ARGS__}
+
+/**
+ * @brief Bind an array of routes to an event ID inside @ref EVENT_HANDLER_STATIC_TABLE
+ * @param id event ID
+ * @param routes array defined with @ref EVENT_HANDLER_STATIC_ROUTES
+ */
+#define EVENT_HANDLER_STATIC_SLOT(id, routes) [(id)] = {(routes), sizeof(routes) / sizeof((routes)[0])}
+
+/**
+ * @brief Define a const routing table
+ * @param name name of the table object
+ * @param max_id highest event ID routed by the table
+ * @param ... slots defined with @ref EVENT_HANDLER_STATIC_SLOT, each ID at most once
+ */
+#define EVENT_HANDLER_STATIC_TABLE(name, max_id, ...)                                     \
+    static const event_handler_static_slot_t name##_slots[(max_id) + 1] = {__VA_ARGS__}; \
+    const event_handler_static_table_t name = {name##_slots, (max_id) + 1}
+
+/**
+ * @brief Send event through a static routing table
+ * @param[in] table pointer to the routing table
+ * @param[in] handler pointer to the event handler passed to the callbacks, may be NULL
+ * @param[in] id event ID to be sent
+ * @param[in] payload pointer to possible payload associated with the event ID
+ * @param[in] size size of the payload
+ * @return true if a route was executed for given event
+ * @return false otherwise
+ */
+bool event_handler_static_send(const event_handler_static_table_t* table,
+                               event_handler_t* handler,
+                               uint16_t id,
+                               void* payload,
+                               size_t size);
+
+/**
+ * @brief Attach a static routing table to the event handler
+ *
+ * Once attached, event_handler_send() and every queued path dispatch the static routes of an ID first,
+ * followed by the handlers registered with event_handler_register().
+ * @param[in] handler pointer to the event handler
+ * @param[in] table pointer to the routing table, NULL to detach
+ * @return true if the table was attached
+ * @return false if handler was invalid
+ */
+bool event_handler_set_static_table(event_handler_t* handler, const event_handler_static_table_t* table);
+
+/**
+ * @}
+ */
+
+#endif  // EVENT_HANDLER_STATIC_H
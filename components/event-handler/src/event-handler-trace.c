@@ -0,0 +1,414 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#include "event-handler-trace.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "event-handler-private.h"
+
+#define EVENT_HANDLER_TRACE_CACHE_LINE_SIZE (64)
+#define EVENT_HANDLER_TRACE_FLUSH_PERIOD_NS (10 * 1000 * 1000)
+
+/**
+ * Single producer (the owning thread), single consumer (the writer thread) byte ring.
+ * Positions only grow, a record is published by moving the head past it.
+ */
+typedef struct event_handler_trace_ring {
+    alignas(EVENT_HANDLER_TRACE_CACHE_LINE_SIZE) atomic_size_t head;
+    atomic_uint_least64_t recorded;
+    atomic_uint_least64_t dropped;
+    alignas(EVENT_HANDLER_TRACE_CACHE_LINE_SIZE) atomic_size_t tail;
+    struct event_handler_trace_ring* next;
+    pthread_t owner;
+    size_t mask;
+    unsigned char* data;
+} event_handler_trace_ring_t;
+
+struct event_handler_trace {
+    uint64_t serial;
+    FILE* file;
+    size_t ring_size;
+    size_t max_payload_size;
+    _Atomic(event_handler_trace_ring_t*) rings;
+    atomic_uint_least64_t dropped;
+    atomic_uint_least64_t bytes;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool stopping;
+    pthread_t writer;
+};
+
+struct event_handler_trace_reader {
+    FILE* file;
+    unsigned char payload[UINT16_MAX];
+};
+
+/* Each recorder gets a unique serial, so a cached ring of a destroyed recorder is never reused. */
+static atomic_uint_least64_t next_serial = 1;
+
+static _Thread_local struct {
+    uint64_t serial;
+    event_handler_trace_ring_t* ring;
+} local_ring;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static size_t round_up_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+static event_handler_trace_ring_t* ring_create(event_handler_trace_t* trace) {
+    event_handler_trace_ring_t* ring =
+        aligned_alloc(alignof(event_handler_trace_ring_t), sizeof(event_handler_trace_ring_t));
+    if (!ring) {
+        return NULL;
+    }
+    memset(ring, 0, sizeof(event_handler_trace_ring_t));
+    ring->data = malloc(trace->ring_size);
+    if (!ring->data) {
+        free(ring);
+        return NULL;
+    }
+    ring->mask = trace->ring_size - 1;
+    ring->owner = pthread_self();
+    ring->next = atomic_load_explicit(&trace->rings, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(
+        &trace->rings, &ring->next, ring, memory_order_release, memory_order_relaxed)) {
+    }
+    return ring;
+}
+
+static event_handler_trace_ring_t* get_ring(event_handler_trace_t* trace) {
+    if (local_ring.serial == trace->serial) {
+        return local_ring.ring;
+    }
+    event_handler_trace_ring_t* ring = atomic_load_explicit(&trace->rings, memory_order_acquire);
+    while (ring && !pthread_equal(ring->owner, pthread_self())) {
+        ring = ring->next;
+    }
+    if (!ring) {
+        ring = ring_create(trace);
+        if (!ring) {
+            return NULL;
+        }
+    }
+    local_ring.serial = trace->serial;
+    local_ring.ring = ring;
+    return ring;
+}
+
+static void ring_write(event_handler_trace_ring_t* ring, size_t position, const void* source, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    size_t offset = position & ring->mask;
+    size_t first = ring->mask + 1 - offset;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(ring->data + offset, source, first);
+    memcpy(ring->data, (const unsigned char*)source + first, size - first);
+}
+
+static void drain(event_handler_trace_t* trace) {
+    for (event_handler_trace_ring_t* ring = atomic_load_explicit(&trace->rings, memory_order_acquire); ring;
+         ring = ring->next) {
+        size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        while (tail != head) {
+            size_t offset = tail & ring->mask;
+            size_t chunk = ring->mask + 1 - offset;
+            if (chunk > head - tail) {
+                chunk = head - tail;
+            }
+            fwrite(ring->data + offset, 1, chunk, trace->file);
+            tail += chunk;
+            atomic_fetch_add_explicit(&trace->bytes, chunk, memory_order_relaxed);
+        }
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+    fflush(trace->file);
+}
+
+static void* writer_main(void* arg) {
+    event_handler_trace_t* trace = arg;
+    pthread_mutex_lock(&trace->lock);
+    while (!trace->stopping) {
+        pthread_mutex_unlock(&trace->lock);
+        drain(trace);
+        pthread_mutex_lock(&trace->lock);
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += EVENT_HANDLER_TRACE_FLUSH_PERIOD_NS;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        if (!trace->stopping) {
+            pthread_cond_timedwait(&trace->wake, &trace->lock, &deadline);
+        }
+    }
+    pthread_mutex_unlock(&trace->lock);
+    drain(trace);
+    return NULL;
+}
+
+event_handler_trace_t* event_handler_trace_create(const char* path, const event_handler_trace_config_t* config) {
+    if (!path) {
+        return NULL;
+    }
+    event_handler_trace_t* trace = calloc(1, sizeof(event_handler_trace_t));
+    if (!trace) {
+        return NULL;
+    }
+    size_t ring_size = (config && config->ring_size ? config->ring_size : EVENT_HANDLER_TRACE_DEFAULT_RING_SIZE);
+    size_t max_payload_size =
+        (config && config->max_payload_size ? config->max_payload_size : EVENT_HANDLER_TRACE_DEFAULT_PAYLOAD_SIZE);
+    trace->max_payload_size = (max_payload_size < UINT16_MAX ? max_payload_size : UINT16_MAX);
+    /* A ring has to fit at least one record with the biggest payload. */
+    if (ring_size < sizeof(event_handler_trace_record_t) + trace->max_payload_size) {
+        ring_size = sizeof(event_handler_trace_record_t) + trace->max_payload_size;
+    }
+    trace->ring_size = round_up_power_of_two(ring_size);
+    trace->serial = atomic_fetch_add_explicit(&next_serial, 1, memory_order_relaxed);
+    trace->file = fopen(path, "wb");
+    if (!trace->file) {
+        free(trace);
+        return NULL;
+    }
+    fwrite(EVENT_HANDLER_TRACE_MAGIC, 1, sizeof(EVENT_HANDLER_TRACE_MAGIC) - 1, trace->file);
+    atomic_store_explicit(&trace->bytes, sizeof(EVENT_HANDLER_TRACE_MAGIC) - 1, memory_order_relaxed);
+    pthread_mutex_init(&trace->lock, NULL);
+    pthread_cond_init(&trace->wake, NULL);
+    if (pthread_create(&trace->writer, NULL, writer_main, trace) != 0) {
+        pthread_cond_destroy(&trace->wake);
+        pthread_mutex_destroy(&trace->lock);
+        fclose(trace->file);
+        free(trace);
+        return NULL;
+    }
+    return trace;
+}
+
+void event_handler_trace_destroy(event_handler_trace_t* trace) {
+    if (!trace) {
+        return;
+    }
+    pthread_mutex_lock(&trace->lock);
+    trace->stopping = true;
+    pthread_cond_signal(&trace->wake);
+    pthread_mutex_unlock(&trace->lock);
+    pthread_join(trace->writer, NULL);
+    fclose(trace->file);
+    event_handler_trace_ring_t* ring = atomic_load_explicit(&trace->rings, memory_order_acquire);
+    while (ring) {
+        event_handler_trace_ring_t* next = ring->next;
+        free(ring->data);
+        free(ring);
+        ring = next;
+    }
+    pthread_cond_destroy(&trace->wake);
+    pthread_mutex_destroy(&trace->lock);
+    free(trace);
+}
+
+bool event_handler_trace_get_stats(event_handler_trace_t* trace, event_handler_trace_stats_t* stats) {
+    if (!trace || !stats) {
+        return false;
+    }
+    stats->recorded = 0;
+    stats->dropped = atomic_load_explicit(&trace->dropped, memory_order_relaxed);
+    stats->bytes = atomic_load_explicit(&trace->bytes, memory_order_relaxed);
+    for (event_handler_trace_ring_t* ring = atomic_load_explicit(&trace->rings, memory_order_acquire); ring;
+         ring = ring->next) {
+        stats->recorded += atomic_load_explicit(&ring->recorded, memory_order_relaxed);
+        stats->dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+    }
+    return true;
+}
+
+bool event_handler_set_trace(event_handler_t* handler, event_handler_trace_t* trace) {
+    if (!handler) {
+        return false;
+    }
+    handler->trace = trace;
+    return true;
+}
+
+void event_handler_trace_record(event_handler_trace_t* trace, uint16_t id, const void* payload, size_t size) {
+    event_handler_trace_ring_t* ring = get_ring(trace);
+    if (!ring) {
+        atomic_fetch_add_explicit(&trace->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    size_t captured = (payload ? size : 0);
+    if (captured > trace->max_payload_size) {
+        captured = trace->max_payload_size;
+    }
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (ring->mask + 1 - (head - tail) < sizeof(event_handler_trace_record_t) + captured) {
+        atomic_store_explicit(&ring->dropped,
+                              atomic_load_explicit(&ring->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return;
+    }
+    event_handler_trace_record_t record = {
+        .timestamp = now_ns(), .size = (uint32_t)size, .id = id, .captured = (uint16_t)captured};
+    ring_write(ring, head, &record, sizeof(record));
+    ring_write(ring, head + sizeof(record), payload, captured);
+    size_t written = sizeof(record) + captured;
+    atomic_store_explicit(&ring->head, head + written, memory_order_release);
+    /* Wake the writer early once the ring gets half full, instead of waiting for the next flush period. */
+    size_t half = (ring->mask + 1) / 2;
+    if (head - tail < half && head + written - tail >= half) {
+        pthread_cond_signal(&trace->wake);
+    }
+    atomic_store_explicit(
+        &ring->recorded, atomic_load_explicit(&ring->recorded, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+event_handler_trace_reader_t* event_handler_trace_reader_open(const char* path) {
+    if (!path) {
+        return NULL;
+    }
+    event_handler_trace_reader_t* reader = malloc(sizeof(event_handler_trace_reader_t));
+    if (!reader) {
+        return NULL;
+    }
+    reader->file = fopen(path, "rb");
+    if (!reader->file) {
+        free(reader);
+        return NULL;
+    }
+    char magic[sizeof(EVENT_HANDLER_TRACE_MAGIC) - 1];
+    if (fread(magic, 1, sizeof(magic), reader->file) != sizeof(magic) ||
+        memcmp(magic, EVENT_HANDLER_TRACE_MAGIC, sizeof(magic)) != 0) {
+        event_handler_trace_reader_close(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+bool event_handler_trace_reader_next(event_handler_trace_reader_t* reader,
+                                     event_handler_trace_record_t* record,
+                                     const void** payload) {
+    if (!reader || !record || !payload) {
+        return false;
+    }
+    if (fread(record, sizeof(event_handler_trace_record_t), 1, reader->file) != 1) {
+        return false;
+    }
+    if (fread(reader->payload, 1, record->captured, reader->file) != record->captured) {
+        return false;
+    }
+    *payload = reader->payload;
+    return true;
+}
+
+void event_handler_trace_reader_rewind(event_handler_trace_reader_t* reader) {
+    if (!reader) {
+        return;
+    }
+    fseek(reader->file, sizeof(EVENT_HANDLER_TRACE_MAGIC) - 1, SEEK_SET);
+}
+
+void event_handler_trace_reader_close(event_handler_trace_reader_t* reader) {
+    if (!reader) {
+        return;
+    }
+    fclose(reader->file);
+    free(reader);
+}
+
+static void wait_until(uint64_t deadline) {
+    struct timespec ts = {.tv_sec = (time_t)(deadline / 1000000000u), .tv_nsec = (long)(deadline % 1000000000u)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static bool replay_post(event_handler_t* handler, uint16_t id, const void* payload, size_t size) {
+    if (event_handler_post(handler, id, payload, size)) {
+        return true;
+    }
+    event_handler_run(handler);
+    return event_handler_post(handler, id, payload, size);
+}
+
+bool event_handler_trace_replay(event_handler_t* handler,
+                                event_handler_trace_reader_t* reader,
+                                const event_handler_replay_config_t* config,
+                                event_handler_replay_stats_t* stats) {
+    if (!handler || !reader || !config || (config->path == EVENT_HANDLER_REPLAY_POST && !handler->queue)) {
+        return false;
+    }
+    event_handler_replay_stats_t result = {0};
+    event_handler_trace_record_t record;
+    const void* payload;
+    uint64_t first_timestamp = 0;
+    uint64_t start = now_ns();
+    while (event_handler_trace_reader_next(reader, &record, &payload)) {
+        if (config->realtime) {
+            if (result.events == 0) {
+                first_timestamp = record.timestamp;
+            } else if (record.timestamp > first_timestamp) {
+                wait_until(start + (record.timestamp - first_timestamp));
+            }
+        }
+        uint64_t called = now_ns();
+        bool delivered = (config->path == EVENT_HANDLER_REPLAY_POST
+                              ? replay_post(handler, record.id, payload, record.captured)
+                              : event_handler_send(handler, record.id, (void*)payload, record.captured));
+        uint64_t latency = now_ns() - called;
+        result.events++;
+        result.failed += !delivered;
+        result.bytes += record.captured;
+        result.total_latency += latency;
+        if (latency > result.max_latency) {
+            result.max_latency = latency;
+        }
+    }
+    if (config->path == EVENT_HANDLER_REPLAY_POST) {
+        event_handler_run(handler);
+    }
+    result.elapsed = now_ns() - start;
+    if (stats) {
+        *stats = result;
+    }
+    return true;
+}
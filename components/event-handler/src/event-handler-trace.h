@@ -0,0 +1,208 @@
+/*
+ * All Rights Reserved
+ *
+ * Copyright (c) 2024 Grzegorz Grzęda
+ *
+ * THE CONTENTS OF THIS PROJECT ARE PROPRIETARY AND CONFIDENTIAL.
+ * UNAUTHORIZED COPYING, TRANSFERRING OR REPRODUCTION OF THE CONTENTS OF THIS
+ * PROJECT, VIA ANY MEDIUM IS STRICTLY PROHIBITED.
+ *
+ * The receipt or possession of the source code and/or any parts thereof does
+ * not convey or imply any right to use them for any purpose other than the
+ * purpose for which they were provided to you.
+ *
+ * The software is provided "AS IS", without warranty of any kind, express or
+ * implied, including but not limited to the warranties of merchantability,
+ * fitness for a particular purpose and non infringement. In no event shall the
+ * authors or copyright holders be liable for any claim, damages or other
+ * liability, whether in an action of contract, tort or otherwise, arising from,
+ * out of or in connection with the software or the use or other dealings in the
+ * software.
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the software.
+ */
+#ifndef EVENT_HANDLER_TRACE_H
+#define EVENT_HANDLER_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "event-handler.h"
+
+/**
+ * @defgroup event_handler_trace Event Handler trace recorder
+ * @ingroup event_handler
+ * @brief Capture of dispatched events to a binary file and their replay
+ *
+ * Once attached to an event handler, the recorder captures every event passed to event_handler_send()
+ * (and so every event dispatched from the queued paths). A record is written into a ring buffer owned by
+ * the dispatching thread, without locks. A background thread streams the rings into the trace file
+ * periodically, or as soon as a ring gets half full.
+ * When a ring is full the record is dropped and counted, the dispatch is never delayed.
+ *
+ * The file starts with @ref EVENT_HANDLER_TRACE_MAGIC followed by records made of
+ * @ref event_handler_trace_record_t and `captured` payload bytes, in native byte order.
+ * Records of different threads are interleaved in chunks, timestamps are monotonic only per thread.
+ * @{
+ */
+#define EVENT_HANDLER_TRACE_MAGIC "G2LTRC01"           /**< Trace file header */
+#define EVENT_HANDLER_TRACE_DEFAULT_RING_SIZE (1 << 16) /**< Default size of a per-thread ring in bytes */
+#define EVENT_HANDLER_TRACE_DEFAULT_PAYLOAD_SIZE 64     /**< Default number of captured payload bytes */
+
+/**
+ * @brief Trace recorder type
+ *
+ * This is a declaration of the trace recorder structure type. Use only by pointer.
+ */
+typedef struct event_handler_trace event_handler_trace_t;
+
+/**
+ * @brief Trace reader type
+ *
+ * This is a declaration of the trace reader structure type. Use only by pointer.
+ */
+typedef struct event_handler_trace_reader event_handler_trace_reader_t;
+
+typedef struct event_handler_trace_config {
+    size_t ring_size;        /**< Size of a per-thread ring in bytes, rounded up to a power of two */
+    size_t max_payload_size; /**< Payload bytes captured per event, longer payloads are truncated */
+} event_handler_trace_config_t; /**< Trace recorder configuration structure definition */
+
+typedef struct event_handler_trace_record {
+    uint64_t timestamp; /**< CLOCK_MONOTONIC time of the dispatch, in nanoseconds */
+    uint32_t size;      /**< Size of the dispatched payload */
+    uint16_t id;        /**< Event ID */
+    uint16_t captured;  /**< Number of payload bytes following the record */
+} event_handler_trace_record_t; /**< Trace record header structure definition */
+
+typedef struct event_handler_trace_stats {
+    uint64_t recorded; /**< Records written to the rings */
+    uint64_t dropped;  /**< Records lost because a ring was full */
+    uint64_t bytes;    /**< Bytes streamed to the file, header included */
+} event_handler_trace_stats_t; /**< Trace recorder statistics structure definition */
+
+/**
+ * @brief Way of replaying a trace
+ */
+typedef enum event_handler_replay_path {
+    EVENT_HANDLER_REPLAY_SEND = 0, /**< Call event_handler_send() for every record */
+    EVENT_HANDLER_REPLAY_POST,     /**< Post every record and run the queue, the handler needs a queue */
+} event_handler_replay_path_t;
+
+typedef struct event_handler_replay_config {
+    event_handler_replay_path_t path; /**< Dispatch path */
+    bool realtime;                    /**< Keep the recorded spacing of events instead of going at full speed */
+} event_handler_replay_config_t; /**< Replay configuration structure definition */
+
+typedef struct event_handler_replay_stats {
+    uint64_t events;        /**< Events replayed */
+    uint64_t failed;        /**< Events not delivered: no handler for the ID or rejected by the queue */
+    uint64_t bytes;         /**< Payload bytes replayed */
+    uint64_t elapsed;       /**< Duration of the replay, in nanoseconds */
+    uint64_t total_latency; /**< Sum of dispatch call times, in nanoseconds */
+    uint64_t max_latency;   /**< Longest dispatch call, in nanoseconds */
+} event_handler_replay_stats_t; /**< Replay statistics structure definition */
+
+/**
+ * @brief Create a trace recorder writing to a file
+ * @param[in] path trace file path, the file is truncated
+ * @param[in] config pointer to configuration, NULL or zeroed fields fall back to defaults
+ * @return pointer to the newly created recorder
+ * @return NULL if the file could not be opened or no more memory
+ */
+event_handler_trace_t* event_handler_trace_create(const char* path, const event_handler_trace_config_t* config);
+
+/**
+ * @brief Stop the recorder, flush all rings and close the file
+ * @note Detach the recorder from all event handlers first.
+ * @param[in] trace pointer to the recorder
+ */
+void event_handler_trace_destroy(event_handler_trace_t* trace);
+
+/**
+ * @brief Get recorder statistics
+ * @param[in] trace pointer to the recorder
+ * @param[out] stats pointer to statistics to fill
+ * @return true if statistics were retrieved
+ * @return false if arguments were invalid
+ */
+bool event_handler_trace_get_stats(event_handler_trace_t* trace, event_handler_trace_stats_t* stats);
+
+/**
+ * @brief Attach a trace recorder to the event handler
+ * @param[in] handler pointer to the event handler
+ * @param[in] trace pointer to the recorder, NULL to detach
+ * @return true if the recorder was attached
+ * @return false if handler was invalid
+ */
+bool event_handler_set_trace(event_handler_t* handler, event_handler_trace_t* trace);
+
+/**
+ * @brief Record a single event
+ *
+ * Called by event_handler_send() when a recorder is attached. Thread safe.
+ * @param[in] trace pointer to the recorder
+ * @param[in] id event ID
+ * @param[in] payload pointer to the payload
+ * @param[in] size size of the payload
+ */
+void event_handler_trace_record(event_handler_trace_t* trace, uint16_t id, const void* payload, size_t size);
+
+/**
+ * @brief Open a trace file for reading
+ * @param[in] path trace file path
+ * @return pointer to the newly created reader
+ * @return NULL if the file could not be opened or is not a trace
+ */
+event_handler_trace_reader_t* event_handler_trace_reader_open(const char* path);
+
+/**
+ * @brief Read the next record
+ *
+ * The payload buffer stays valid until the next call or until the reader is closed.
+ * @param[in] reader pointer to the reader
+ * @param[out] record pointer to the record header to fill
+ * @param[out] payload pointer to the captured payload bytes
+ * @return true if a record was read
+ * @return false at the end of file or on a truncated record
+ */
+bool event_handler_trace_reader_next(event_handler_trace_reader_t* reader,
+                                     event_handler_trace_record_t* record,
+                                     const void** payload);
+
+/**
+ * @brief Rewind the reader to the first record
+ * @param[in] reader pointer to the reader
+ */
+void event_handler_trace_reader_rewind(event_handler_trace_reader_t* reader);
+
+/**
+ * @brief Close the reader
+ * @param[in] reader pointer to the reader
+ */
+void event_handler_trace_reader_close(event_handler_trace_reader_t* reader);
+
+/**
+ * @brief Feed all records of a trace to the event handler
+ *
+ * Records are dispatched with their captured payload, so truncated payloads are replayed truncated.
+ * The dispatch call time is the time of event_handler_send(), or of event_handler_post() together with running
+ * the queue when it was full. The post path runs the queue to completion at the end of the trace.
+ * @param[in] handler pointer to the event handler
+ * @param[in] reader pointer to the reader, replay starts at its current position
+ * @param[in] config pointer to replay configuration
+ * @param[out] stats pointer to statistics to fill, may be NULL
+ * @return true if the whole trace was replayed
+ * @return false if arguments were invalid
+ */
+bool event_handler_trace_replay(event_handler_t* handler,
+                                event_handler_trace_reader_t* reader,
+                                const event_handler_replay_config_t* config,
+                                event_handler_replay_stats_t* stats);
+
+/**
+ * @}
+ */
+
+#endif  // EVENT_HANDLER_TRACE_H
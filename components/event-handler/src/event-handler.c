@@ -25,28 +25,112 @@
 #include "event-handler.h"
 #include <stddef.h>
 #include <stdlib.h>
-#include "linked-list.h"
+#include <string.h>
+#include "event-handler-private.h"
 
-typedef struct event_handler_entry {
-    uint16_t id;
-    void* context;
-    event_handler_callback_t callback;
-} event_handler_entry_t;
+#define EVENT_HANDLER_INITIAL_TABLE_SIZE (16)
+#define EVENT_HANDLER_INITIAL_BUCKET_SIZE (2)
 
-typedef struct event_handler {
-    linked_list_t* handlers;
-} event_handler_t;
+static size_t event_handler_hash(uint16_t id, size_t table_size) {
+    return ((uint32_t)id * 40503u) & (table_size - 1);
+}
+
+event_handler_bucket_t* event_handler_find_bucket(const event_handler_t* handler, uint16_t id) {
+    for (size_t i = event_handler_hash(id, handler->table_size);; i = (i + 1) & (handler->table_size - 1)) {
+        event_handler_bucket_t* bucket = handler->table[i];
+        if (!bucket || bucket->id == id) {
+            return bucket;
+        }
+    }
+}
+
+static void insert_bucket(event_handler_bucket_t** table, size_t table_size, event_handler_bucket_t* bucket) {
+    size_t i = event_handler_hash(bucket->id, table_size);
+    while (table[i]) {
+        i = (i + 1) & (table_size - 1);
+    }
+    table[i] = bucket;
+}
+
+static bool grow_table(event_handler_t* handler) {
+    size_t new_size = handler->table_size * 2;
+    event_handler_bucket_t** new_table = calloc(new_size, sizeof(event_handler_bucket_t*));
+    if (!new_table) {
+        return false;
+    }
+    for (size_t i = 0; i < handler->table_size; i++) {
+        if (handler->table[i]) {
+            insert_bucket(new_table, new_size, handler->table[i]);
+        }
+    }
+    free(handler->table);
+    handler->table = new_table;
+    handler->table_size = new_size;
+    return true;
+}
+
+event_handler_bucket_t* event_handler_get_or_create_bucket(event_handler_t* handler, uint16_t id) {
+    event_handler_bucket_t* bucket = event_handler_find_bucket(handler, id);
+    if (bucket) {
+        return bucket;
+    }
+    if ((handler->bucket_count + 1) * 2 > handler->table_size && !grow_table(handler)) {
+        return NULL;
+    }
+    bucket = calloc(1, sizeof(event_handler_bucket_t));
+    if (!bucket) {
+        return NULL;
+    }
+    bucket->id = id;
+    insert_bucket(handler->table, handler->table_size, bucket);
+    handler->bucket_count++;
+    return bucket;
+}
+
+static bool bucket_append(event_handler_bucket_t* bucket, void* context, event_handler_callback_t callback) {
+    if (bucket->count == bucket->capacity) {
+        size_t new_capacity = bucket->capacity ? bucket->capacity * 2 : EVENT_HANDLER_INITIAL_BUCKET_SIZE;
+        event_handler_entry_t* entries = realloc(bucket->entries, new_capacity * sizeof(event_handler_entry_t));
+        if (!entries) {
+            return false;
+        }
+        bucket->entries = entries;
+        bucket->capacity = new_capacity;
+    }
+    memset(&bucket->entries[bucket->count], 0, sizeof(event_handler_entry_t));
+    bucket->entries[bucket->count].context = context;
+    bucket->entries[bucket->count].callback = callback;
+    bucket->count++;
+    return true;
+}
 
 event_handler_t* event_handler_create(void) {
     event_handler_t* handler = calloc(1, sizeof(event_handler_t));
     if (!handler) {
         return NULL;
     }
-    handler->handlers = linked_list_create();
-    if (!handler->handlers) {
+    handler->table = calloc(EVENT_HANDLER_INITIAL_TABLE_SIZE, sizeof(event_handler_bucket_t*));
+    if (!handler->table) {
         free(handler);
         return NULL;
     }
+    handler->table_size = EVENT_HANDLER_INITIAL_TABLE_SIZE;
+    return handler;
+}
+
+event_handler_t* event_handler_create_with_queue(const event_handler_queue_config_t* config) {
+    if (!config) {
+        return NULL;
+    }
+    event_handler_t* handler = event_handler_create();
+    if (!handler) {
+        return NULL;
+    }
+    handler->queue = event_handler_queue_create(config);
+    if (!handler->queue) {
+        event_handler_destroy(handler);
+        return NULL;
+    }
     return handler;
 }
 
@@ -54,7 +138,15 @@ void event_handler_destroy(event_handler_t* handler) {
     if (!handler) {
         return;
     }
-    linked_list_destroy(handler->handlers);
+    event_handler_queue_destroy(handler->queue);
+    for (size_t i = 0; i < handler->table_size; i++) {
+        if (handler->table[i]) {
+            event_handler_delivery_destroy(handler->table[i]->delivery);
+            free(handler->table[i]->entries);
+            free(handler->table[i]);
+        }
+    }
+    free(handler->table);
     free(handler);
 }
 
@@ -62,29 +154,74 @@ bool event_handler_register(event_handler_t* handler, uint16_t id, void* context
     if (!handler || !callback) {
         return false;
     }
-    event_handler_entry_t* entry = calloc(1, sizeof(event_handler_entry_t));
-    if (!entry) {
+    event_handler_bucket_t* bucket = event_handler_get_or_create_bucket(handler, id);
+    if (!bucket) {
         return false;
     }
-    entry->id = id;
-    entry->context = context;
-    entry->callback = callback;
-    linked_list_append(handler->handlers, entry);
-    return true;
+    return bucket_append(bucket, context, callback);
 }
 
 bool event_handler_send(event_handler_t* handler, uint16_t id, void* payload, size_t size) {
     if (!handler) {
         return false;
     }
-    bool was_sent_at_least_to_one_handler = false;
-    for (linked_list_iterator_t* it = linked_list_iterator_begin(handler->handlers); it;
-         it = linked_list_iterator_next(it)) {
-        event_handler_entry_t* entry = linked_list_get(it);
-        if (entry->id == id) {
-            entry->callback(handler, id, entry->context, payload, size);
-            was_sent_at_least_to_one_handler = true;
-        }
+    if (handler->trace) {
+        event_handler_trace_record(handler->trace, id, payload, size);
+    }
+    bool was_sent = event_handler_static_send(handler->static_table, handler, id, payload, size);
+    event_handler_bucket_t* bucket = event_handler_find_bucket(handler, id);
+    if (!bucket || bucket->count == 0) {
+        return was_sent;
+    }
+    /* Entries are re-read on every iteration, as a callback may register more handlers for this ID. */
+#if EVENT_HANDLER_INSTRUMENTATION
+    event_handler_clock_t clock = handler->clock;
+    uint64_t start = (clock ? clock() : 0);
+    uint64_t previous = start;
+    for (size_t i = 0; i < bucket->count; i++) {
+        event_handler_callback_t callback = bucket->entries[i].callback;
+        callback(handler, id, bucket->entries[i].context, payload, size);
+        uint64_t now = (clock ? clock() : 0);
+        event_handler_latency_record(&bucket->entries[i].latency, now - previous);
+        previous = now;
     }
-    return was_sent_at_least_to_one_handler;
+    event_handler_latency_record(&bucket->latency, previous - start);
+#else
+    for (size_t i = 0; i < bucket->count; i++) {
+        event_handler_entry_t entry = bucket->entries[i];
+        entry.callback(handler, id, entry.context, payload, size);
+    }
+#endif
+    return true;
+}
+
+bool event_handler_set_clock(event_handler_t* handler, event_handler_clock_t clock) {
+    if (!handler) {
+        return false;
+    }
+    handler->clock = clock;
+    return true;
+}
+
+bool event_handler_static_send(const event_handler_static_table_t* table,
+                               event_handler_t* handler,
+                               uint16_t id,
+                               void* payload,
+                               size_t size) {
+    if (!table || id >= table->slot_count) {
+        return false;
+    }
+    const event_handler_static_slot_t* slot = &table->slots[id];
+    for (size_t i = 0; i < slot->count; i++) {
+        slot->routes[i].callback(handler, id, slot->routes[i].context, payload, size);
+    }
+    return slot->count > 0;
+}
+
+bool event_handler_set_static_table(event_handler_t* handler, const event_handler_static_table_t* table) {
+    if (!handler) {
+        return false;
+    }
+    handler->static_table = table;
+    return true;
 }
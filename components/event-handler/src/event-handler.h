@@ -34,6 +34,8 @@
  * @brief Simple and efficient C library for handling events
  * @{
  */
+#define EVENT_HANDLER_DEFAULT_QUEUE_DEPTH 32        /**< Default number of slots in the event queue */
+#define EVENT_HANDLER_DEFAULT_QUEUE_PAYLOAD_SIZE 32 /**< Default inline payload capacity of a queue slot */
 
 /**
  * @brief Event handler type
@@ -56,6 +58,56 @@ typedef struct event_handler event_handler_t;
 typedef void (
     *event_handler_callback_t)(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size);
 
+/**
+ * @brief Policy applied when an event is posted to a full queue
+ */
+typedef enum event_handler_overflow_policy {
+    EVENT_HANDLER_OVERFLOW_DROP_NEWEST = 0, /**< Reject the event being posted */
+    EVENT_HANDLER_OVERFLOW_DROP_OLDEST,     /**< Discard the oldest pending event to make room */
+    EVENT_HANDLER_OVERFLOW_BLOCK,           /**< Wait until the consumer frees a slot */
+} event_handler_overflow_policy_t;
+
+typedef struct event_handler_queue_config {
+    size_t depth;                                    /**< Number of queue slots */
+    size_t max_payload_size;                         /**< Maximum payload size copied inline into a slot */
+    event_handler_overflow_policy_t overflow_policy; /**< What to do when the queue is full */
+} event_handler_queue_config_t; /**< Event queue configuration structure definition */
+
+typedef struct event_handler_queue_stats {
+    size_t depth;           /**< Number of queue slots */
+    size_t pending;         /**< Events currently waiting in the queue */
+    size_t high_water_mark; /**< Maximum number of pending events observed */
+    size_t posted;          /**< Events accepted into the queue */
+    size_t dropped;         /**< Events discarded because of overflow */
+    size_t dispatched;      /**< Events taken out of the queue and dispatched */
+    size_t coalesced;       /**< Events merged into an already pending event of the same ID */
+    size_t debounced;       /**< Events superseded by a later one within the debounce window */
+    size_t rate_limited;    /**< Events rejected because the ID ran out of tokens */
+} event_handler_queue_stats_t; /**< Event queue statistics structure definition */
+
+/**
+ * @brief Monotonic clock used by time based delivery policies
+ * @return current time, in units chosen by the application (e.g. milliseconds)
+ */
+typedef uint64_t (*event_handler_clock_t)(void);
+
+/**
+ * @brief How posted events of a single ID are delivered
+ */
+typedef enum event_handler_delivery_mode {
+    EVENT_HANDLER_DELIVERY_ALL = 0,    /**< Queue every posted event */
+    EVENT_HANDLER_DELIVERY_COALESCE,   /**< Replace the payload of a still pending event instead of queueing */
+    EVENT_HANDLER_DELIVERY_DEBOUNCE,   /**< Queue the latest event once no other was posted for a window */
+    EVENT_HANDLER_DELIVERY_RATE_LIMIT, /**< Queue events only while the ID has tokens left */
+} event_handler_delivery_mode_t;
+
+typedef struct event_handler_delivery_policy {
+    event_handler_delivery_mode_t mode; /**< Delivery mode */
+    uint64_t window;                    /**< Debounce quiet time or rate limit refill period, in clock units */
+    uint32_t rate;                      /**< Tokens added every window (rate limit only) */
+    uint32_t burst;                     /**< Maximum number of tokens held (rate limit only) */
+} event_handler_delivery_policy_t; /**< Per-ID delivery policy structure definition */
+
 /**
  * @brief Create a new event handler
  * @return pointer to the newly created event handler
@@ -63,6 +115,17 @@ typedef void (
  */
 event_handler_t* event_handler_create(void);
 
+/**
+ * @brief Create a new event handler with an event queue
+ *
+ * The queue is a bounded ring buffer allocated once. Events posted with event_handler_post() are copied into
+ * it and dispatched later by event_handler_run() or event_handler_run_once().
+ * @param[in] config pointer to queue configuration, zeroed depth and payload size fall back to defaults
+ * @return pointer to the newly created event handler
+ * @return NULL if the event handler could not be created
+ */
+event_handler_t* event_handler_create_with_queue(const event_handler_queue_config_t* config);
+
 /**
  * @brief Destroy the event handler
  * @param[in] handler pointer to the event handler to destroy
@@ -82,6 +145,9 @@ bool event_handler_register(event_handler_t* handler, uint16_t id, void* context
 
 /**
  * @brief Send event to the handler
+ *
+ * Handlers are looked up by the event ID, so only handlers registered for @p id are visited.
+ * They are called in the order of registration.
  * @param[in] handler pointer to the event handler
  * @param[in] id event ID to be sent
  * @param[in] payload pointer to possible payload associated with the event ID
@@ -90,6 +156,81 @@ bool event_handler_register(event_handler_t* handler, uint16_t id, void* context
  */
 bool event_handler_send(event_handler_t* handler, uint16_t id, void* payload, size_t size);
 
+/**
+ * @brief Post event to the handler queue
+ *
+ * The payload is copied into the queue slot, so the caller may reuse it right after the call.
+ * This function is thread safe. With @ref EVENT_HANDLER_OVERFLOW_BLOCK it must not be called from the thread
+ * running the queue.
+ * @param[in] handler pointer to the event handler created with event_handler_create_with_queue()
+ * @param[in] id event ID to be posted
+ * @param[in] payload pointer to possible payload associated with the event ID
+ * @param[in] size size of the payload, must not exceed the configured maximum payload size
+ * @return true if the event was queued
+ * @return false if handler has no queue, payload is too big or the event was dropped
+ */
+bool event_handler_post(event_handler_t* handler, uint16_t id, const void* payload, size_t size);
+
+/**
+ * @brief Dispatch a single queued event
+ *
+ * Handlers are called in the caller context with a pointer to a copy of the posted payload,
+ * valid until the handler returns.
+ * @note The queue has a single consumer: run it from one thread only and not from within a handler.
+ * @param[in] handler pointer to the event handler
+ * @return true if an event was taken from the queue
+ * @return false if the queue was empty
+ */
+bool event_handler_run_once(event_handler_t* handler);
+
+/**
+ * @brief Dispatch queued events until the queue is empty
+ * @param[in] handler pointer to the event handler
+ * @return number of dispatched events
+ */
+size_t event_handler_run(event_handler_t* handler);
+
+/**
+ * @brief Set the clock used by debounce and rate limit policies
+ * @param[in] handler pointer to the event handler
+ * @param[in] clock monotonic clock function
+ * @return true if the clock was set
+ * @return false if handler was invalid
+ */
+bool event_handler_set_clock(event_handler_t* handler, event_handler_clock_t clock);
+
+/**
+ * @brief Set the delivery policy of events posted with given ID
+ *
+ * Policies apply to the queue path only, event_handler_send() always calls handlers directly.
+ * Debounced events are moved to the queue by event_handler_run_once() once their window passes,
+ * so the consumer has to keep running the queue while they are held.
+ * @note Set policies before events are posted; changing a policy of an ID with events in flight is not supported.
+ * @param[in] handler pointer to the event handler created with event_handler_create_with_queue()
+ * @param[in] id event ID the policy applies to
+ * @param[in] policy pointer to the policy, NULL restores @ref EVENT_HANDLER_DELIVERY_ALL
+ * @return true if the policy was set
+ * @return false if handler has no queue, a clock is required but not set or no more memory
+ */
+bool event_handler_set_delivery_policy(event_handler_t* handler,
+                                       uint16_t id,
+                                       const event_handler_delivery_policy_t* policy);
+
+/**
+ * @brief Get event queue statistics
+ * @param[in] handler pointer to the event handler
+ * @param[out] stats pointer to statistics to fill
+ * @return true if statistics were retrieved
+ * @return false if handler has no queue
+ */
+bool event_handler_get_queue_stats(event_handler_t* handler, event_handler_queue_stats_t* stats);
+
+/**
+ * @brief Reset event queue counters and the high water mark
+ * @param[in] handler pointer to the event handler
+ */
+void event_handler_reset_queue_stats(event_handler_t* handler);
+
 /**
  * @}
  */
@@ -23,13 +23,24 @@
  * all copies or substantial portions of the software.
  */
 #include "event-handler.h"
+#include <pthread.h>
+#include <sched.h>
 #include <setjmp.h>
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "cmocka.h"
+#include "event-handler-instrumentation.h"
+#include "event-handler-mpsc.h"
+#include "event-handler-payload.h"
+#include "event-handler-pool.h"
+#include "event-handler-static.h"
+#include "event-handler-trace.h"
 
 static void test_create_event_handler(void** state) {
     (void)state;  // unused
@@ -147,12 +158,862 @@ static void test_register_multiple_handlers(void** state) {
     event_handler_destroy(handler);
 }
 
+static void test_send_unregistered_id(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+
+    assert_false(event_handler_send(NULL, 1, NULL, 0));
+    assert_false(event_handler_send(handler, 1, NULL, 0));
+    assert_true(event_handler_register(handler, 1, NULL, my_handler_function_1));
+    assert_false(event_handler_send(handler, 2, NULL, 0));
+
+    event_handler_destroy(handler);
+}
+
+static void test_handlers_keep_registration_order(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+
+    char context_1;
+    char context_2;
+    char context_3;
+    assert_true(event_handler_register(handler, 7, &context_1, my_handler_function_1));
+    assert_true(event_handler_register(handler, 8, &context_3, my_handler_function_2));
+    assert_true(event_handler_register(handler, 7, &context_2, my_handler_function_2));
+    assert_true(event_handler_register(handler, 7, &context_3, my_handler_function_1));
+
+    expect_function_call(my_handler_function_1);
+    expect_value(my_handler_function_1, handler, handler);
+    expect_value(my_handler_function_1, id, 7);
+    expect_value(my_handler_function_1, context, &context_1);
+    expect_value(my_handler_function_1, payload, NULL);
+    expect_value(my_handler_function_1, size, 0);
+    expect_function_call(my_handler_function_2);
+    expect_value(my_handler_function_2, handler, handler);
+    expect_value(my_handler_function_2, id, 7);
+    expect_value(my_handler_function_2, context, &context_2);
+    expect_value(my_handler_function_2, payload, NULL);
+    expect_value(my_handler_function_2, size, 0);
+    expect_function_call(my_handler_function_1);
+    expect_value(my_handler_function_1, handler, handler);
+    expect_value(my_handler_function_1, id, 7);
+    expect_value(my_handler_function_1, context, &context_3);
+    expect_value(my_handler_function_1, payload, NULL);
+    expect_value(my_handler_function_1, size, 0);
+    assert_true(event_handler_send(handler, 7, NULL, 0));
+
+    event_handler_destroy(handler);
+}
+
+static void counting_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)payload;
+    (void)size;
+    uint16_t* counters = context;
+    counters[id]++;
+}
+
+static void test_register_many_ids(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+
+    static uint16_t counters[UINT16_MAX + 1];
+    memset(counters, 0, sizeof(counters));
+    for (uint32_t id = 0; id <= UINT16_MAX; id += 97) {
+        assert_true(event_handler_register(handler, (uint16_t)id, counters, counting_handler));
+        assert_true(event_handler_register(handler, (uint16_t)id, counters, counting_handler));
+    }
+    for (uint32_t id = 0; id <= UINT16_MAX; id++) {
+        assert_int_equal(event_handler_send(handler, (uint16_t)id, NULL, 0), (id % 97) == 0);
+    }
+    for (uint32_t id = 0; id <= UINT16_MAX; id++) {
+        assert_int_equal(counters[id], ((id % 97) == 0) ? 2 : 0);
+    }
+
+    event_handler_destroy(handler);
+}
+
+static void recording_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)id;
+    uint32_t* last_value = context;
+    assert_int_equal(size, sizeof(uint32_t));
+    memcpy(last_value, payload, sizeof(uint32_t));
+}
+
+static void test_post_without_queue(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+
+    assert_false(event_handler_post(handler, 1, NULL, 0));
+    assert_false(event_handler_run_once(handler));
+    event_handler_queue_stats_t stats;
+    assert_false(event_handler_get_queue_stats(handler, &stats));
+
+    event_handler_destroy(handler);
+}
+
+static void test_post_and_run(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t config = {.depth = 4, .max_payload_size = sizeof(uint32_t)};
+    event_handler_t* handler = event_handler_create_with_queue(&config);
+    assert_non_null(handler);
+
+    uint32_t last_value = 0;
+    assert_true(event_handler_register(handler, 3, &last_value, recording_handler));
+
+    uint32_t value = 0x12345678;
+    assert_true(event_handler_post(handler, 3, &value, sizeof(value)));
+    value = 0;
+    assert_false(event_handler_post(handler, 3, &value, sizeof(value) + 1));
+    assert_int_equal(last_value, 0);
+
+    assert_true(event_handler_run_once(handler));
+    assert_int_equal(last_value, 0x12345678);
+    assert_false(event_handler_run_once(handler));
+
+    event_handler_destroy(handler);
+}
+
+static void test_queue_drop_newest(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t config = {
+        .depth = 2, .max_payload_size = sizeof(uint32_t), .overflow_policy = EVENT_HANDLER_OVERFLOW_DROP_NEWEST};
+    event_handler_t* handler = event_handler_create_with_queue(&config);
+    assert_non_null(handler);
+
+    uint32_t last_value = 0;
+    assert_true(event_handler_register(handler, 1, &last_value, recording_handler));
+    for (uint32_t i = 1; i <= 3; i++) {
+        assert_int_equal(event_handler_post(handler, 1, &i, sizeof(i)), i <= 2);
+    }
+
+    event_handler_queue_stats_t stats;
+    assert_true(event_handler_get_queue_stats(handler, &stats));
+    assert_int_equal(stats.depth, 2);
+    assert_int_equal(stats.pending, 2);
+    assert_int_equal(stats.high_water_mark, 2);
+    assert_int_equal(stats.posted, 2);
+    assert_int_equal(stats.dropped, 1);
+
+    assert_int_equal(event_handler_run(handler), 2);
+    assert_int_equal(last_value, 2);
+
+    assert_true(event_handler_get_queue_stats(handler, &stats));
+    assert_int_equal(stats.pending, 0);
+    assert_int_equal(stats.dispatched, 2);
+    event_handler_reset_queue_stats(handler);
+    assert_true(event_handler_get_queue_stats(handler, &stats));
+    assert_int_equal(stats.high_water_mark, 0);
+    assert_int_equal(stats.posted, 0);
+    assert_int_equal(stats.dropped, 0);
+    assert_int_equal(stats.dispatched, 0);
+
+    event_handler_destroy(handler);
+}
+
+static void sequence_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)id;
+    (void)size;
+    uint32_t* expected = context;
+    uint32_t value;
+    memcpy(&value, payload, sizeof(value));
+    assert_int_equal(value, *expected);
+    (*expected)++;
+}
+
+static void test_queue_drop_oldest(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t config = {
+        .depth = 3, .max_payload_size = sizeof(uint32_t), .overflow_policy = EVENT_HANDLER_OVERFLOW_DROP_OLDEST};
+    event_handler_t* handler = event_handler_create_with_queue(&config);
+    assert_non_null(handler);
+
+    uint32_t expected = 3;
+    assert_true(event_handler_register(handler, 1, &expected, sequence_handler));
+    for (uint32_t i = 1; i <= 5; i++) {
+        assert_true(event_handler_post(handler, 1, &i, sizeof(i)));
+    }
+    assert_int_equal(event_handler_run(handler), 3);
+    assert_int_equal(expected, 6);
+
+    event_handler_queue_stats_t stats;
+    assert_true(event_handler_get_queue_stats(handler, &stats));
+    assert_int_equal(stats.posted, 5);
+    assert_int_equal(stats.dropped, 2);
+
+    event_handler_destroy(handler);
+}
+
+#define BLOCKING_PRODUCER_EVENTS 1000
+
+static void* blocking_producer(void* arg) {
+    event_handler_t* handler = arg;
+    for (uint32_t i = 0; i < BLOCKING_PRODUCER_EVENTS; i++) {
+        if (!event_handler_post(handler, 1, &i, sizeof(i))) {
+            return NULL;
+        }
+    }
+    return handler;
+}
+
+static void test_queue_block(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t config = {
+        .depth = 4, .max_payload_size = sizeof(uint32_t), .overflow_policy = EVENT_HANDLER_OVERFLOW_BLOCK};
+    event_handler_t* handler = event_handler_create_with_queue(&config);
+    assert_non_null(handler);
+
+    uint32_t expected = 0;
+    assert_true(event_handler_register(handler, 1, &expected, sequence_handler));
+    pthread_t producer;
+    assert_int_equal(pthread_create(&producer, NULL, blocking_producer, handler), 0);
+    while (expected < BLOCKING_PRODUCER_EVENTS) {
+        event_handler_run(handler);
+    }
+    void* result;
+    pthread_join(producer, &result);
+    assert_ptr_equal(result, handler);
+
+    event_handler_queue_stats_t stats;
+    assert_true(event_handler_get_queue_stats(handler, &stats));
+    assert_int_equal(stats.dropped, 0);
+    assert_int_equal(stats.dispatched, BLOCKING_PRODUCER_EVENTS);
+    assert_in_range(stats.high_water_mark, 1, 4);
+
+    event_handler_destroy(handler);
+}
+
+#define MPSC_PRODUCERS 4
+#define MPSC_EVENTS_PER_PRODUCER 20000
+
+typedef struct mpsc_producer {
+    event_handler_mpsc_t* mpsc;
+    uint16_t id;
+} mpsc_producer_t;
+
+static uint64_t fake_now;
+
+static uint64_t fake_clock(void) {
+    return fake_now;
+}
+
+static void test_delivery_coalesce(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t config = {.depth = 4, .max_payload_size = sizeof(uint32_t)};
+    event_handler_t* handler = event_handler_create_with_queue(&config);
+    assert_non_null(handler);
+
+    uint32_t last_value = 0;
+    uint16_t calls[2] = {0};
+    assert_true(event_handler_register(handler, 1, &last_value, recording_handler));
+    assert_true(event_handler_register(handler, 1, calls, counting_handler));
+    event_handler_delivery_policy_t policy = {.mode = EVENT_HANDLER_DELIVERY_COALESCE};
+    assert_true(event_handler_set_delivery_policy(handler, 1, &policy));
+
+    for (uint32_t i = 1; i <= 10; i++) {
+        assert_true(event_handler_post(handler, 1, &i, sizeof(i)));
+    }
+    event_handler_queue_stats_t stats;
+    assert_true(event_handler_get_queue_stats(handler, &stats));
+    assert_int_equal(stats.pending, 1);
+    assert_int_equal(stats.coalesced, 9);
+
+    assert_int_equal(event_handler_run(handler), 1);
+    assert_int_equal(calls[1], 1);
+    assert_int_equal(last_value, 10);
+
+    uint32_t value = 11;
+    assert_true(event_handler_post(handler, 1, &value, sizeof(value)));
+    assert_int_equal(event_handler_run(handler), 1);
+    assert_int_equal(last_value, 11);
+
+    event_handler_destroy(handler);
+}
+
+static void test_delivery_debounce(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t config = {.depth = 4, .max_payload_size = sizeof(uint32_t)};
+    event_handler_t* handler = event_handler_create_with_queue(&config);
+    assert_non_null(handler);
+
+    uint32_t last_value = 0;
+    event_handler_delivery_policy_t policy = {.mode = EVENT_HANDLER_DELIVERY_DEBOUNCE, .window = 10};
+    assert_false(event_handler_set_delivery_policy(handler, 1, &policy));
+    assert_true(event_handler_set_clock(handler, fake_clock));
+    assert_true(event_handler_set_delivery_policy(handler, 1, &policy));
+    assert_true(event_handler_register(handler, 1, &last_value, recording_handler));
+
+    fake_now = 100;
+    for (uint32_t i = 1; i <= 3; i++) {
+        assert_true(event_handler_post(handler, 1, &i, sizeof(i)));
+        fake_now += 5;
+    }
+    assert_int_equal(event_handler_run(handler), 0);
+    fake_now = 119;
+    assert_int_equal(event_handler_run(handler), 0);
+    fake_now = 120;
+    assert_int_equal(event_handler_run(handler), 1);
+    assert_int_equal(last_value, 3);
+    fake_now = 200;
+    assert_int_equal(event_handler_run(handler), 0);
+
+    event_handler_queue_stats_t stats;
+    assert_true(event_handler_get_queue_stats(handler, &stats));
+    assert_int_equal(stats.debounced, 2);
+    assert_int_equal(stats.dispatched, 1);
+
+    uint32_t value = 4;
+    assert_true(event_handler_post(handler, 1, &value, sizeof(value)));
+    event_handler_destroy(handler);
+}
+
+static void test_delivery_rate_limit(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t config = {.depth = 16, .max_payload_size = sizeof(uint32_t)};
+    event_handler_t* handler = event_handler_create_with_queue(&config);
+    assert_non_null(handler);
+    assert_true(event_handler_set_clock(handler, fake_clock));
+
+    uint16_t calls[2] = {0};
+    fake_now = 0;
+    event_handler_delivery_policy_t policy = {
+        .mode = EVENT_HANDLER_DELIVERY_RATE_LIMIT, .window = 100, .rate = 2, .burst = 3};
+    assert_true(event_handler_set_delivery_policy(handler, 1, &policy));
+    assert_true(event_handler_register(handler, 1, calls, counting_handler));
+
+    for (int i = 0; i < 3; i++) {
+        assert_true(event_handler_post(handler, 1, NULL, 0));
+    }
+    assert_false(event_handler_post(handler, 1, NULL, 0));
+    fake_now = 49;
+    assert_false(event_handler_post(handler, 1, NULL, 0));
+    fake_now = 50;
+    assert_true(event_handler_post(handler, 1, NULL, 0));
+    assert_false(event_handler_post(handler, 1, NULL, 0));
+    fake_now = 10000;
+    for (int i = 0; i < 3; i++) {
+        assert_true(event_handler_post(handler, 1, NULL, 0));
+    }
+    assert_false(event_handler_post(handler, 1, NULL, 0));
+
+    assert_int_equal(event_handler_run(handler), 7);
+    assert_int_equal(calls[1], 7);
+    event_handler_queue_stats_t stats;
+    assert_true(event_handler_get_queue_stats(handler, &stats));
+    assert_int_equal(stats.rate_limited, 4);
+
+    event_handler_destroy(handler);
+}
+
+static void slow_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)id;
+    (void)payload;
+    (void)size;
+    fake_now += *(uint64_t*)context;
+}
+
+static void test_instrumentation(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+    assert_true(event_handler_set_clock(handler, fake_clock));
+
+    uint64_t fast = 1;
+    uint64_t slow = 100;
+    assert_true(event_handler_register(handler, 1, &fast, slow_handler));
+    assert_true(event_handler_register(handler, 1, &slow, slow_handler));
+    assert_true(event_handler_register(handler, 2, &fast, slow_handler));
+    for (int i = 0; i < 3; i++) {
+        assert_true(event_handler_send(handler, 1, NULL, 0));
+    }
+    slow = 1000;
+    assert_true(event_handler_send(handler, 1, NULL, 0));
+
+    event_handler_latency_stats_t stats;
+#if EVENT_HANDLER_INSTRUMENTATION
+    assert_true(event_handler_get_event_stats(handler, 1, &stats));
+    assert_int_equal(stats.count, 4);
+    assert_int_equal(stats.total, 4 * 1 + 3 * 100 + 1000);
+    assert_int_equal(stats.max, 1001);
+
+    assert_true(event_handler_get_callback_stats(handler, 1, &slow, slow_handler, &stats));
+    assert_int_equal(stats.count, 4);
+    assert_int_equal(stats.max, 1000);
+    assert_int_equal(stats.histogram[7], 3);
+    assert_int_equal(stats.histogram[10], 1);
+    assert_false(event_handler_get_callback_stats(handler, 2, &slow, slow_handler, &stats));
+
+    event_handler_latency_record_t records[3];
+    assert_int_equal(event_handler_snapshot_stats(handler, records, 3, true), 3);
+    size_t dispatches = 0;
+    for (size_t i = 0; i < 3; i++) {
+        dispatches += records[i].stats.count;
+    }
+    assert_int_equal(dispatches, 8);
+    assert_true(event_handler_get_event_stats(handler, 1, &stats));
+    assert_int_equal(stats.count, 0);
+    assert_true(event_handler_get_callback_stats(handler, 1, &fast, slow_handler, &stats));
+    assert_int_equal(stats.count, 0);
+#else
+    assert_false(event_handler_get_event_stats(handler, 1, &stats));
+    assert_int_equal(event_handler_snapshot_stats(handler, NULL, 0, false), 0);
+#endif
+
+    event_handler_destroy(handler);
+}
+
+static void test_trace_empty_payload(void** state) {
+    (void)state;  // unused
+    char path[] = "/tmp/event-handler-trace-XXXXXX";
+    int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    close(fd);
+
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+    event_handler_trace_t* trace = event_handler_trace_create(path, NULL);
+    assert_non_null(trace);
+    assert_true(event_handler_set_trace(handler, trace));
+    uint32_t value = 0;
+    event_handler_send(handler, 1, NULL, 0);
+    event_handler_send(handler, 2, &value, 0);
+    assert_true(event_handler_set_trace(handler, NULL));
+    event_handler_trace_stats_t trace_stats;
+    assert_true(event_handler_trace_get_stats(trace, &trace_stats));
+    assert_int_equal(trace_stats.recorded, 2);
+    event_handler_trace_destroy(trace);
+
+    event_handler_trace_reader_t* reader = event_handler_trace_reader_open(path);
+    assert_non_null(reader);
+    event_handler_trace_record_t record;
+    const void* payload;
+    for (uint16_t id = 1; id <= 2; id++) {
+        assert_true(event_handler_trace_reader_next(reader, &record, &payload));
+        assert_int_equal(record.id, id);
+        assert_int_equal(record.size, 0);
+        assert_int_equal(record.captured, 0);
+    }
+    assert_false(event_handler_trace_reader_next(reader, &record, &payload));
+    event_handler_trace_reader_close(reader);
+    event_handler_destroy(handler);
+    unlink(path);
+}
+
+static void* tracing_sender(void* arg) {
+    event_handler_t* handler = arg;
+    for (uint32_t i = 0; i < 100; i++) {
+        event_handler_send(handler, 2, &i, sizeof(i));
+    }
+    return NULL;
+}
+
+static void test_trace_record_and_replay(void** state) {
+    (void)state;  // unused
+    char path[] = "/tmp/event-handler-trace-XXXXXX";
+    int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    close(fd);
+
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+    event_handler_trace_config_t config = {.max_payload_size = 2};
+    event_handler_trace_t* trace = event_handler_trace_create(path, &config);
+    assert_non_null(trace);
+    assert_true(event_handler_set_trace(handler, trace));
+
+    pthread_t thread;
+    assert_int_equal(pthread_create(&thread, NULL, tracing_sender, handler), 0);
+    uint32_t value = 0x01020304;
+    for (int i = 0; i < 50; i++) {
+        event_handler_send(handler, 1, &value, sizeof(value));
+    }
+    event_handler_send(handler, 3, NULL, 0);
+    pthread_join(thread, NULL);
+    assert_true(event_handler_set_trace(handler, NULL));
+    event_handler_trace_stats_t trace_stats;
+    assert_true(event_handler_trace_get_stats(trace, &trace_stats));
+    assert_int_equal(trace_stats.recorded, 151);
+    assert_int_equal(trace_stats.dropped, 0);
+    event_handler_trace_destroy(trace);
+
+    event_handler_trace_reader_t* reader = event_handler_trace_reader_open(path);
+    assert_non_null(reader);
+    event_handler_trace_record_t record;
+    const void* payload;
+    uint16_t per_id[4] = {0};
+    uint64_t last_timestamp[4] = {0};
+    while (event_handler_trace_reader_next(reader, &record, &payload)) {
+        assert_true(record.id < 4);
+        assert_true(record.timestamp >= last_timestamp[record.id]);
+        last_timestamp[record.id] = record.timestamp;
+        per_id[record.id]++;
+        if (record.id == 1) {
+            assert_int_equal(record.size, sizeof(value));
+            assert_int_equal(record.captured, 2);
+            assert_memory_equal(payload, &value, 2);
+        }
+    }
+    assert_int_equal(per_id[1], 50);
+    assert_int_equal(per_id[2], 100);
+    assert_int_equal(per_id[3], 1);
+
+    uint16_t calls[4] = {0};
+    assert_true(event_handler_register(handler, 1, calls, counting_handler));
+    assert_true(event_handler_register(handler, 2, calls, counting_handler));
+    event_handler_replay_config_t replay = {.path = EVENT_HANDLER_REPLAY_SEND};
+    event_handler_replay_stats_t replay_stats;
+    event_handler_trace_reader_rewind(reader);
+    assert_true(event_handler_trace_replay(handler, reader, &replay, &replay_stats));
+    assert_int_equal(replay_stats.events, 151);
+    assert_int_equal(replay_stats.failed, 1);
+    assert_int_equal(calls[1], 50);
+    assert_int_equal(calls[2], 100);
+
+    replay.path = EVENT_HANDLER_REPLAY_POST;
+    event_handler_trace_reader_rewind(reader);
+    assert_false(event_handler_trace_replay(handler, reader, &replay, &replay_stats));
+    event_handler_destroy(handler);
+
+    event_handler_queue_config_t queue_config = {.depth = 8, .max_payload_size = 2};
+    handler = event_handler_create_with_queue(&queue_config);
+    assert_non_null(handler);
+    memset(calls, 0, sizeof(calls));
+    assert_true(event_handler_register(handler, 2, calls, counting_handler));
+    assert_true(event_handler_trace_replay(handler, reader, &replay, &replay_stats));
+    assert_int_equal(replay_stats.events, 151);
+    assert_int_equal(replay_stats.failed, 0);
+    assert_int_equal(calls[2], 100);
+
+    event_handler_trace_reader_close(reader);
+    event_handler_destroy(handler);
+    unlink(path);
+}
+
+static void* mpsc_producer(void* arg) {
+    mpsc_producer_t* producer = arg;
+    for (uint32_t i = 0; i < MPSC_EVENTS_PER_PRODUCER; i++) {
+        while (!event_handler_mpsc_post(producer->mpsc, producer->id, &i, sizeof(i))) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_mpsc_stress(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+    event_handler_mpsc_t* mpsc = event_handler_mpsc_create(handler, 64, sizeof(uint32_t));
+    assert_non_null(mpsc);
+
+    uint32_t expected[MPSC_PRODUCERS] = {0};
+    mpsc_producer_t producers[MPSC_PRODUCERS];
+    pthread_t threads[MPSC_PRODUCERS];
+    for (uint16_t i = 0; i < MPSC_PRODUCERS; i++) {
+        assert_true(event_handler_register(handler, i, &expected[i], sequence_handler));
+        producers[i].mpsc = mpsc;
+        producers[i].id = i;
+        assert_int_equal(pthread_create(&threads[i], NULL, mpsc_producer, &producers[i]), 0);
+    }
+    size_t dispatched = 0;
+    while (dispatched < MPSC_PRODUCERS * MPSC_EVENTS_PER_PRODUCER) {
+        size_t count = event_handler_mpsc_run(mpsc);
+        if (count == 0) {
+            sched_yield();
+        }
+        dispatched += count;
+    }
+    for (size_t i = 0; i < MPSC_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+        assert_int_equal(expected[i], MPSC_EVENTS_PER_PRODUCER);
+    }
+    assert_false(event_handler_mpsc_run_once(mpsc));
+
+    event_handler_mpsc_destroy(mpsc);
+    event_handler_destroy(handler);
+}
+
+static event_handler_mpsc_t* signal_mpsc;
+
+static void posting_signal_handler(int signal_number) {
+    uint32_t value = (uint32_t)signal_number;
+    event_handler_mpsc_post(signal_mpsc, 1, &value, sizeof(value));
+}
+
+static void test_mpsc_post_from_signal_handler(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+    signal_mpsc = event_handler_mpsc_create(handler, 2, sizeof(uint32_t));
+    assert_non_null(signal_mpsc);
+
+    uint32_t last_value = 0;
+    assert_true(event_handler_register(handler, 1, &last_value, recording_handler));
+    struct sigaction action = {.sa_handler = posting_signal_handler};
+    struct sigaction previous;
+    assert_int_equal(sigaction(SIGUSR1, &action, &previous), 0);
+    assert_int_equal(raise(SIGUSR1), 0);
+    assert_int_equal(raise(SIGUSR1), 0);
+    assert_int_equal(raise(SIGUSR1), 0);
+    sigaction(SIGUSR1, &previous, NULL);
+
+    assert_int_equal(event_handler_mpsc_dropped(signal_mpsc), 1);
+    assert_int_equal(event_handler_mpsc_run(signal_mpsc), 2);
+    assert_int_equal(last_value, SIGUSR1);
+
+    event_handler_mpsc_destroy(signal_mpsc);
+    event_handler_destroy(handler);
+}
+
+#define POOL_IDS 64
+#define POOL_EVENTS_PER_ID 500
+
+typedef struct pool_counters {
+    uint32_t next[POOL_IDS];
+    atomic_int errors;
+} pool_counters_t;
+
+static void pool_sequence_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    pool_counters_t* counters = context;
+    uint32_t value;
+    memcpy(&value, payload, sizeof(value));
+    if (size != sizeof(value) || value != counters->next[id]) {
+        atomic_fetch_add(&counters->errors, 1);
+    }
+    counters->next[id] = value + 1;
+}
+
+static void test_pool_keeps_per_id_order(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+    static pool_counters_t counters;
+    memset(&counters, 0, sizeof(counters));
+    for (uint16_t id = 0; id < POOL_IDS; id++) {
+        assert_true(event_handler_register(handler, id, &counters, pool_sequence_handler));
+    }
+    event_handler_pool_config_t config = {.worker_count = 4, .shard_depth = 16, .max_payload_size = sizeof(uint32_t)};
+    event_handler_pool_t* pool = event_handler_pool_create(handler, &config);
+    assert_non_null(pool);
+    assert_false(event_handler_pool_post(pool, 0, &counters, sizeof(uint32_t) + 1));
+
+    for (uint32_t i = 0; i < POOL_EVENTS_PER_ID; i++) {
+        for (uint16_t id = 0; id < POOL_IDS; id++) {
+            while (!event_handler_pool_post(pool, id, &i, sizeof(i))) {
+                sched_yield();
+            }
+        }
+    }
+    event_handler_pool_flush(pool);
+    assert_int_equal(atomic_load(&counters.errors), 0);
+    for (uint16_t id = 0; id < POOL_IDS; id++) {
+        assert_int_equal(counters.next[id], POOL_EVENTS_PER_ID);
+    }
+
+    event_handler_pool_destroy(pool);
+    event_handler_destroy(handler);
+}
+
+static void test_payload_pool_classes(void** state) {
+    (void)state;  // unused
+    const event_handler_payload_class_t classes[] = {{.block_size = 8, .block_count = 2},
+                                                     {.block_size = 64, .block_count = 1}};
+    event_handler_payload_pool_t* pool = event_handler_payload_pool_create(classes, 2);
+    assert_non_null(pool);
+
+    event_handler_payload_t* small_1 = event_handler_payload_alloc(pool, 4);
+    event_handler_payload_t* small_2 = event_handler_payload_alloc(pool, 8);
+    event_handler_payload_t* spilled = event_handler_payload_alloc(pool, 8);
+    assert_non_null(small_1);
+    assert_non_null(small_2);
+    assert_non_null(spilled);
+    assert_null(event_handler_payload_alloc(pool, 8));
+    assert_null(event_handler_payload_alloc(pool, 65));
+    assert_int_equal(event_handler_payload_size(small_1), 4);
+    assert_ptr_equal(event_handler_payload_from_data(event_handler_payload_data(small_2)), small_2);
+
+    event_handler_payload_stats_t stats;
+    assert_true(event_handler_payload_pool_get_stats(pool, 0, &stats));
+    assert_int_equal(stats.block_size, 8);
+    assert_int_equal(stats.in_use, 2);
+    assert_int_equal(stats.peak, 2);
+    assert_int_equal(stats.allocations, 2);
+    assert_int_equal(stats.failures, 1);
+    assert_true(event_handler_payload_pool_get_stats(pool, 1, &stats));
+    assert_int_equal(stats.in_use, 1);
+    assert_int_equal(stats.failures, 0);
+    assert_false(event_handler_payload_pool_get_stats(pool, 2, &stats));
+
+    event_handler_payload_retain(small_1);
+    event_handler_payload_release(small_1);
+    assert_true(event_handler_payload_pool_get_stats(pool, 0, &stats));
+    assert_int_equal(stats.in_use, 2);
+    event_handler_payload_release(small_1);
+    event_handler_payload_release(small_2);
+    event_handler_payload_release(spilled);
+    assert_true(event_handler_payload_pool_get_stats(pool, 0, &stats));
+    assert_int_equal(stats.in_use, 0);
+    assert_int_equal(stats.peak, 2);
+    assert_non_null(event_handler_payload_alloc(pool, 1));
+
+    event_handler_payload_pool_destroy(pool);
+}
+
+static void retaining_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)id;
+    (void)size;
+    event_handler_payload_t** kept = context;
+    *kept = event_handler_payload_from_data(payload);
+    event_handler_payload_retain(*kept);
+}
+
+static void test_payload_shared_by_handlers(void** state) {
+    (void)state;  // unused
+    const event_handler_payload_class_t classes[] = {{.block_size = 16, .block_count = 1}};
+    event_handler_payload_pool_t* pool = event_handler_payload_pool_create(classes, 1);
+    event_handler_queue_config_t config = {.depth = 1, .overflow_policy = EVENT_HANDLER_OVERFLOW_DROP_OLDEST};
+    event_handler_t* handler = event_handler_create_with_queue(&config);
+    assert_non_null(pool);
+    assert_non_null(handler);
+
+    event_handler_payload_t* kept_1 = NULL;
+    event_handler_payload_t* kept_2 = NULL;
+    assert_true(event_handler_register(handler, 1, &kept_1, retaining_handler));
+    assert_true(event_handler_register(handler, 1, &kept_2, retaining_handler));
+
+    event_handler_payload_t* payload = event_handler_payload_alloc(pool, 16);
+    assert_non_null(payload);
+    assert_true(event_handler_post_payload(handler, 1, payload));
+    assert_true(event_handler_post_payload(handler, 1, payload));
+    event_handler_payload_release(payload);
+    assert_int_equal(event_handler_run(handler), 1);
+    assert_ptr_equal(kept_1, payload);
+    assert_ptr_equal(kept_2, payload);
+
+    event_handler_payload_stats_t stats;
+    event_handler_payload_release(kept_1);
+    assert_true(event_handler_payload_pool_get_stats(pool, 0, &stats));
+    assert_int_equal(stats.in_use, 1);
+    event_handler_payload_release(kept_2);
+    assert_true(event_handler_payload_pool_get_stats(pool, 0, &stats));
+    assert_int_equal(stats.in_use, 0);
+
+    payload = event_handler_payload_alloc(pool, 4);
+    assert_true(event_handler_send_payload(handler, 1, payload));
+    event_handler_payload_release(kept_1);
+    event_handler_payload_release(kept_2);
+    event_handler_payload_release(payload);
+    assert_true(event_handler_payload_pool_get_stats(pool, 0, &stats));
+    assert_int_equal(stats.in_use, 0);
+
+    event_handler_destroy(handler);
+    event_handler_payload_pool_destroy(pool);
+}
+
+static char static_context_1;
+static char static_context_2;
+
+EVENT_HANDLER_STATIC_ROUTES(static_routes_4,
+                            EVENT_HANDLER_STATIC_ROUTE(my_handler_function_1, &static_context_1),
+                            EVENT_HANDLER_STATIC_ROUTE(my_handler_function_2, &static_context_2));
+EVENT_HANDLER_STATIC_ROUTES(static_routes_9, EVENT_HANDLER_STATIC_ROUTE(my_handler_function_2, NULL));
+EVENT_HANDLER_STATIC_TABLE(static_table,
+                           9,
+                           EVENT_HANDLER_STATIC_SLOT(4, static_routes_4),
+                           EVENT_HANDLER_STATIC_SLOT(9, static_routes_9));
+
+static void test_static_table(void** state) {
+    (void)state;  // unused
+    char random_data[4];
+    expect_function_call(my_handler_function_1);
+    expect_value(my_handler_function_1, handler, NULL);
+    expect_value(my_handler_function_1, id, 4);
+    expect_value(my_handler_function_1, context, &static_context_1);
+    expect_value(my_handler_function_1, payload, random_data);
+    expect_value(my_handler_function_1, size, sizeof(random_data));
+    expect_function_call(my_handler_function_2);
+    expect_value(my_handler_function_2, handler, NULL);
+    expect_value(my_handler_function_2, id, 4);
+    expect_value(my_handler_function_2, context, &static_context_2);
+    expect_value(my_handler_function_2, payload, random_data);
+    expect_value(my_handler_function_2, size, sizeof(random_data));
+    assert_true(event_handler_static_send(&static_table, NULL, 4, random_data, sizeof(random_data)));
+    assert_false(event_handler_static_send(&static_table, NULL, 5, NULL, 0));
+    assert_false(event_handler_static_send(&static_table, NULL, 10, NULL, 0));
+    assert_false(event_handler_static_send(NULL, NULL, 4, NULL, 0));
+}
+
+static void test_static_table_next_to_dynamic_handlers(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+    assert_true(event_handler_set_static_table(handler, &static_table));
+    char random_context[4];
+    assert_true(event_handler_register(handler, 9, random_context, my_handler_function_1));
+    assert_true(event_handler_register(handler, 10, random_context, my_handler_function_1));
+
+    expect_function_call(my_handler_function_2);
+    expect_value(my_handler_function_2, handler, handler);
+    expect_value(my_handler_function_2, id, 9);
+    expect_value(my_handler_function_2, context, NULL);
+    expect_value(my_handler_function_2, payload, NULL);
+    expect_value(my_handler_function_2, size, 0);
+    expect_function_call(my_handler_function_1);
+    expect_value(my_handler_function_1, handler, handler);
+    expect_value(my_handler_function_1, id, 9);
+    expect_value(my_handler_function_1, context, random_context);
+    expect_value(my_handler_function_1, payload, NULL);
+    expect_value(my_handler_function_1, size, 0);
+    assert_true(event_handler_send(handler, 9, NULL, 0));
+
+    expect_function_call(my_handler_function_1);
+    expect_value(my_handler_function_1, handler, handler);
+    expect_value(my_handler_function_1, id, 10);
+    expect_value(my_handler_function_1, context, random_context);
+    expect_value(my_handler_function_1, payload, NULL);
+    expect_value(my_handler_function_1, size, 0);
+    assert_true(event_handler_send(handler, 10, NULL, 0));
+    assert_false(event_handler_send(handler, 5, NULL, 0));
+
+    event_handler_destroy(handler);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_create_event_handler),
         cmocka_unit_test(test_register_one_handler),
         cmocka_unit_test(test_register_one_handler_multiple_contexts),
         cmocka_unit_test(test_register_multiple_handlers),
+        cmocka_unit_test(test_send_unregistered_id),
+        cmocka_unit_test(test_handlers_keep_registration_order),
+        cmocka_unit_test(test_register_many_ids),
+        cmocka_unit_test(test_post_without_queue),
+        cmocka_unit_test(test_post_and_run),
+        cmocka_unit_test(test_queue_drop_newest),
+        cmocka_unit_test(test_queue_drop_oldest),
+        cmocka_unit_test(test_queue_block),
+        cmocka_unit_test(test_delivery_coalesce),
+        cmocka_unit_test(test_delivery_debounce),
+        cmocka_unit_test(test_delivery_rate_limit),
+        cmocka_unit_test(test_instrumentation),
+        cmocka_unit_test(test_trace_record_and_replay),
+        cmocka_unit_test(test_trace_empty_payload),
+        cmocka_unit_test(test_mpsc_stress),
+        cmocka_unit_test(test_mpsc_post_from_signal_handler),
+        cmocka_unit_test(test_pool_keeps_per_id_order),
+        cmocka_unit_test(test_payload_pool_classes),
+        cmocka_unit_test(test_payload_shared_by_handlers),
+        cmocka_unit_test(test_static_table),
+        cmocka_unit_test(test_static_table_next_to_dynamic_handlers),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "linked-list.h"
+
+#define BENCHMARK_LISTS (1000)
+#define BENCHMARK_ROUNDS (200000)
+#define BENCHMARK_MAX_APPENDS (32)
+#define BENCHMARK_SLAB_BLOCKS (1024)
+#define BENCHMARK_ARENA_BLOCKS (BENCHMARK_LISTS * (BENCHMARK_MAX_APPENDS + 1))
+
+/* Calls from the linked-list library are routed here with -Wl,--wrap, so every heap call is counted. */
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void __real_free(void* pointer);
+
+static size_t allocations;
+static size_t frees;
+
+void* __wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void __wrap_free(void* pointer) {
+    if (pointer) {
+        frees++;
+    }
+    __real_free(pointer);
+}
+
+typedef enum list_backing {
+    BACKING_MALLOC,
+    BACKING_SLAB,
+    BACKING_STATIC,
+} list_backing_t;
+
+static const char* backing_names[] = {"malloc", "slab pool", "static arena"};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static linked_list_t* create_list(linked_list_pool_t* pool) {
+    return pool ? linked_list_create_with_pool(pool) : linked_list_create();
+}
+
+/*
+ * Lists are appended to and recreated in random order, while the application keeps some unrelated
+ * short lived buffers on the heap. The heap left free but not returned after the churn is the fragmentation.
+ */
+static void benchmark(list_backing_t backing) {
+    static void* arena[LINKED_LIST_POOL_ARENA_SIZE(BENCHMARK_ARENA_BLOCKS) / sizeof(void*)];
+    static void* buffers[BENCHMARK_LISTS];
+    linked_list_t* lists[BENCHMARK_LISTS];
+    size_t lengths[BENCHMARK_LISTS] = {0};
+    int element = 0;
+    srand(1);
+
+    struct mallinfo2 before = mallinfo2();
+    linked_list_pool_t* pool = NULL;
+    if (backing == BACKING_SLAB) {
+        pool = linked_list_pool_create(BENCHMARK_SLAB_BLOCKS);
+    } else if (backing == BACKING_STATIC) {
+        pool = linked_list_pool_create_static(arena, sizeof(arena));
+    }
+    allocations = 0;
+    frees = 0;
+
+    double start = now_seconds();
+    for (size_t i = 0; i < BENCHMARK_LISTS; i++) {
+        lists[i] = create_list(pool);
+    }
+    for (size_t round = 0; round < BENCHMARK_ROUNDS; round++) {
+        size_t i = (size_t)rand() % BENCHMARK_LISTS;
+        if (lengths[i] < BENCHMARK_MAX_APPENDS) {
+            linked_list_append(lists[i], &element);
+            lengths[i]++;
+        } else {
+            linked_list_destroy(lists[i]);
+            lists[i] = create_list(pool);
+            lengths[i] = 0;
+        }
+        size_t buffer = (size_t)rand() % BENCHMARK_LISTS;
+        __real_free(buffers[buffer]);
+        buffers[buffer] = __real_malloc(16 + (size_t)rand() % 48);
+    }
+    double elapsed = now_seconds() - start;
+
+    for (size_t i = 0; i < BENCHMARK_LISTS; i += 2) {
+        linked_list_destroy(lists[i]);
+        lists[i] = NULL;
+    }
+    struct mallinfo2 after = mallinfo2();
+    printf("%-12s: %.3f s, %zu allocations, %zu frees, heap in use %zu B, heap free %zu B\n",
+           backing_names[backing],
+           elapsed,
+           allocations,
+           frees,
+           after.uordblks - before.uordblks,
+           after.fordblks);
+
+    for (size_t i = 1; i < BENCHMARK_LISTS; i += 2) {
+        linked_list_destroy(lists[i]);
+    }
+    for (size_t i = 0; i < BENCHMARK_LISTS; i++) {
+        __real_free(buffers[i]);
+        buffers[i] = NULL;
+    }
+    linked_list_pool_destroy(pool);
+}
+
+int main(void) {
+    /* Every run gets a fresh heap in its own process, so fragmentation of one run does not leak into the next. */
+    for (list_backing_t backing = BACKING_MALLOC; backing <= BACKING_STATIC; backing++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            benchmark(backing);
+            return 0;
+        }
+        waitpid(pid, NULL, 0);
+    }
+    return 0;
+}
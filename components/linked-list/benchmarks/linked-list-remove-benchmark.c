@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+#include "linked-list.h"
+
+#define BENCHMARK_LENGTHS (4)
+#define BENCHMARK_ELEMENTS_TOTAL (1 << 20)
+
+static const size_t lengths[BENCHMARK_LENGTHS] = {16, 256, 4096, 65536};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool should_remove(const void* data) {
+    return ((size_t)data % 3) == 0;
+}
+
+static linked_list_t* fill(size_t length) {
+    linked_list_t* list = linked_list_create();
+    for (size_t i = 0; i < length; i++) {
+        linked_list_append(list, (void*)i);
+    }
+    return list;
+}
+
+/* Without O(1) removal a filtered list had to be rebuilt from the kept elements, and its length counted by walking. */
+static linked_list_t* remove_by_rebuild(linked_list_t* list, size_t* size) {
+    linked_list_t* kept = linked_list_create();
+    linked_list_iterator_t* it = linked_list_iterator_begin(list);
+    for (; it != NULL; it = linked_list_iterator_next(it)) {
+        if (!should_remove(linked_list_get(it))) {
+            linked_list_append(kept, linked_list_get(it));
+        }
+    }
+    linked_list_destroy(list);
+    *size = 0;
+    for (it = linked_list_iterator_begin(kept); it != NULL; it = linked_list_iterator_next(it)) {
+        (*size)++;
+    }
+    return kept;
+}
+
+static linked_list_t* remove_in_place(linked_list_t* list, size_t* size) {
+    linked_list_iterator_t* it = NULL;
+    linked_list_iterator_t* next = NULL;
+    LINKED_LIST_FOR_EACH_SAFE(list, it, next) {
+        if (should_remove(linked_list_get(it))) {
+            linked_list_remove(list, it);
+        }
+    }
+    *size = linked_list_size(list);
+    return list;
+}
+
+static void benchmark(const char* name, linked_list_t* (*filter)(linked_list_t*, size_t*), size_t length) {
+    size_t rounds = BENCHMARK_ELEMENTS_TOTAL / length;
+    size_t checksum = 0;
+    double elapsed = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        linked_list_t* list = fill(length);
+        size_t size = 0;
+        double start = now_seconds();
+        list = filter(list, &size);
+        elapsed += now_seconds() - start;
+        checksum += size;
+        linked_list_destroy(list);
+    }
+    printf("%-8s length %6zu: %8.2f ns per element (kept %zu)\n",
+           name,
+           length,
+           elapsed * 1e9 / (double)(rounds * length),
+           checksum / rounds);
+}
+
+int main(void) {
+    for (size_t i = 0; i < BENCHMARK_LENGTHS; i++) {
+        benchmark("rebuild", remove_by_rebuild, lengths[i]);
+        benchmark("remove", remove_in_place, lengths[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @defgroup intrusive-list Intrusive list
+ * @ingroup linked-list
+ *
+ * @brief A doubly linked list with nodes embedded in the elements.
+ *
+ * The user's struct carries an @ref intrusive_list_node_t member, so linking an element needs no allocation
+ * and removing it is O(1). The list never owns its elements. An element is recovered from its node with
+ * intrusive_list_entry().
+ * @{
+ */
+
+/**
+ * @brief Link node, embed it in the element struct.
+ */
+typedef struct intrusive_list_node {
+    struct intrusive_list_node* next;
+    struct intrusive_list_node* prev;
+} intrusive_list_node_t;
+
+/**
+ * @brief Intrusive list, a circular list around a sentinel node.
+ */
+typedef struct intrusive_list {
+    intrusive_list_node_t sentinel;
+} intrusive_list_t;
+
+/**
+ * @brief Static initializer of an empty list.
+ * @param list The list variable being initialized.
+ */
+#define INTRUSIVE_LIST_INIT(list) {{&(list).sentinel, &(list).sentinel}}
+
+/**
+ * @brief Get the element containing a node.
+ * @param node A pointer to the node.
+ * @param type The element type.
+ * @param member The name of the node member in @p type.
+ */
+#define intrusive_list_entry(node, type, member) ((type*)((char*)(node) - offsetof(type, member)))
+
+/**
+ * @brief Iterate over all nodes of a list.
+ * @note The current node must not be removed, use INTRUSIVE_LIST_FOR_EACH_SAFE() for that.
+ * @param list A pointer to the list.
+ * @param node A node pointer variable used as the cursor.
+ */
+#define INTRUSIVE_LIST_FOR_EACH(list, node) \
+    for ((node) = (list)->sentinel.next; (node) != &(list)->sentinel; (node) = (node)->next)
+
+/**
+ * @brief Iterate over all nodes of a list, the current node may be removed.
+ * @param list A pointer to the list.
+ * @param node A node pointer variable used as the cursor.
+ * @param next A node pointer variable holding the next node.
+ */
+#define INTRUSIVE_LIST_FOR_EACH_SAFE(list, node, next)                                       \
+    for ((node) = (list)->sentinel.next, (next) = (node)->next; (node) != &(list)->sentinel; \
+         (node) = (next), (next) = (node)->next)
+
+/**
+ * @brief Initialize an empty list.
+ * @param list A pointer to the list.
+ */
+static inline void intrusive_list_init(intrusive_list_t* list) {
+    list->sentinel.next = &list->sentinel;
+    list->sentinel.prev = &list->sentinel;
+}
+
+/**
+ * @brief Check if a list is empty.
+ * @param list A pointer to the list.
+ * @return true if the list has no nodes.
+ */
+static inline bool intrusive_list_is_empty(const intrusive_list_t* list) {
+    return list->sentinel.next == &list->sentinel;
+}
+
+/**
+ * @brief Check if a node is linked into a list.
+ * @param node A pointer to a zero initialized or previously linked node.
+ * @return true if the node is in a list.
+ */
+static inline bool intrusive_list_is_linked(const intrusive_list_node_t* node) {
+    return node->next != NULL;
+}
+
+/**
+ * @brief Link a node between two adjacent nodes.
+ * @param node A pointer to the node to link.
+ * @param prev A pointer to the node before.
+ * @param next A pointer to the node after.
+ */
+static inline void intrusive_list_link(intrusive_list_node_t* node,
+                                       intrusive_list_node_t* prev,
+                                       intrusive_list_node_t* next) {
+    node->prev = prev;
+    node->next = next;
+    prev->next = node;
+    next->prev = node;
+}
+
+/**
+ * @brief Append a node to the end of a list.
+ * @param list A pointer to the list.
+ * @param node A pointer to the node, must not be linked.
+ */
+static inline void intrusive_list_push_back(intrusive_list_t* list, intrusive_list_node_t* node) {
+    intrusive_list_link(node, list->sentinel.prev, &list->sentinel);
+}
+
+/**
+ * @brief Prepend a node to the beginning of a list.
+ * @param list A pointer to the list.
+ * @param node A pointer to the node, must not be linked.
+ */
+static inline void intrusive_list_push_front(intrusive_list_t* list, intrusive_list_node_t* node) {
+    intrusive_list_link(node, &list->sentinel, list->sentinel.next);
+}
+
+/**
+ * @brief Unlink a node from its list.
+ * @param node A pointer to a linked node, it is left unlinked.
+ */
+static inline void intrusive_list_remove(intrusive_list_node_t* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+/**
+ * @brief Get the first node of a list.
+ * @param list A pointer to the list.
+ * @return A pointer to the first node.
+ * @return NULL if the list is empty.
+ */
+static inline intrusive_list_node_t* intrusive_list_first(intrusive_list_t* list) {
+    return (intrusive_list_is_empty(list) ? NULL : list->sentinel.next);
+}
+
+/**
+ * @brief Get the node following another one.
+ * @param list A pointer to the list.
+ * @param node A pointer to a node of @p list.
+ * @return A pointer to the next node.
+ * @return NULL if @p node is the last one.
+ */
+static inline intrusive_list_node_t* intrusive_list_next(intrusive_list_t* list, intrusive_list_node_t* node) {
+    return (node->next == &list->sentinel ? NULL : node->next);
+}
+
+/**
+ * @}
+ */
+
+#endif  // INTRUSIVE_LIST_H
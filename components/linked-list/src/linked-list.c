@@ -22,7 +22,10 @@
  * SOFTWARE.
  */
 #include "linked-list.h"
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef struct linked_list_iterator {
     void* data;
@@ -33,8 +36,129 @@ typedef struct linked_list_iterator {
 typedef struct linked_list {
     linked_list_iterator_t* head;
     linked_list_iterator_t* tail;
+    linked_list_pool_t* pool;
+    size_t size;
 } linked_list_t;
 
+/* Nodes and list headers share the pool blocks, a free block links to the next one through `next`. */
+typedef union linked_list_pool_block {
+    linked_list_iterator_t node;
+    linked_list_t list;
+    union linked_list_pool_block* next;
+} linked_list_pool_block_t;
+
+typedef struct linked_list_pool_slab {
+    struct linked_list_pool_slab* next;
+    linked_list_pool_block_t blocks[];
+} linked_list_pool_slab_t;
+
+typedef struct linked_list_pool {
+    linked_list_pool_block_t* free_list;
+    linked_list_pool_slab_t* slabs;
+    size_t blocks_per_slab;
+    linked_list_pool_stats_t stats;
+} linked_list_pool_t;
+
+_Static_assert(sizeof(linked_list_pool_block_t) == LINKED_LIST_POOL_BLOCK_SIZE, "Pool block size mismatch");
+_Static_assert(sizeof(linked_list_pool_t) <= LINKED_LIST_POOL_HEADER_SIZE, "Pool header does not fit its space");
+
+static void pool_add_blocks(linked_list_pool_t* pool, linked_list_pool_block_t* blocks, size_t count) {
+    for (size_t i = count; i > 0; i--) {
+        blocks[i - 1].next = pool->free_list;
+        pool->free_list = &blocks[i - 1];
+    }
+    pool->stats.capacity += count;
+}
+
+static void* pool_alloc(linked_list_pool_t* pool) {
+    if (pool->free_list == NULL && pool->blocks_per_slab > 0) {
+        linked_list_pool_slab_t* slab =
+            malloc(sizeof(linked_list_pool_slab_t) + pool->blocks_per_slab * sizeof(linked_list_pool_block_t));
+        if (slab != NULL) {
+            slab->next = pool->slabs;
+            pool->slabs = slab;
+            pool->stats.slabs++;
+            pool_add_blocks(pool, slab->blocks, pool->blocks_per_slab);
+        }
+    }
+    linked_list_pool_block_t* block = pool->free_list;
+    if (block == NULL) {
+        return NULL;
+    }
+    pool->free_list = block->next;
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.peak) {
+        pool->stats.peak = pool->stats.in_use;
+    }
+    memset(block, 0, sizeof(linked_list_pool_block_t));
+    return block;
+}
+
+static void pool_free(linked_list_pool_t* pool, void* memory) {
+    linked_list_pool_block_t* block = memory;
+    block->next = pool->free_list;
+    pool->free_list = block;
+    pool->stats.in_use--;
+}
+
+linked_list_pool_t* linked_list_pool_create_static(void* arena, size_t size) {
+    if (arena == NULL || size < LINKED_LIST_POOL_ARENA_SIZE(1) || ((uintptr_t)arena % sizeof(void*)) != 0) {
+        return NULL;
+    }
+    linked_list_pool_t* pool = arena;
+    memset(pool, 0, sizeof(linked_list_pool_t));
+    pool_add_blocks(pool,
+                    (linked_list_pool_block_t*)((unsigned char*)arena + LINKED_LIST_POOL_HEADER_SIZE),
+                    (size - LINKED_LIST_POOL_HEADER_SIZE) / sizeof(linked_list_pool_block_t));
+    return pool;
+}
+
+linked_list_pool_t* linked_list_pool_create(size_t blocks_per_slab) {
+    if (blocks_per_slab == 0) {
+        return NULL;
+    }
+    linked_list_pool_t* pool = calloc(1, sizeof(linked_list_pool_t));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->blocks_per_slab = blocks_per_slab;
+    return pool;
+}
+
+void linked_list_pool_destroy(linked_list_pool_t* pool) {
+    if (pool == NULL || pool->blocks_per_slab == 0) {
+        return;
+    }
+    while (pool->slabs != NULL) {
+        linked_list_pool_slab_t* next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
+    }
+    free(pool);
+}
+
+void linked_list_pool_get_stats(const linked_list_pool_t* pool, linked_list_pool_stats_t* stats) {
+    if (pool == NULL || stats == NULL) {
+        return;
+    }
+    *stats = pool->stats;
+}
+
+static linked_list_iterator_t* node_alloc(linked_list_t* list) {
+    if (list->pool != NULL) {
+        return pool_alloc(list->pool);
+    }
+    return calloc(1, sizeof(linked_list_iterator_t));
+}
+
+static void node_free(linked_list_t* list, linked_list_iterator_t* node) {
+    if (list->pool != NULL) {
+        pool_free(list->pool, node);
+    } else {
+        free(node);
+    }
+}
+
 linked_list_t* linked_list_create(void) {
     linked_list_t* list = calloc(1, sizeof(linked_list_t));
     if (list == NULL) {
@@ -43,34 +167,156 @@ linked_list_t* linked_list_create(void) {
     return list;
 }
 
+linked_list_t* linked_list_create_with_pool(linked_list_pool_t* pool) {
+    if (pool == NULL) {
+        return NULL;
+    }
+    linked_list_t* list = pool_alloc(pool);
+    if (list == NULL) {
+        return NULL;
+    }
+    list->pool = pool;
+    return list;
+}
+
 void linked_list_destroy(linked_list_t* list) {
+    if (list == NULL) {
+        return;
+    }
     linked_list_iterator_t* iterator = linked_list_iterator_begin(list);
     while (iterator != NULL) {
         linked_list_iterator_t* next = linked_list_iterator_next(iterator);
-        free(iterator);
+        node_free(list, iterator);
         iterator = next;
     }
-    free(list);
+    if (list->pool != NULL) {
+        pool_free(list->pool, list);
+    } else {
+        free(list);
+    }
+}
+
+/* Links the chain first..last between prev and next, either of which may be NULL at the list ends. */
+static void link_chain(linked_list_t* list,
+                       linked_list_iterator_t* first,
+                       linked_list_iterator_t* last,
+                       linked_list_iterator_t* prev,
+                       linked_list_iterator_t* next) {
+    first->prev = prev;
+    last->next = next;
+    if (prev != NULL) {
+        prev->next = first;
+    } else {
+        list->head = first;
+    }
+    if (next != NULL) {
+        next->prev = last;
+    } else {
+        list->tail = last;
+    }
+}
+
+static void unlink_chain(linked_list_t* list, linked_list_iterator_t* first, linked_list_iterator_t* last) {
+    if (first->prev != NULL) {
+        first->prev->next = last->next;
+    } else {
+        list->head = last->next;
+    }
+    if (last->next != NULL) {
+        last->next->prev = first->prev;
+    } else {
+        list->tail = first->prev;
+    }
+}
+
+static linked_list_iterator_t* insert(linked_list_t* list,
+                                      linked_list_iterator_t* prev,
+                                      linked_list_iterator_t* next,
+                                      void* data) {
+    linked_list_iterator_t* iterator = node_alloc(list);
+    if (iterator == NULL) {
+        return NULL;
+    }
+    iterator->data = data;
+    link_chain(list, iterator, iterator, prev, next);
+    list->size++;
+    return iterator;
 }
 
 void linked_list_append(linked_list_t* list, void* data) {
     if (list == NULL) {
         return;
     }
-    linked_list_iterator_t* iterator = calloc(1, sizeof(linked_list_iterator_t));
-    if (iterator == NULL) {
-        return;
+    insert(list, list->tail, NULL, data);
+}
+
+linked_list_iterator_t* linked_list_insert_before(linked_list_t* list, linked_list_iterator_t* iterator, void* data) {
+    if (list == NULL) {
+        return NULL;
     }
-    iterator->data = data;
-    iterator->next = NULL;
-    iterator->prev = linked_list_iterator_end(list);
-    if (list->tail != NULL) {
-        list->tail->next = iterator;
+    return insert(list, (iterator != NULL ? iterator->prev : list->tail), iterator, data);
+}
+
+linked_list_iterator_t* linked_list_insert_after(linked_list_t* list, linked_list_iterator_t* iterator, void* data) {
+    if (list == NULL) {
+        return NULL;
+    }
+    return insert(list, iterator, (iterator != NULL ? iterator->next : list->head), data);
+}
+
+linked_list_iterator_t* linked_list_remove(linked_list_t* list, linked_list_iterator_t* iterator) {
+    if (list == NULL || iterator == NULL) {
+        return NULL;
+    }
+    linked_list_iterator_t* next = iterator->next;
+    unlink_chain(list, iterator, iterator);
+    list->size--;
+    node_free(list, iterator);
+    return next;
+}
+
+bool linked_list_splice(linked_list_t* list, linked_list_iterator_t* position, linked_list_t* other) {
+    if (list == NULL || other == NULL || list == other || list->pool != other->pool) {
+        return false;
     }
-    list->tail = iterator;
-    if (list->head == NULL) {
-        list->head = iterator;
+    if (other->head == NULL) {
+        return true;
     }
+    link_chain(list, other->head, other->tail, (position != NULL ? position->prev : list->tail), position);
+    list->size += other->size;
+    other->head = NULL;
+    other->tail = NULL;
+    other->size = 0;
+    return true;
+}
+
+bool linked_list_splice_range(linked_list_t* list,
+                              linked_list_iterator_t* position,
+                              linked_list_t* other,
+                              linked_list_iterator_t* first,
+                              linked_list_iterator_t* last) {
+    if (list == NULL || other == NULL || first == NULL || last == NULL || list->pool != other->pool) {
+        return false;
+    }
+    size_t count = 1;
+    for (linked_list_iterator_t* it = first; it != last; it = it->next) {
+        if (it == NULL || it == position) {
+            return false;
+        }
+        count++;
+    }
+    if (last == position) {
+        return false;
+    }
+    unlink_chain(other, first, last);
+    other->size -= count;
+    link_chain(list, first, last, (position != NULL ? position->prev : list->tail), position);
+    list->size += count;
+    return true;
+}
+
+size_t linked_list_size(const linked_list_t* list) {
+    return (list != NULL ? list->size : 0);
 }
 
 linked_list_iterator_t* linked_list_iterator_begin(linked_list_t* list) {
@@ -24,6 +24,7 @@
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -33,8 +34,74 @@
  * @{
  */
 
+/**
+ * @brief Size of a single pool block, a list node or a list header.
+ */
+#define LINKED_LIST_POOL_BLOCK_SIZE (4 * sizeof(void*))
+
+/**
+ * @brief Size of the pool bookkeeping placed at the start of a static arena.
+ */
+#define LINKED_LIST_POOL_HEADER_SIZE (8 * sizeof(void*))
+
+/**
+ * @brief Size of a static arena holding @p blocks list nodes and list headers.
+ */
+#define LINKED_LIST_POOL_ARENA_SIZE(blocks) (LINKED_LIST_POOL_HEADER_SIZE + (blocks) * LINKED_LIST_POOL_BLOCK_SIZE)
+
 typedef struct linked_list linked_list_t;
 typedef struct linked_list_iterator linked_list_iterator_t;
+typedef struct linked_list_pool linked_list_pool_t;
+
+/**
+ * @brief Iterate over a linked list, the current element may be removed.
+ * @param list A pointer to the linked list.
+ * @param iterator A linked_list_iterator_t pointer variable used as the cursor.
+ * @param next A linked_list_iterator_t pointer variable holding the next iterator.
+ */
+#define LINKED_LIST_FOR_EACH_SAFE(list, iterator, next)                                               \
+    for ((iterator) = linked_list_iterator_begin(list), (next) = linked_list_iterator_next(iterator); \
+         (iterator) != NULL;                                                                          \
+         (iterator) = (next), (next) = linked_list_iterator_next(iterator))
+
+typedef struct linked_list_pool_stats {
+    size_t capacity; /**< Number of blocks owned by the pool */
+    size_t in_use;   /**< Number of blocks handed out */
+    size_t peak;     /**< Maximum number of blocks handed out at once */
+    size_t slabs;    /**< Number of slabs allocated, 0 for a static arena */
+} linked_list_pool_stats_t;
+
+/**
+ * @brief Create a node pool in a caller supplied arena.
+ * @param arena A pointer to pointer aligned memory, it is used for the pool bookkeeping and its blocks.
+ * @param size The size of the arena, see LINKED_LIST_POOL_ARENA_SIZE().
+ * @return A pointer to the pool, placed in the arena.
+ * @return NULL if the arena is too small for a single block.
+ * @note The pool never allocates. Appending to a list fails silently once the arena is exhausted.
+ */
+linked_list_pool_t* linked_list_pool_create_static(void* arena, size_t size);
+
+/**
+ * @brief Create a node pool growing in slabs of contiguous blocks.
+ * @param blocks_per_slab The number of blocks allocated at once when the pool runs empty.
+ * @return A pointer to the newly created pool.
+ * @return NULL if the pool could not be created.
+ */
+linked_list_pool_t* linked_list_pool_create(size_t blocks_per_slab);
+
+/**
+ * @brief Destroy a node pool.
+ * @param pool A pointer to the pool.
+ * @note All lists using the pool must be destroyed first. The arena of a static pool is not touched.
+ */
+void linked_list_pool_destroy(linked_list_pool_t* pool);
+
+/**
+ * @brief Get node pool statistics.
+ * @param pool A pointer to the pool.
+ * @param stats A pointer to the statistics to fill.
+ */
+void linked_list_pool_get_stats(const linked_list_pool_t* pool, linked_list_pool_stats_t* stats);
 
 /**
  * @brief Create a new linked list.
@@ -45,6 +112,16 @@ typedef struct linked_list_iterator linked_list_iterator_t;
  */
 linked_list_t* linked_list_create(void);
 
+/**
+ * @brief Create a new linked list taking its header and nodes from a pool.
+ * @param pool A pointer to the node pool.
+ * @return A pointer to the newly created linked list.
+ * @return NULL if the pool is exhausted.
+ * @note Freed nodes go back to the pool and are reused. A pool is not thread safe, so all lists sharing
+ * it must be used from a single thread.
+ */
+linked_list_t* linked_list_create_with_pool(linked_list_pool_t* pool);
+
 /**
  * @brief Destroy a linked list.
  * @param list A pointer to the linked list to destroy.
@@ -59,6 +136,70 @@ void linked_list_destroy(linked_list_t* list);
  */
 void linked_list_append(linked_list_t* list, void* data);
 
+/**
+ * @brief Insert data before an element of a linked list.
+ * @param list A pointer to the linked list.
+ * @param iterator A pointer to the iterator of the element, NULL to append.
+ * @param data A pointer to the data to insert.
+ * @return A pointer to the iterator of the inserted element.
+ * @return NULL if the element could not be created.
+ */
+linked_list_iterator_t* linked_list_insert_before(linked_list_t* list, linked_list_iterator_t* iterator, void* data);
+
+/**
+ * @brief Insert data after an element of a linked list.
+ * @param list A pointer to the linked list.
+ * @param iterator A pointer to the iterator of the element, NULL to prepend.
+ * @param data A pointer to the data to insert.
+ * @return A pointer to the iterator of the inserted element.
+ * @return NULL if the element could not be created.
+ */
+linked_list_iterator_t* linked_list_insert_after(linked_list_t* list, linked_list_iterator_t* iterator, void* data);
+
+/**
+ * @brief Remove an element from a linked list in O(1).
+ * @param list A pointer to the linked list.
+ * @param iterator A pointer to the iterator of the element, it is freed.
+ * @return A pointer to the iterator of the following element.
+ * @return NULL if the removed element was the last one.
+ */
+linked_list_iterator_t* linked_list_remove(linked_list_t* list, linked_list_iterator_t* iterator);
+
+/**
+ * @brief Move all elements of another list before an element of a linked list in O(1).
+ * @param list A pointer to the destination linked list.
+ * @param position A pointer to the iterator of the element in @p list, NULL to append.
+ * @param other A pointer to the source linked list, it is left empty.
+ * @return true if the elements were moved.
+ * @return false if the lists are the same or use different node pools.
+ */
+bool linked_list_splice(linked_list_t* list, linked_list_iterator_t* position, linked_list_t* other);
+
+/**
+ * @brief Move a range of elements of another list before an element of a linked list.
+ *
+ * Relinking is O(1), counting the moved elements is O(range length).
+ * @param list A pointer to the destination linked list.
+ * @param position A pointer to the iterator of the element in @p list, NULL to append.
+ * @param other A pointer to the source linked list, may be @p list itself.
+ * @param first A pointer to the iterator of the first moved element.
+ * @param last A pointer to the iterator of the last moved element, reachable from @p first.
+ * @return true if the elements were moved.
+ * @return false if the range is invalid, contains @p position or the lists use different node pools.
+ */
+bool linked_list_splice_range(linked_list_t* list,
+                              linked_list_iterator_t* position,
+                              linked_list_t* other,
+                              linked_list_iterator_t* first,
+                              linked_list_iterator_t* last);
+
+/**
+ * @brief Get the number of elements in a linked list.
+ * @param list A pointer to the linked list.
+ * @return The number of elements, kept up to date so this is O(1).
+ */
+size_t linked_list_size(const linked_list_t* list);
+
 /**
  * @brief Get an iterator to the beginning of a linked list.
  * @param list A pointer to the linked list.
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "cmocka.h"
+#include "intrusive-list.h"
 
 static void test_create_linked_list(void** state) {
     (void)state;  // unused
@@ -102,12 +103,228 @@ static void test_list_iterate_reverse(void** state) {
     linked_list_destroy(list);
 }
 
+static void test_list_static_pool(void** state) {
+    (void)state;  // unused
+    static void* arena[LINKED_LIST_POOL_ARENA_SIZE(4) / sizeof(void*)];
+    linked_list_pool_t* pool = linked_list_pool_create_static(arena, sizeof(arena));
+    assert_non_null(pool);
+
+    linked_list_t* list = linked_list_create_with_pool(pool);
+    assert_non_null(list);
+    int elements[] = {1, 2, 3, 4};
+    for (size_t i = 0; i < 4; i++) {
+        linked_list_append(list, &elements[i]);
+    }
+    size_t count = 0;
+    for (linked_list_iterator_t* it = linked_list_iterator_begin(list); it; it = linked_list_iterator_next(it)) {
+        assert_int_equal(*(int*)linked_list_get(it), elements[count++]);
+    }
+    assert_int_equal(count, 3);
+
+    linked_list_pool_stats_t stats;
+    linked_list_pool_get_stats(pool, &stats);
+    assert_int_equal(stats.capacity, 4);
+    assert_int_equal(stats.in_use, 4);
+    assert_null(linked_list_create_with_pool(pool));
+
+    linked_list_destroy(list);
+    linked_list_pool_get_stats(pool, &stats);
+    assert_int_equal(stats.in_use, 0);
+    assert_int_equal(stats.peak, 4);
+    linked_list_pool_destroy(pool);
+}
+
+static void test_list_slab_pool(void** state) {
+    (void)state;  // unused
+    linked_list_pool_t* pool = linked_list_pool_create(8);
+    assert_non_null(pool);
+
+    int element = 7;
+    linked_list_t* lists[4];
+    for (size_t i = 0; i < 4; i++) {
+        lists[i] = linked_list_create_with_pool(pool);
+        assert_non_null(lists[i]);
+        for (size_t j = 0; j < 5; j++) {
+            linked_list_append(lists[i], &element);
+        }
+    }
+    linked_list_pool_stats_t stats;
+    linked_list_pool_get_stats(pool, &stats);
+    assert_int_equal(stats.in_use, 24);
+    assert_int_equal(stats.slabs, 3);
+
+    for (size_t i = 0; i < 4; i++) {
+        linked_list_destroy(lists[i]);
+    }
+    lists[0] = linked_list_create_with_pool(pool);
+    for (size_t j = 0; j < 20; j++) {
+        linked_list_append(lists[0], &element);
+    }
+    linked_list_pool_get_stats(pool, &stats);
+    assert_int_equal(stats.slabs, 3);
+    assert_int_equal(stats.in_use, 21);
+    linked_list_destroy(lists[0]);
+    linked_list_pool_destroy(pool);
+}
+
+typedef struct intrusive_element {
+    int value;
+    intrusive_list_node_t node;
+} intrusive_element_t;
+
+static void test_intrusive_list(void** state) {
+    (void)state;  // unused
+    intrusive_list_t list = INTRUSIVE_LIST_INIT(list);
+    assert_true(intrusive_list_is_empty(&list));
+    assert_null(intrusive_list_first(&list));
+
+    intrusive_element_t elements[5] = {0};
+    for (int i = 0; i < 5; i++) {
+        elements[i].value = i;
+        assert_false(intrusive_list_is_linked(&elements[i].node));
+    }
+    intrusive_list_push_back(&list, &elements[1].node);
+    intrusive_list_push_back(&list, &elements[2].node);
+    intrusive_list_push_back(&list, &elements[4].node);
+    intrusive_list_push_front(&list, &elements[0].node);
+    intrusive_list_link(&elements[3].node, &elements[2].node, &elements[4].node);
+
+    int expected = 0;
+    intrusive_list_node_t* node;
+    INTRUSIVE_LIST_FOR_EACH(&list, node) {
+        assert_int_equal(intrusive_list_entry(node, intrusive_element_t, node)->value, expected++);
+    }
+    assert_int_equal(expected, 5);
+
+    intrusive_list_node_t* next;
+    INTRUSIVE_LIST_FOR_EACH_SAFE(&list, node, next) {
+        if (intrusive_list_entry(node, intrusive_element_t, node)->value % 2 == 0) {
+            intrusive_list_remove(node);
+        }
+    }
+    assert_false(intrusive_list_is_linked(&elements[0].node));
+    node = intrusive_list_first(&list);
+    assert_ptr_equal(node, &elements[1].node);
+    node = intrusive_list_next(&list, node);
+    assert_ptr_equal(node, &elements[3].node);
+    assert_null(intrusive_list_next(&list, node));
+
+    intrusive_list_remove(&elements[1].node);
+    intrusive_list_remove(&elements[3].node);
+    assert_true(intrusive_list_is_empty(&list));
+}
+
+static void assert_list_equal(linked_list_t* list, const int* expected, size_t count) {
+    assert_int_equal(linked_list_size(list), count);
+    linked_list_iterator_t* it = linked_list_iterator_begin(list);
+    for (size_t i = 0; i < count; i++) {
+        assert_ptr_not_equal(it, NULL);
+        assert_int_equal(*(int*)linked_list_get(it), expected[i]);
+        it = linked_list_iterator_next(it);
+    }
+    assert_ptr_equal(it, NULL);
+    it = linked_list_iterator_end(list);
+    for (size_t i = count; i > 0; i--) {
+        assert_int_equal(*(int*)linked_list_get(it), expected[i - 1]);
+        it = linked_list_iterator_prev(it);
+    }
+    assert_ptr_equal(it, NULL);
+}
+
+static void test_list_remove(void** state) {
+    (void)state;  // unused
+    linked_list_t* list = linked_list_create();
+    int elements[] = {1, 2, 3, 4, 5};
+    for (int i = 0; i < 5; i++) {
+        linked_list_append(list, &elements[i]);
+    }
+
+    linked_list_iterator_t* it = NULL;
+    linked_list_iterator_t* next = NULL;
+    LINKED_LIST_FOR_EACH_SAFE(list, it, next) {
+        if (*(int*)linked_list_get(it) % 2 == 0) {
+            assert_ptr_equal(linked_list_remove(list, it), next);
+        }
+    }
+    assert_list_equal(list, (int[]){1, 3, 5}, 3);
+
+    assert_ptr_equal(linked_list_remove(list, linked_list_iterator_end(list)), NULL);
+    linked_list_remove(list, linked_list_iterator_begin(list));
+    assert_list_equal(list, (int[]){3}, 1);
+    linked_list_remove(list, linked_list_iterator_begin(list));
+    assert_list_equal(list, NULL, 0);
+
+    linked_list_destroy(list);
+}
+
+static void test_list_insert(void** state) {
+    (void)state;  // unused
+    linked_list_t* list = linked_list_create();
+    int elements[] = {1, 2, 3, 4, 5};
+    linked_list_iterator_t* three = linked_list_insert_before(list, NULL, &elements[2]);
+    linked_list_insert_after(list, NULL, &elements[0]);
+    linked_list_insert_before(list, three, &elements[1]);
+    linked_list_iterator_t* four = linked_list_insert_after(list, three, &elements[3]);
+    linked_list_insert_after(list, four, &elements[4]);
+    assert_list_equal(list, elements, 5);
+    linked_list_destroy(list);
+}
+
+static void test_list_splice(void** state) {
+    (void)state;  // unused
+    int elements[] = {1, 2, 3, 4, 5, 6};
+    linked_list_t* list = linked_list_create();
+    linked_list_t* other = linked_list_create();
+    linked_list_append(list, &elements[0]);
+    linked_list_append(list, &elements[4]);
+    linked_list_append(other, &elements[1]);
+    linked_list_append(other, &elements[2]);
+    linked_list_append(other, &elements[3]);
+
+    assert_true(linked_list_splice(list, linked_list_iterator_end(list), other));
+    assert_list_equal(list, (int[]){1, 2, 3, 4, 5}, 5);
+    assert_list_equal(other, NULL, 0);
+    assert_false(linked_list_splice(list, NULL, list));
+
+    linked_list_append(other, &elements[5]);
+    assert_true(linked_list_splice(list, NULL, other));
+    assert_list_equal(list, elements, 6);
+
+    /* Move 2..4 to the other list, then 5..6 to the front of the same list. */
+    linked_list_iterator_t* two = linked_list_iterator_next(linked_list_iterator_begin(list));
+    linked_list_iterator_t* four = linked_list_iterator_next(linked_list_iterator_next(two));
+    assert_true(linked_list_splice_range(other, NULL, list, two, four));
+    assert_list_equal(list, (int[]){1, 5, 6}, 3);
+    assert_list_equal(other, (int[]){2, 3, 4}, 3);
+
+    linked_list_iterator_t* five = linked_list_iterator_next(linked_list_iterator_begin(list));
+    assert_false(linked_list_splice_range(list, five, list, five, linked_list_iterator_end(list)));
+    assert_true(
+        linked_list_splice_range(list, linked_list_iterator_begin(list), list, five, linked_list_iterator_end(list)));
+    assert_list_equal(list, (int[]){5, 6, 1}, 3);
+
+    linked_list_pool_t* pool = linked_list_pool_create(4);
+    linked_list_t* pooled = linked_list_create_with_pool(pool);
+    assert_false(linked_list_splice(pooled, NULL, other));
+    linked_list_destroy(pooled);
+    linked_list_pool_destroy(pool);
+
+    linked_list_destroy(other);
+    linked_list_destroy(list);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_create_linked_list),
         cmocka_unit_test(test_list_append),
         cmocka_unit_test(test_list_iterate),
         cmocka_unit_test(test_list_iterate_reverse),
+        cmocka_unit_test(test_list_static_pool),
+        cmocka_unit_test(test_list_slab_pool),
+        cmocka_unit_test(test_intrusive_list),
+        cmocka_unit_test(test_list_remove),
+        cmocka_unit_test(test_list_insert),
+        cmocka_unit_test(test_list_splice),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -23,7 +23,7 @@
  */
 #include "modbus.h"
 #include <stdlib.h>
-#include "linked-list.h"
+#include "typed-vector.h"
 
 #define MODBUS_FUNCTION_READ_HOLDING_REGISTERS (0x03)
 #define MODBUS_FUNCTION_WRITE_MULTIPLE_REGISTERS (0x10)
@@ -42,10 +42,12 @@ typedef struct modbus_register {
     modbus_register_cb_t write_cb;
 } modbus_register_t;
 
+TYPED_VECTOR_DEFINE(modbus_register_vector, modbus_register_t)
+
 typedef struct modbus {
     uint8_t slave_address;
     modbus_respond_cb_t respond_cb;
-    linked_list_t* registers;
+    modbus_register_vector_t registers;
     size_t max_stream_registers;
     uint16_t* stream_registers;
     uint8_t* response_frame;
@@ -100,9 +102,8 @@ static void send_write_acknowledge(modbus_t* modbus, uint8_t function_code, uint
 }
 
 static void process_modbus_read_holdings_registers(modbus_t* modbus, uint16_t address, size_t count) {
-    for (linked_list_iterator_t* it = linked_list_iterator_begin(modbus->registers); it;
-         it = linked_list_iterator_next(it)) {
-        modbus_register_t* reg = linked_list_get(it);
+    modbus_register_t* reg;
+    TYPED_VECTOR_FOR_EACH(&modbus->registers, reg) {
         if ((address >= reg->address) && (address < reg->address + reg->range) &&
             (address + count <= reg->address + reg->range) && (reg->read_cb != NULL)) {
             for (size_t i = 0; i < count; i++) {
@@ -124,9 +125,8 @@ static void process_modbus_write_holding_registers(modbus_t* modbus,
                                                    uint16_t address,
                                                    size_t count,
                                                    const uint8_t* payload) {
-    for (linked_list_iterator_t* it = linked_list_iterator_begin(modbus->registers); it;
-         it = linked_list_iterator_next(it)) {
-        modbus_register_t* reg = linked_list_get(it);
+    modbus_register_t* reg;
+    TYPED_VECTOR_FOR_EACH(&modbus->registers, reg) {
         if ((address >= reg->address) && (address < reg->address + reg->range) &&
             (address + count <= reg->address + reg->range) && (reg->write_cb != NULL)) {
             for (size_t i = 0; i < count; i++) {
@@ -148,21 +148,15 @@ modbus_t* modbus_create(uint8_t slave_address, modbus_respond_cb_t respond_cb, s
     if (!modbus) {
         return NULL;
     }
-    modbus->registers = linked_list_create();
-    if (!modbus->registers) {
-        free(modbus);
-        return NULL;
-    }
+    modbus_register_vector_init(&modbus->registers);
     modbus->stream_registers = calloc(max_stream_registers, sizeof(modbus->stream_registers[0]));
     if (!modbus->stream_registers) {
-        linked_list_destroy(modbus->registers);
         free(modbus);
         return NULL;
     }
     modbus->response_frame = calloc(max_stream_registers * 2 + 7, sizeof(modbus->response_frame[0]));
     if (!modbus->response_frame) {
         free(modbus->stream_registers);
-        linked_list_destroy(modbus->registers);
         free(modbus);
         return NULL;
     }
@@ -178,7 +172,7 @@ void modbus_destroy(modbus_t* modbus) {
     }
     free(modbus->response_frame);
     free(modbus->stream_registers);
-    linked_list_destroy(modbus->registers);
+    modbus_register_vector_free(&modbus->registers);
     free(modbus);
 }
 
@@ -190,15 +184,8 @@ void modbus_register(modbus_t* modbus,
     if (!modbus || range == 0 || (read_cb == NULL && write_cb == NULL)) {
         return;
     }
-    modbus_register_t* reg = calloc(1, sizeof(modbus_register_t));
-    if (!reg) {
-        return;
-    }
-    reg->address = address;
-    reg->range = range;
-    reg->read_cb = read_cb;
-    reg->write_cb = write_cb;
-    linked_list_append(modbus->registers, reg);
+    modbus_register_t reg = {.address = address, .range = range, .read_cb = read_cb, .write_cb = write_cb};
+    modbus_register_vector_push(&modbus->registers, reg);
 }
 
 void modbus_process(modbus_t* modbus, const uint8_t* modbus_frame, size_t frame_length) {
@@ -24,19 +24,105 @@
 #include "modbus.h"
 #include <setjmp.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "cmocka.h"
 
-static void empty_test(void** state) {
-    (void)state;
+#define TEST_SLAVE_ADDRESS (0x11)
+
+static uint8_t response[64];
+static size_t response_length;
+static uint16_t registers[16];
+
+static uint16_t crc16(const uint8_t* buffer, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t pos = 0; pos < length; pos++) {
+        crc ^= buffer[pos];
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+static void respond(const uint8_t* data, size_t length) {
+    memcpy(response, data, length);
+    response_length = length;
+}
+
+static bool read_register(uint16_t address, uint16_t* value) {
+    *value = registers[address - 0x100];
+    return true;
+}
+
+static bool write_register(uint16_t address, uint16_t* value) {
+    registers[address - 0x100] = *value;
+    return true;
+}
+
+static void process(modbus_t* modbus, uint8_t* frame, size_t length) {
+    uint16_t crc = crc16(frame, length - 2);
+    frame[length - 2] = crc & 0xff;
+    frame[length - 1] = crc >> 8;
+    response_length = 0;
+    modbus_process(modbus, frame, length);
+}
+
+static void test_read_holding_registers(void** state) {
+    (void)state;  // unused
+    modbus_t* modbus = modbus_create(TEST_SLAVE_ADDRESS, respond, 8);
+    assert_non_null(modbus);
+    modbus_register(modbus, 0x100, 4, read_register, NULL);
+    modbus_register(modbus, 0x104, 4, read_register, write_register);
+    for (uint16_t i = 0; i < 8; i++) {
+        registers[i] = 0x1000 + i;
+    }
+
+    uint8_t frame[] = {TEST_SLAVE_ADDRESS, 0x03, 0x01, 0x05, 0x00, 0x02, 0, 0};
+    process(modbus, frame, sizeof(frame));
+    assert_int_equal(response_length, 9);
+    uint8_t expected[] = {TEST_SLAVE_ADDRESS, 0x03, 4, 0x10, 0x05, 0x10, 0x06};
+    assert_memory_equal(response, expected, sizeof(expected));
+    assert_int_equal(crc16(response, response_length), 0);
+
+    /* A read crossing two registrations is not served. */
+    frame[3] = 0x03;
+    process(modbus, frame, sizeof(frame));
+    assert_int_equal(response_length, 5);
+    assert_int_equal(response[1], 0x83);
+    assert_int_equal(response[2], 0x02);
+
+    modbus_destroy(modbus);
+}
+
+static void test_write_multiple_registers(void** state) {
+    (void)state;  // unused
+    modbus_t* modbus = modbus_create(TEST_SLAVE_ADDRESS, respond, 8);
+    assert_non_null(modbus);
+    modbus_register(modbus, 0x100, 4, read_register, NULL);
+    modbus_register(modbus, 0x104, 4, read_register, write_register);
+
+    uint8_t frame[] = {TEST_SLAVE_ADDRESS, 0x10, 0x01, 0x06, 0x00, 0x01, 2, 0xBE, 0xEF, 0, 0};
+    process(modbus, frame, sizeof(frame));
+    assert_int_equal(response_length, 8);
+    assert_memory_equal(response, frame, 6);
+    assert_int_equal(registers[6], 0xBEEF);
+
+    frame[3] = 0x02;
+    process(modbus, frame, sizeof(frame));
+    assert_int_equal(response[1], 0x90);
+
+    modbus_destroy(modbus);
 }
 
 int main(void) {
     const struct CMUnitTest tests[] = {
-        cmocka_unit_test(empty_test),
+        cmocka_unit_test(test_read_holding_registers),
+        cmocka_unit_test(test_write_multiple_registers),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,358 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "timer-wheel.h"
+#include <stdlib.h>
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+#define TIMER_WHEEL_LEVELS (4)
+#define TIMER_WHEEL_SLOT_BITS (8)
+#define TIMER_WHEEL_SLOTS (1u << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LISTS (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1)
+#define TIMER_WHEEL_EXPIRED_LIST (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)
+#define TIMER_WHEEL_NO_LIST (UINT16_MAX)
+#define TIMER_WHEEL_NIL (UINT32_MAX)
+#define TIMER_WHEEL_INDEX_BITS (20)
+#define TIMER_WHEEL_INDEX_MASK ((1u << TIMER_WHEEL_INDEX_BITS) - 1)
+
+typedef struct timer_wheel_entry {
+    uint64_t expires;
+    uint32_t period;
+    uint32_t next;
+    uint32_t prev;
+    uint16_t list;
+    uint16_t id;
+    uint32_t generation;
+    void* payload;
+    size_t size;
+} timer_wheel_entry_t;
+
+/**
+ * Timers live in one preallocated array and are linked by index into the slot lists.
+ * The extra list collects the timers expiring in the tick being processed.
+ */
+typedef struct timer_wheel {
+    event_handler_t* handler;
+    timer_wheel_delivery_t delivery;
+    uint64_t now;
+    size_t active;
+    size_t dropped;
+    size_t max_timers;
+    timer_wheel_entry_t* timers;
+    uint32_t free_list;
+    uint32_t lists[TIMER_WHEEL_LISTS];
+#if defined(__linux__)
+    int timerfd;
+#endif
+} timer_wheel_t;
+
+static void list_push(timer_wheel_t* wheel, uint16_t list, uint32_t index) {
+    timer_wheel_entry_t* timer = &wheel->timers[index];
+    timer->list = list;
+    timer->prev = TIMER_WHEEL_NIL;
+    timer->next = wheel->lists[list];
+    if (timer->next != TIMER_WHEEL_NIL) {
+        wheel->timers[timer->next].prev = index;
+    }
+    wheel->lists[list] = index;
+}
+
+static void list_unlink(timer_wheel_t* wheel, uint32_t index) {
+    timer_wheel_entry_t* timer = &wheel->timers[index];
+    if (timer->prev != TIMER_WHEEL_NIL) {
+        wheel->timers[timer->prev].next = timer->next;
+    } else {
+        wheel->lists[timer->list] = timer->next;
+    }
+    if (timer->next != TIMER_WHEEL_NIL) {
+        wheel->timers[timer->next].prev = timer->prev;
+    }
+    timer->list = TIMER_WHEEL_NO_LIST;
+}
+
+static void place_timer(timer_wheel_t* wheel, uint32_t index) {
+    uint64_t expires = wheel->timers[index].expires;
+    uint64_t delta = expires - wheel->now;
+    unsigned level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1ull << ((level + 1) * TIMER_WHEEL_SLOT_BITS))) {
+        level++;
+    }
+    uint16_t slot = (expires >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+    list_push(wheel, level * TIMER_WHEEL_SLOTS + slot, index);
+}
+
+static void release_timer(timer_wheel_t* wheel, uint32_t index) {
+    timer_wheel_entry_t* timer = &wheel->timers[index];
+    timer->generation++;
+    timer->list = TIMER_WHEEL_NO_LIST;
+    timer->next = wheel->free_list;
+    wheel->free_list = index;
+    wheel->active--;
+}
+
+static uint32_t get_index(timer_wheel_t* wheel, timer_wheel_timer_t timer) {
+    uint32_t index = (timer & TIMER_WHEEL_INDEX_MASK);
+    if (index == 0 || index > wheel->max_timers) {
+        return TIMER_WHEEL_NIL;
+    }
+    index--;
+    uint32_t generation = (timer >> TIMER_WHEEL_INDEX_BITS);
+    timer_wheel_entry_t* entry = &wheel->timers[index];
+    if (entry->list == TIMER_WHEEL_NO_LIST ||
+        (entry->generation & (UINT32_MAX >> TIMER_WHEEL_INDEX_BITS)) != generation) {
+        return TIMER_WHEEL_NIL;
+    }
+    return index;
+}
+
+/**
+ * Move all timers of a slot one level down, relative to the current time.
+ */
+static void cascade(timer_wheel_t* wheel, unsigned level) {
+    uint16_t slot = (wheel->now >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+    uint16_t list = level * TIMER_WHEEL_SLOTS + slot;
+    uint32_t index = wheel->lists[list];
+    wheel->lists[list] = TIMER_WHEEL_NIL;
+    while (index != TIMER_WHEEL_NIL) {
+        uint32_t next = wheel->timers[index].next;
+        place_timer(wheel, index);
+        index = next;
+    }
+}
+
+/* Returns false if the event could not be queued, a sent event counts as delivered even without a handler. */
+static bool deliver(timer_wheel_t* wheel, timer_wheel_entry_t* timer) {
+    if (wheel->delivery == TIMER_WHEEL_DELIVERY_POST) {
+        return event_handler_post(wheel->handler, timer->id, timer->payload, timer->size);
+    }
+    event_handler_send(wheel->handler, timer->id, timer->payload, timer->size);
+    return true;
+}
+
+static size_t process_tick(timer_wheel_t* wheel) {
+    wheel->now++;
+    for (unsigned level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        if ((wheel->now & ((1ull << (level * TIMER_WHEEL_SLOT_BITS)) - 1)) != 0) {
+            break;
+        }
+        cascade(wheel, level);
+    }
+    uint16_t slot = wheel->now & TIMER_WHEEL_SLOT_MASK;
+    wheel->lists[TIMER_WHEEL_EXPIRED_LIST] = wheel->lists[slot];
+    wheel->lists[slot] = TIMER_WHEEL_NIL;
+    for (uint32_t index = wheel->lists[TIMER_WHEEL_EXPIRED_LIST]; index != TIMER_WHEEL_NIL;
+         index = wheel->timers[index].next) {
+        wheel->timers[index].list = TIMER_WHEEL_EXPIRED_LIST;
+    }
+
+    size_t delivered = 0;
+    while (wheel->lists[TIMER_WHEEL_EXPIRED_LIST] != TIMER_WHEEL_NIL) {
+        uint32_t index = wheel->lists[TIMER_WHEEL_EXPIRED_LIST];
+        timer_wheel_entry_t* timer = &wheel->timers[index];
+        list_unlink(wheel, index);
+        timer_wheel_entry_t expired = *timer;
+        if (timer->period > 0) {
+            timer->expires += timer->period;
+            place_timer(wheel, index);
+        } else {
+            release_timer(wheel, index);
+        }
+        /* The handler may arm or cancel timers, including the ones still waiting in the expired list. */
+        if (deliver(wheel, &expired)) {
+            delivered++;
+        } else {
+            wheel->dropped++;
+        }
+    }
+    return delivered;
+}
+
+timer_wheel_t* timer_wheel_create(const timer_wheel_config_t* config) {
+    if (!config || !config->handler || config->max_timers == 0 || config->max_timers > TIMER_WHEEL_MAX_TIMERS) {
+        return NULL;
+    }
+    timer_wheel_t* wheel = calloc(1, sizeof(timer_wheel_t));
+    if (!wheel) {
+        return NULL;
+    }
+    wheel->timers = calloc(config->max_timers, sizeof(timer_wheel_entry_t));
+    if (!wheel->timers) {
+        free(wheel);
+        return NULL;
+    }
+    wheel->handler = config->handler;
+    wheel->delivery = config->delivery;
+    wheel->max_timers = config->max_timers;
+    for (size_t i = 0; i < TIMER_WHEEL_LISTS; i++) {
+        wheel->lists[i] = TIMER_WHEEL_NIL;
+    }
+    wheel->free_list = TIMER_WHEEL_NIL;
+    for (size_t i = config->max_timers; i > 0; i--) {
+        wheel->timers[i - 1].list = TIMER_WHEEL_NO_LIST;
+        wheel->timers[i - 1].next = wheel->free_list;
+        wheel->free_list = (uint32_t)(i - 1);
+    }
+#if defined(__linux__)
+    wheel->timerfd = -1;
+#endif
+    return wheel;
+}
+
+void timer_wheel_destroy(timer_wheel_t* wheel) {
+    if (!wheel) {
+        return;
+    }
+#if defined(__linux__)
+    timer_wheel_timerfd_stop(wheel);
+#endif
+    free(wheel->timers);
+    free(wheel);
+}
+
+timer_wheel_timer_t timer_wheel_arm(timer_wheel_t* wheel,
+                                    uint16_t id,
+                                    uint32_t delay,
+                                    uint32_t period,
+                                    void* payload,
+                                    size_t size) {
+    if (!wheel || wheel->free_list == TIMER_WHEEL_NIL) {
+        return TIMER_WHEEL_INVALID_TIMER;
+    }
+    uint32_t index = wheel->free_list;
+    timer_wheel_entry_t* timer = &wheel->timers[index];
+    wheel->free_list = timer->next;
+    wheel->active++;
+    timer->expires = wheel->now + (delay ? delay : 1);
+    timer->period = period;
+    timer->id = id;
+    timer->payload = payload;
+    timer->size = size;
+    place_timer(wheel, index);
+    uint32_t generation = timer->generation & (UINT32_MAX >> TIMER_WHEEL_INDEX_BITS);
+    return (generation << TIMER_WHEEL_INDEX_BITS) | (index + 1);
+}
+
+bool timer_wheel_cancel(timer_wheel_t* wheel, timer_wheel_timer_t timer) {
+    if (!wheel) {
+        return false;
+    }
+    uint32_t index = get_index(wheel, timer);
+    if (index == TIMER_WHEEL_NIL) {
+        return false;
+    }
+    list_unlink(wheel, index);
+    release_timer(wheel, index);
+    return true;
+}
+
+size_t timer_wheel_tick(timer_wheel_t* wheel, uint32_t ticks) {
+    if (!wheel) {
+        return 0;
+    }
+    size_t delivered = 0;
+    for (uint32_t i = 0; i < ticks; i++) {
+        if (wheel->active == 0) {
+            wheel->now += ticks - i;
+            break;
+        }
+        delivered += process_tick(wheel);
+    }
+    return delivered;
+}
+
+uint64_t timer_wheel_now(timer_wheel_t* wheel) {
+    if (!wheel) {
+        return 0;
+    }
+    return wheel->now;
+}
+
+size_t timer_wheel_active(timer_wheel_t* wheel) {
+    if (!wheel) {
+        return 0;
+    }
+    return wheel->active;
+}
+
+size_t timer_wheel_dropped(timer_wheel_t* wheel) {
+    if (!wheel) {
+        return 0;
+    }
+    return wheel->dropped;
+}
+
+#if defined(__linux__)
+int timer_wheel_timerfd_start(timer_wheel_t* wheel, uint64_t tick_period_ns) {
+    if (!wheel || tick_period_ns == 0) {
+        return -1;
+    }
+    timer_wheel_timerfd_stop(wheel);
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct itimerspec spec = {
+        .it_interval = {.tv_sec = tick_period_ns / 1000000000u, .tv_nsec = tick_period_ns % 1000000000u},
+        .it_value = {.tv_sec = tick_period_ns / 1000000000u, .tv_nsec = tick_period_ns % 1000000000u},
+    };
+    if (timerfd_settime(fd, 0, &spec, NULL) != 0) {
+        close(fd);
+        return -1;
+    }
+    wheel->timerfd = fd;
+    return fd;
+}
+
+size_t timer_wheel_timerfd_process(timer_wheel_t* wheel) {
+    if (!wheel || wheel->timerfd < 0) {
+        return 0;
+    }
+    uint64_t expirations = 0;
+    ssize_t result;
+    do {
+        result = read(wheel->timerfd, &expirations, sizeof(expirations));
+    } while (result < 0 && errno == EINTR);
+    if (result != sizeof(expirations)) {
+        return 0;
+    }
+    size_t delivered = 0;
+    while (expirations > UINT32_MAX) {
+        delivered += timer_wheel_tick(wheel, UINT32_MAX);
+        expirations -= UINT32_MAX;
+    }
+    return delivered + timer_wheel_tick(wheel, (uint32_t)expirations);
+}
+
+void timer_wheel_timerfd_stop(timer_wheel_t* wheel) {
+    if (!wheel || wheel->timerfd < 0) {
+        return;
+    }
+    close(wheel->timerfd);
+    wheel->timerfd = -1;
+}
+#endif
@@ -0,0 +1,178 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "event-handler.h"
+
+/**
+ * @defgroup timer-wheel Timer wheel
+ *
+ * @brief Hierarchical timer wheel delivering expirations as events.
+ *
+ * Timers are kept in 4 levels of 256 slots each, so arming and cancelling a timer is O(1) and a tick only
+ * touches the timers which expire (or are cascaded) in it. Delays are counted in ticks, up to 2^32 - 1.
+ * @{
+ */
+#define TIMER_WHEEL_INVALID_TIMER 0 /**< Timer identifier returned when arming failed */
+#define TIMER_WHEEL_MAX_TIMERS ((1u << 20) - 1) /**< Maximum number of concurrent timers */
+
+typedef struct timer_wheel timer_wheel_t;
+
+/**
+ * @brief Timer identifier
+ *
+ * Identifiers are never reused right away, so cancelling an already expired timer is safe.
+ */
+typedef uint32_t timer_wheel_timer_t;
+
+/**
+ * @brief How expired timers are delivered to the event handler
+ */
+typedef enum timer_wheel_delivery {
+    TIMER_WHEEL_DELIVERY_SEND = 0, /**< Call event_handler_send() from within the tick */
+    TIMER_WHEEL_DELIVERY_POST,     /**< Call event_handler_post() to queue a copy of the payload */
+} timer_wheel_delivery_t;
+
+typedef struct timer_wheel_config {
+    event_handler_t* handler;        /**< Event handler receiving the timer events */
+    size_t max_timers;               /**< Maximum number of concurrently armed timers */
+    timer_wheel_delivery_t delivery; /**< Delivery mode of expired timers */
+} timer_wheel_config_t; /**< Timer wheel configuration structure definition */
+
+/**
+ * @brief Create a timer wheel
+ *
+ * All timer storage is allocated at creation.
+ * @param[in] config pointer to configuration structure
+ * @return pointer to the timer wheel
+ * @return NULL in case of errors
+ */
+timer_wheel_t* timer_wheel_create(const timer_wheel_config_t* config);
+
+/**
+ * @brief Destroy a timer wheel
+ * @param[in] wheel pointer to the timer wheel
+ */
+void timer_wheel_destroy(timer_wheel_t* wheel);
+
+/**
+ * @brief Arm a timer
+ *
+ * When the timer expires, an event with @p id and the given payload is delivered to the event handler.
+ * @param[in] wheel pointer to the timer wheel
+ * @param[in] id event ID delivered on expiration
+ * @param[in] delay number of ticks until the first expiration, 0 is treated as 1
+ * @param[in] period number of ticks between following expirations, 0 for a one-shot timer
+ * @param[in] payload pointer to the payload, must stay valid while the timer is armed
+ * @param[in] size size of the payload
+ * @return identifier of the armed timer
+ * @return TIMER_WHEEL_INVALID_TIMER if no timer is available
+ */
+timer_wheel_timer_t timer_wheel_arm(timer_wheel_t* wheel,
+                                    uint16_t id,
+                                    uint32_t delay,
+                                    uint32_t period,
+                                    void* payload,
+                                    size_t size);
+
+/**
+ * @brief Cancel an armed timer
+ * @param[in] wheel pointer to the timer wheel
+ * @param[in] timer timer identifier returned by timer_wheel_arm()
+ * @return true if the timer was armed and is now cancelled
+ * @return false if the timer already expired or was cancelled before
+ */
+bool timer_wheel_cancel(timer_wheel_t* wheel, timer_wheel_timer_t timer);
+
+/**
+ * @brief Advance the timer wheel
+ *
+ * Expired timers are delivered in the caller context, in expiration order. An expiration which could not be
+ * posted is dropped and counted by timer_wheel_dropped(), it is not retried: a one-shot timer is released
+ * anyway, a periodic timer stays armed for its next period.
+ * @param[in] wheel pointer to the timer wheel
+ * @param[in] ticks number of elapsed ticks
+ * @return number of delivered timer events
+ */
+size_t timer_wheel_tick(timer_wheel_t* wheel, uint32_t ticks);
+
+/**
+ * @brief Get the current time of the timer wheel
+ * @param[in] wheel pointer to the timer wheel
+ * @return number of ticks processed since creation
+ */
+uint64_t timer_wheel_now(timer_wheel_t* wheel);
+
+/**
+ * @brief Get the number of armed timers
+ * @param[in] wheel pointer to the timer wheel
+ * @return number of armed timers
+ */
+size_t timer_wheel_active(timer_wheel_t* wheel);
+
+/**
+ * @brief Get the number of dropped expirations
+ *
+ * Only the TIMER_WHEEL_DELIVERY_POST mode drops expirations, when the event handler queue is full.
+ * @param[in] wheel pointer to the timer wheel
+ * @return number of expirations not delivered since creation
+ */
+size_t timer_wheel_dropped(timer_wheel_t* wheel);
+
+#if defined(__linux__)
+/**
+ * @brief Drive the timer wheel from a Linux timerfd
+ *
+ * The returned descriptor becomes readable on every tick and may be watched with poll() or epoll.
+ * Call timer_wheel_timerfd_process() when it is readable.
+ * @param[in] wheel pointer to the timer wheel
+ * @param[in] tick_period_ns tick period in nanoseconds
+ * @return timerfd file descriptor
+ * @return -1 in case of errors
+ */
+int timer_wheel_timerfd_start(timer_wheel_t* wheel, uint64_t tick_period_ns);
+
+/**
+ * @brief Advance the timer wheel by the ticks elapsed on its timerfd
+ * @param[in] wheel pointer to the timer wheel
+ * @return number of delivered timer events, without the dropped ones
+ */
+size_t timer_wheel_timerfd_process(timer_wheel_t* wheel);
+
+/**
+ * @brief Stop and close the timerfd of the timer wheel
+ * @param[in] wheel pointer to the timer wheel
+ */
+void timer_wheel_timerfd_stop(timer_wheel_t* wheel);
+#endif
+
+/**
+ * @}
+ */
+
+#endif  // TIMER_WHEEL_H
@@ -0,0 +1,282 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "timer-wheel.h"
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cmocka.h"
+
+#define TIMER_EVENT_ID 1
+
+typedef struct timer_expectation {
+    timer_wheel_t* wheel;
+    uint64_t expected_tick;
+    uint32_t period;
+    size_t fired;
+    size_t errors;
+} timer_expectation_t;
+
+static void expiration_handler(event_handler_t* handler, uint16_t id, void* context, void* payload, size_t size) {
+    (void)handler;
+    (void)context;
+    (void)id;
+    (void)size;
+    timer_expectation_t* expectation = payload;
+    if (timer_wheel_now(expectation->wheel) != expectation->expected_tick) {
+        expectation->errors++;
+    }
+    expectation->expected_tick += expectation->period;
+    expectation->fired++;
+}
+
+static void posted_expiration_handler(event_handler_t* handler,
+                                      uint16_t id,
+                                      void* context,
+                                      void* payload,
+                                      size_t size) {
+    assert_int_equal(size, sizeof(timer_expectation_t*));
+    timer_expectation_t* expectation;
+    memcpy(&expectation, payload, sizeof(expectation));
+    expiration_handler(handler, id, context, expectation, sizeof(*expectation));
+}
+
+static event_handler_t* create_handler(void) {
+    event_handler_t* handler = event_handler_create();
+    assert_non_null(handler);
+    assert_true(event_handler_register(handler, TIMER_EVENT_ID, NULL, expiration_handler));
+    return handler;
+}
+
+static void test_create_timer_wheel(void** state) {
+    (void)state;  // unused
+    assert_null(timer_wheel_create(NULL));
+    timer_wheel_config_t config = {.handler = NULL, .max_timers = 1};
+    assert_null(timer_wheel_create(&config));
+    event_handler_t* handler = create_handler();
+    config.handler = handler;
+    timer_wheel_t* wheel = timer_wheel_create(&config);
+    assert_non_null(wheel);
+    assert_int_equal(timer_wheel_now(wheel), 0);
+    assert_int_equal(timer_wheel_active(wheel), 0);
+    timer_wheel_destroy(wheel);
+    event_handler_destroy(handler);
+}
+
+static void test_one_shot_timer(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = create_handler();
+    timer_wheel_config_t config = {.handler = handler, .max_timers = 1};
+    timer_wheel_t* wheel = timer_wheel_create(&config);
+
+    timer_expectation_t expectation = {.wheel = wheel, .expected_tick = 10};
+    timer_wheel_timer_t timer =
+        timer_wheel_arm(wheel, TIMER_EVENT_ID, 10, 0, &expectation, sizeof(expectation));
+    assert_int_not_equal(timer, TIMER_WHEEL_INVALID_TIMER);
+    assert_int_equal(timer_wheel_arm(wheel, TIMER_EVENT_ID, 10, 0, NULL, 0), TIMER_WHEEL_INVALID_TIMER);
+    assert_int_equal(timer_wheel_tick(wheel, 9), 0);
+    assert_int_equal(timer_wheel_tick(wheel, 1), 1);
+    assert_int_equal(expectation.fired, 1);
+    assert_int_equal(expectation.errors, 0);
+    assert_int_equal(timer_wheel_active(wheel), 0);
+    assert_false(timer_wheel_cancel(wheel, timer));
+    assert_int_equal(timer_wheel_tick(wheel, 1000), 0);
+    assert_int_equal(timer_wheel_now(wheel), 1010);
+
+    timer_wheel_destroy(wheel);
+    event_handler_destroy(handler);
+}
+
+static void test_periodic_timer_and_cancel(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = create_handler();
+    timer_wheel_config_t config = {.handler = handler, .max_timers = 2};
+    timer_wheel_t* wheel = timer_wheel_create(&config);
+
+    timer_expectation_t periodic = {.wheel = wheel, .expected_tick = 5, .period = 300};
+    timer_expectation_t cancelled = {.wheel = wheel, .expected_tick = 7};
+    timer_wheel_timer_t periodic_timer = timer_wheel_arm(wheel, TIMER_EVENT_ID, 5, 300, &periodic, 0);
+    timer_wheel_timer_t cancelled_timer = timer_wheel_arm(wheel, TIMER_EVENT_ID, 7, 0, &cancelled, 0);
+    assert_true(timer_wheel_cancel(wheel, cancelled_timer));
+    assert_false(timer_wheel_cancel(wheel, cancelled_timer));
+    assert_int_equal(timer_wheel_tick(wheel, 2000), 7);
+    assert_int_equal(periodic.fired, 7);
+    assert_int_equal(periodic.errors, 0);
+    assert_int_equal(cancelled.fired, 0);
+
+    timer_wheel_timer_t reused_timer = timer_wheel_arm(wheel, TIMER_EVENT_ID, 1, 0, &cancelled, 0);
+    assert_int_not_equal(reused_timer, cancelled_timer);
+    assert_false(timer_wheel_cancel(wheel, cancelled_timer));
+    assert_true(timer_wheel_cancel(wheel, periodic_timer));
+    assert_int_equal(timer_wheel_active(wheel), 1);
+
+    timer_wheel_destroy(wheel);
+    event_handler_destroy(handler);
+}
+
+static void test_long_delays_fire_on_time(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = create_handler();
+    timer_wheel_config_t config = {.handler = handler, .max_timers = 4};
+    timer_wheel_t* wheel = timer_wheel_create(&config);
+
+    timer_wheel_tick(wheel, 12345);
+    const uint32_t delays[] = {255, 256, 70000, 20000000};
+    timer_expectation_t expectations[4];
+    for (size_t i = 0; i < 4; i++) {
+        expectations[i] = (timer_expectation_t){.wheel = wheel, .expected_tick = 12345 + delays[i]};
+        timer_wheel_arm(wheel, TIMER_EVENT_ID, delays[i], 0, &expectations[i], 0);
+    }
+    assert_int_equal(timer_wheel_tick(wheel, 20000000), 4);
+    for (size_t i = 0; i < 4; i++) {
+        assert_int_equal(expectations[i].fired, 1);
+        assert_int_equal(expectations[i].errors, 0);
+    }
+
+    timer_wheel_destroy(wheel);
+    event_handler_destroy(handler);
+}
+
+#define MANY_TIMERS 30000
+
+static void test_many_timers(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = create_handler();
+    timer_wheel_config_t config = {.handler = handler, .max_timers = MANY_TIMERS};
+    timer_wheel_t* wheel = timer_wheel_create(&config);
+    timer_expectation_t* expectations = calloc(MANY_TIMERS, sizeof(timer_expectation_t));
+    timer_wheel_timer_t* timers = calloc(MANY_TIMERS, sizeof(timer_wheel_timer_t));
+    assert_non_null(expectations);
+    assert_non_null(timers);
+
+    srand(7);
+    for (size_t i = 0; i < MANY_TIMERS; i++) {
+        uint32_t delay = 1 + (uint32_t)rand() % 100000;
+        expectations[i] = (timer_expectation_t){.wheel = wheel, .expected_tick = delay};
+        timers[i] = timer_wheel_arm(wheel, TIMER_EVENT_ID, delay, 0, &expectations[i], 0);
+        assert_int_not_equal(timers[i], TIMER_WHEEL_INVALID_TIMER);
+    }
+    for (size_t i = 0; i < MANY_TIMERS; i += 2) {
+        assert_true(timer_wheel_cancel(wheel, timers[i]));
+    }
+    assert_int_equal(timer_wheel_tick(wheel, 100000), MANY_TIMERS / 2);
+    for (size_t i = 0; i < MANY_TIMERS; i++) {
+        assert_int_equal(expectations[i].fired, i % 2);
+        assert_int_equal(expectations[i].errors, 0);
+    }
+
+    free(timers);
+    free(expectations);
+    timer_wheel_destroy(wheel);
+    event_handler_destroy(handler);
+}
+
+static void test_posted_delivery(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t queue_config = {0};
+    event_handler_t* handler = event_handler_create_with_queue(&queue_config);
+    assert_true(event_handler_register(handler, TIMER_EVENT_ID, NULL, posted_expiration_handler));
+    timer_wheel_config_t config = {.handler = handler, .max_timers = 1, .delivery = TIMER_WHEEL_DELIVERY_POST};
+    timer_wheel_t* wheel = timer_wheel_create(&config);
+
+    timer_expectation_t expectation = {.wheel = wheel, .expected_tick = 3};
+    timer_expectation_t* expectation_pointer = &expectation;
+    timer_wheel_arm(wheel, TIMER_EVENT_ID, 3, 0, &expectation_pointer, sizeof(expectation_pointer));
+    assert_int_equal(timer_wheel_tick(wheel, 3), 1);
+    assert_int_equal(expectation.fired, 0);
+    assert_int_equal(event_handler_run(handler), 1);
+    assert_int_equal(expectation.fired, 1);
+    assert_int_equal(expectation.errors, 0);
+
+    timer_wheel_destroy(wheel);
+    event_handler_destroy(handler);
+}
+
+static void test_posted_delivery_dropped(void** state) {
+    (void)state;  // unused
+    event_handler_queue_config_t queue_config = {.depth = 2};
+    event_handler_t* handler = event_handler_create_with_queue(&queue_config);
+    timer_wheel_config_t config = {.handler = handler, .max_timers = 4, .delivery = TIMER_WHEEL_DELIVERY_POST};
+    timer_wheel_t* wheel = timer_wheel_create(&config);
+
+    /* Only two of the expirations fit into the queue, the periodic timer stays armed after its drop. */
+    for (int i = 0; i < 3; i++) {
+        timer_wheel_arm(wheel, TIMER_EVENT_ID, 5, 0, NULL, 0);
+    }
+    timer_wheel_arm(wheel, TIMER_EVENT_ID, 5, 10, NULL, 0);
+    assert_int_equal(timer_wheel_tick(wheel, 5), 2);
+    assert_int_equal(timer_wheel_dropped(wheel), 2);
+    assert_int_equal(timer_wheel_active(wheel), 1);
+    assert_int_equal(event_handler_run(handler), 2);
+    assert_int_equal(timer_wheel_tick(wheel, 10), 1);
+    assert_int_equal(timer_wheel_dropped(wheel), 2);
+
+    timer_wheel_destroy(wheel);
+    event_handler_destroy(handler);
+}
+
+#if defined(__linux__)
+static void test_timerfd_driven(void** state) {
+    (void)state;  // unused
+    event_handler_t* handler = create_handler();
+    timer_wheel_config_t config = {.handler = handler, .max_timers = 1};
+    timer_wheel_t* wheel = timer_wheel_create(&config);
+
+    assert_int_equal(timer_wheel_timerfd_process(wheel), 0);
+    assert_true(timer_wheel_timerfd_start(wheel, 1000000) >= 0);
+    timer_expectation_t expectation = {.wheel = wheel, .expected_tick = 2};
+    timer_wheel_arm(wheel, TIMER_EVENT_ID, 2, 0, &expectation, 0);
+    struct timespec delay = {.tv_sec = 0, .tv_nsec = 1000000};
+    for (int i = 0; i < 1000 && timer_wheel_now(wheel) < 2; i++) {
+        nanosleep(&delay, NULL);
+        timer_wheel_timerfd_process(wheel);
+    }
+    assert_true(timer_wheel_now(wheel) >= 2);
+    assert_int_equal(expectation.fired, 1);
+    timer_wheel_timerfd_stop(wheel);
+
+    timer_wheel_destroy(wheel);
+    event_handler_destroy(handler);
+}
+#endif
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_create_timer_wheel),
+        cmocka_unit_test(test_one_shot_timer),
+        cmocka_unit_test(test_periodic_timer_and_cancel),
+        cmocka_unit_test(test_long_delays_fire_on_time),
+        cmocka_unit_test(test_many_timers),
+        cmocka_unit_test(test_posted_delivery),
+        cmocka_unit_test(test_posted_delivery_dropped),
+#if defined(__linux__)
+        cmocka_unit_test(test_timerfd_driven),
+#endif
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
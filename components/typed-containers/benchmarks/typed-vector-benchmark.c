@@ -0,0 +1,187 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "intrusive-list.h"
+#include "linked-list.h"
+#include "typed-vector.h"
+
+#define BENCHMARK_COUNTS (4)
+#define BENCHMARK_LOOKUPS_TOTAL (1 << 22)
+#define BENCHMARK_REGISTER_RANGE (4)
+
+static const size_t counts[BENCHMARK_COUNTS] = {4, 32, 256, 2048};
+
+typedef bool (*register_cb_t)(uint16_t address, uint16_t* value);
+
+/* The modbus register, looked up by address range for every request. */
+typedef struct modbus_register {
+    intrusive_list_node_t node;
+    uint16_t address;
+    uint16_t range;
+    register_cb_t read_cb;
+    register_cb_t write_cb;
+} modbus_register_t;
+
+TYPED_VECTOR_DEFINE(register_vector, modbus_register_t)
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool read_register(uint16_t address, uint16_t* value) {
+    *value = address;
+    return true;
+}
+
+static bool matches(const modbus_register_t* reg, uint16_t address, size_t count) {
+    return (address >= reg->address) && (address < reg->address + reg->range) &&
+           (address + count <= reg->address + reg->range) && (reg->read_cb != NULL);
+}
+
+static uint16_t* make_addresses(size_t count) {
+    uint16_t* addresses = malloc(BENCHMARK_LOOKUPS_TOTAL * sizeof(uint16_t));
+    srand(1);
+    for (size_t i = 0; i < BENCHMARK_LOOKUPS_TOTAL; i++) {
+        addresses[i] = (uint16_t)((size_t)rand() % (count * BENCHMARK_REGISTER_RANGE));
+    }
+    return addresses;
+}
+
+/* Registers were allocated one by one between other allocations, as modbus_register did before. */
+static modbus_register_t* allocate_register(size_t index, void** spacers) {
+    modbus_register_t* reg = calloc(1, sizeof(modbus_register_t));
+    reg->address = (uint16_t)(index * BENCHMARK_REGISTER_RANGE);
+    reg->range = BENCHMARK_REGISTER_RANGE;
+    reg->read_cb = read_register;
+    spacers[index] = malloc(16 + (size_t)rand() % 256);
+    return reg;
+}
+
+static uint64_t lookup_intrusive(intrusive_list_t* registers, const uint16_t* addresses, size_t lookups) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < lookups; i++) {
+        intrusive_list_node_t* node;
+        INTRUSIVE_LIST_FOR_EACH(registers, node) {
+            modbus_register_t* reg = intrusive_list_entry(node, modbus_register_t, node);
+            if (matches(reg, addresses[i], 1)) {
+                sum += reg->address;
+                break;
+            }
+        }
+    }
+    return sum;
+}
+
+static uint64_t lookup_linked_list(linked_list_t* registers, const uint16_t* addresses, size_t lookups) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < lookups; i++) {
+        for (linked_list_iterator_t* it = linked_list_iterator_begin(registers); it != NULL;
+             it = linked_list_iterator_next(it)) {
+            modbus_register_t* reg = linked_list_get(it);
+            if (matches(reg, addresses[i], 1)) {
+                sum += reg->address;
+                break;
+            }
+        }
+    }
+    return sum;
+}
+
+static uint64_t lookup_vector(register_vector_t* registers, const uint16_t* addresses, size_t lookups) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < lookups; i++) {
+        modbus_register_t* reg;
+        TYPED_VECTOR_FOR_EACH(registers, reg) {
+            if (matches(reg, addresses[i], 1)) {
+                sum += reg->address;
+                break;
+            }
+        }
+    }
+    return sum;
+}
+
+static void report(size_t count, const char* name, size_t lookups, double elapsed, uint64_t sum) {
+    printf("%6zu registers, %-14s: %10.1f k lookups/s (sum %llu)\n", count, name, (double)lookups / elapsed / 1e3,
+           (unsigned long long)sum);
+}
+
+int main(void) {
+    for (size_t c = 0; c < BENCHMARK_COUNTS; c++) {
+        size_t count = counts[c];
+        /* Lookups scan half of the registers on average, keep the scanned total comparable. */
+        size_t lookups = BENCHMARK_LOOKUPS_TOTAL / (count > 64 ? count / 64 : 1);
+        uint16_t* addresses = make_addresses(count);
+        void** spacers = malloc(count * 2 * sizeof(void*));
+
+        intrusive_list_t intrusive;
+        intrusive_list_init(&intrusive);
+        linked_list_t* list = linked_list_create();
+        register_vector_t vector;
+        register_vector_init(&vector);
+        for (size_t i = 0; i < count; i++) {
+            intrusive_list_push_back(&intrusive, &allocate_register(i, spacers)->node);
+            linked_list_append(list, allocate_register(i, spacers + count));
+            modbus_register_t reg = {.address = (uint16_t)(i * BENCHMARK_REGISTER_RANGE),
+                                     .range = BENCHMARK_REGISTER_RANGE,
+                                     .read_cb = read_register};
+            register_vector_push(&vector, reg);
+        }
+
+        double start = now_seconds();
+        uint64_t sum = lookup_intrusive(&intrusive, addresses, lookups);
+        report(count, "intrusive list", lookups, now_seconds() - start, sum);
+        start = now_seconds();
+        sum = lookup_linked_list(list, addresses, lookups);
+        report(count, "linked list", lookups, now_seconds() - start, sum);
+        start = now_seconds();
+        sum = lookup_vector(&vector, addresses, lookups);
+        report(count, "typed vector", lookups, now_seconds() - start, sum);
+
+        intrusive_list_node_t* node;
+        intrusive_list_node_t* next;
+        INTRUSIVE_LIST_FOR_EACH_SAFE(&intrusive, node, next) {
+            free(intrusive_list_entry(node, modbus_register_t, node));
+        }
+        for (linked_list_iterator_t* it = linked_list_iterator_begin(list); it != NULL;
+             it = linked_list_iterator_next(it)) {
+            free(linked_list_get(it));
+        }
+        linked_list_destroy(list);
+        register_vector_free(&vector);
+        for (size_t i = 0; i < count * 2; i++) {
+            free(spacers[i]);
+        }
+        free(spacers);
+        free(addresses);
+    }
+    return 0;
+}
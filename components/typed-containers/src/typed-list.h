@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TYPED_LIST_H
+#define TYPED_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * @defgroup typed-list Typed list
+ * @ingroup typed-containers
+ *
+ * @brief A doubly linked list of nodes holding elements by value.
+ *
+ * TYPED_LIST_DEFINE(name, type) generates the `name_t` list and `name_node_t` node structures and
+ * `static inline` functions prefixed with `name_`. Node pointers stay valid until the node is removed.
+ *
+ * Generated functions:
+ * - `void name_init(name_t* list)`
+ * - `void name_free(name_t* list)`
+ * - `name_node_t* name_push_back(name_t* list, type value)`, NULL if no more memory
+ * - `name_node_t* name_push_front(name_t* list, type value)`, NULL if no more memory
+ * - `void name_remove(name_t* list, name_node_t* node)`
+ * - `size_t name_size(const name_t* list)`
+ * @{
+ */
+
+/**
+ * @brief Iterate over list nodes, the element is `node->value`.
+ * @param list A pointer to the list.
+ * @param node A node pointer variable.
+ */
+#define TYPED_LIST_FOR_EACH(list, node) for ((node) = (list)->head; (node); (node) = (node)->next)
+
+/**
+ * @brief Generate a list of @p type.
+ * @param name The name of the list type and the prefix of its functions.
+ * @param type The element type.
+ */
+#define TYPED_LIST_DEFINE(name, type)                                            \
+    typedef struct name##_node {                                                 \
+        type value;                                                              \
+        struct name##_node* next;                                                \
+        struct name##_node* prev;                                                \
+    } name##_node_t;                                                             \
+                                                                                 \
+    typedef struct name {                                                        \
+        name##_node_t* head;                                                     \
+        name##_node_t* tail;                                                     \
+        size_t size;                                                             \
+    } name##_t;                                                                  \
+                                                                                 \
+    static inline void name##_init(name##_t* list) {                             \
+        list->head = NULL;                                                       \
+        list->tail = NULL;                                                       \
+        list->size = 0;                                                          \
+    }                                                                            \
+                                                                                 \
+    static inline void name##_free(name##_t* list) {                             \
+        while (list->head) {                                                     \
+            name##_node_t* next = list->head->next;                              \
+            free(list->head);                                                    \
+            list->head = next;                                                   \
+        }                                                                        \
+        name##_init(list);                                                       \
+    }                                                                            \
+                                                                                 \
+    static inline name##_node_t* name##_push_back(name##_t* list, type value) {  \
+        name##_node_t* node = malloc(sizeof(name##_node_t));                     \
+        if (!node) {                                                             \
+            return NULL;                                                         \
+        }                                                                        \
+        node->value = value;                                                     \
+        node->next = NULL;                                                       \
+        node->prev = list->tail;                                                 \
+        if (list->tail) {                                                        \
+            list->tail->next = node;                                             \
+        } else {                                                                 \
+            list->head = node;                                                   \
+        }                                                                        \
+        list->tail = node;                                                       \
+        list->size++;                                                            \
+        return node;                                                             \
+    }                                                                            \
+                                                                                 \
+    static inline name##_node_t* name##_push_front(name##_t* list, type value) { \
+        name##_node_t* node = malloc(sizeof(name##_node_t));                     \
+        if (!node) {                                                             \
+            return NULL;                                                         \
+        }                                                                        \
+        node->value = value;                                                     \
+        node->prev = NULL;                                                       \
+        node->next = list->head;                                                 \
+        if (list->head) {                                                        \
+            list->head->prev = node;                                             \
+        } else {                                                                 \
+            list->tail = node;                                                   \
+        }                                                                        \
+        list->head = node;                                                       \
+        list->size++;                                                            \
+        return node;                                                             \
+    }                                                                            \
+                                                                                 \
+    static inline void name##_remove(name##_t* list, name##_node_t* node) {      \
+        if (node->prev) {                                                        \
+            node->prev->next = node->next;                                       \
+        } else {                                                                 \
+            list->head = node->next;                                             \
+        }                                                                        \
+        if (node->next) {                                                        \
+            node->next->prev = node->prev;                                       \
+        } else {                                                                 \
+            list->tail = node->prev;                                             \
+        }                                                                        \
+        list->size--;                                                            \
+        free(node);                                                              \
+    }                                                                            \
+                                                                                 \
+    static inline size_t name##_size(const name##_t* list) {                     \
+        return list->size;                                                       \
+    }
+
+/**
+ * @}
+ */
+
+#endif  // TYPED_LIST_H
@@ -0,0 +1,195 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TYPED_MAP_H
+#define TYPED_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @defgroup typed-map Typed hash map
+ * @ingroup typed-containers
+ *
+ * @brief An open addressing hash map with keys and values stored by value.
+ *
+ * TYPED_MAP_DEFINE(name, key_type, value_type, hash, equal) generates the `name_t` map and
+ * `name_entry_t` entry structures and `static inline` functions prefixed with `name_`. Collisions are
+ * resolved by linear probing, removal shifts the following entries back so no tombstones are left.
+ * The table doubles when it gets half full. A zero initialized map is empty and ready to use.
+ *
+ * Generated functions:
+ * - `void name_init(name_t* map)`
+ * - `void name_free(name_t* map)`
+ * - `bool name_put(name_t* map, key_type key, value_type value)`, inserts or overwrites
+ * - `value_type* name_get(const name_t* map, key_type key)`, NULL if not found, valid until the next put
+ * - `bool name_remove(name_t* map, key_type key)`
+ * - `size_t name_size(const name_t* map)`
+ * @{
+ */
+
+/**
+ * @brief Hash of an integer key, usable as the @p hash argument of TYPED_MAP_DEFINE().
+ */
+static inline size_t typed_map_hash_integer(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+
+/**
+ * @brief Iterate over map entries, the key is `entry->key` and the value `entry->value`.
+ * @note The map must not be modified inside the loop.
+ * @param map A pointer to the map.
+ * @param entry An entry pointer variable.
+ */
+#define TYPED_MAP_FOR_EACH(map, entry)                                                    \
+    for ((entry) = (map)->entries; (entry) < (map)->entries + (map)->capacity; (entry)++) \
+        if (!(entry)->used) {                                                             \
+        } else
+
+/**
+ * @brief Generate a hash map from @p key_type to @p value_type.
+ * @param name The name of the map type and the prefix of its functions.
+ * @param key_type The key type.
+ * @param value_type The value type.
+ * @param hash A function or macro taking a key and returning its `size_t` hash.
+ * @param equal A function or macro taking two keys and returning true if they are equal.
+ */
+#define TYPED_MAP_DEFINE(name, key_type, value_type, hash, equal)                                          \
+    typedef struct name##_entry {                                                                          \
+        key_type key;                                                                                      \
+        value_type value;                                                                                  \
+        bool used;                                                                                         \
+    } name##_entry_t;                                                                                      \
+                                                                                                           \
+    typedef struct name {                                                                                  \
+        name##_entry_t* entries;                                                                           \
+        size_t capacity;                                                                                   \
+        size_t size;                                                                                       \
+    } name##_t;                                                                                            \
+                                                                                                           \
+    static inline void name##_init(name##_t* map) {                                                        \
+        map->entries = NULL;                                                                               \
+        map->capacity = 0;                                                                                 \
+        map->size = 0;                                                                                     \
+    }                                                                                                      \
+                                                                                                           \
+    static inline void name##_free(name##_t* map) {                                                        \
+        free(map->entries);                                                                                \
+        name##_init(map);                                                                                  \
+    }                                                                                                      \
+                                                                                                           \
+    static inline name##_entry_t* name##_find(const name##_t* map, key_type key) {                         \
+        if (map->capacity == 0) {                                                                          \
+            return NULL;                                                                                   \
+        }                                                                                                  \
+        size_t mask = map->capacity - 1;                                                                   \
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {                                           \
+            name##_entry_t* entry = &map->entries[i];                                                      \
+            if (!entry->used) {                                                                            \
+                return NULL;                                                                               \
+            }                                                                                              \
+            if (equal(entry->key, key)) {                                                                  \
+                return entry;                                                                              \
+            }                                                                                              \
+        }                                                                                                  \
+    }                                                                                                      \
+                                                                                                           \
+    static inline void name##_insert_new(name##_entry_t* entries, size_t capacity, name##_entry_t entry) { \
+        size_t i = hash(entry.key) & (capacity - 1);                                                       \
+        while (entries[i].used) {                                                                          \
+            i = (i + 1) & (capacity - 1);                                                                  \
+        }                                                                                                  \
+        entries[i] = entry;                                                                                \
+    }                                                                                                      \
+                                                                                                           \
+    static inline bool name##_grow(name##_t* map) {                                                        \
+        size_t capacity = map->capacity ? map->capacity * 2 : 8;                                           \
+        name##_entry_t* entries = calloc(capacity, sizeof(name##_entry_t));                                \
+        if (!entries) {                                                                                    \
+            return false;                                                                                  \
+        }                                                                                                  \
+        for (size_t i = 0; i < map->capacity; i++) {                                                       \
+            if (map->entries[i].used) {                                                                    \
+                name##_insert_new(entries, capacity, map->entries[i]);                                     \
+            }                                                                                              \
+        }                                                                                                  \
+        free(map->entries);                                                                                \
+        map->entries = entries;                                                                            \
+        map->capacity = capacity;                                                                          \
+        return true;                                                                                       \
+    }                                                                                                      \
+                                                                                                           \
+    static inline bool name##_put(name##_t* map, key_type key, value_type value) {                         \
+        name##_entry_t* entry = name##_find(map, key);                                                     \
+        if (entry) {                                                                                       \
+            entry->value = value;                                                                          \
+            return true;                                                                                   \
+        }                                                                                                  \
+        if ((map->size + 1) * 2 > map->capacity && !name##_grow(map)) {                                    \
+            return false;                                                                                  \
+        }                                                                                                  \
+        name##_entry_t new_entry = {.key = key, .value = value, .used = true};                             \
+        name##_insert_new(map->entries, map->capacity, new_entry);                                         \
+        map->size++;                                                                                       \
+        return true;                                                                                       \
+    }                                                                                                      \
+                                                                                                           \
+    static inline value_type* name##_get(const name##_t* map, key_type key) {                              \
+        name##_entry_t* entry = name##_find(map, key);                                                     \
+        return entry ? &entry->value : NULL;                                                               \
+    }                                                                                                      \
+                                                                                                           \
+    static inline bool name##_remove(name##_t* map, key_type key) {                                        \
+        name##_entry_t* entry = name##_find(map, key);                                                     \
+        if (!entry) {                                                                                      \
+            return false;                                                                                  \
+        }                                                                                                  \
+        size_t mask = map->capacity - 1;                                                                   \
+        size_t hole = (size_t)(entry - map->entries);                                                      \
+        for (size_t i = (hole + 1) & mask; map->entries[i].used; i = (i + 1) & mask) {                     \
+            size_t home = hash(map->entries[i].key) & mask;                                                \
+            /* Move the entry into the hole unless its home slot lies cyclically after the hole. */        \
+            if (((i - home) & mask) >= ((i - hole) & mask)) {                                              \
+                map->entries[hole] = map->entries[i];                                                      \
+                hole = i;                                                                                  \
+            }                                                                                              \
+        }                                                                                                  \
+        map->entries[hole].used = false;                                                                   \
+        map->size--;                                                                                       \
+        return true;                                                                                       \
+    }                                                                                                      \
+                                                                                                           \
+    static inline size_t name##_size(const name##_t* map) {                                                \
+        return map->size;                                                                                  \
+    }
+
+/**
+ * @}
+ */
+
+#endif  // TYPED_MAP_H
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TYPED_RING_H
+#define TYPED_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * @defgroup typed-ring Typed ring buffer
+ * @ingroup typed-containers
+ *
+ * @brief A bounded FIFO of elements stored by value.
+ *
+ * TYPED_RING_DEFINE(name, type) generates the `name_t` structure and `static inline` functions prefixed
+ * with `name_`. Storage is allocated once, the capacity is rounded up to a power of two.
+ *
+ * Generated functions:
+ * - `bool name_init(name_t* ring, size_t capacity)`
+ * - `void name_free(name_t* ring)`
+ * - `bool name_push(name_t* ring, type value)`, false when full
+ * - `bool name_pop(name_t* ring, type* value)`, false when empty
+ * - `type* name_peek(name_t* ring)`, NULL when empty
+ * - `size_t name_size(const name_t* ring)`
+ * - `bool name_is_empty(const name_t* ring)` and `bool name_is_full(const name_t* ring)`
+ * @{
+ */
+
+/**
+ * @brief Generate a ring buffer of @p type.
+ * @param name The name of the ring type and the prefix of its functions.
+ * @param type The element type.
+ */
+#define TYPED_RING_DEFINE(name, type)                                                \
+    typedef struct name {                                                            \
+        type* items;                                                                 \
+        size_t mask;                                                                 \
+        size_t head;                                                                 \
+        size_t tail;                                                                 \
+    } name##_t;                                                                      \
+                                                                                     \
+    static inline bool name##_init(name##_t* ring, size_t capacity) {                \
+        size_t size = 1;                                                             \
+        while (size < capacity) {                                                    \
+            size <<= 1;                                                              \
+        }                                                                            \
+        ring->items = malloc(size * sizeof(type));                                   \
+        ring->mask = size - 1;                                                       \
+        ring->head = 0;                                                              \
+        ring->tail = 0;                                                              \
+        return ring->items != NULL;                                                  \
+    }                                                                                \
+                                                                                     \
+    static inline void name##_free(name##_t* ring) {                                 \
+        free(ring->items);                                                           \
+        ring->items = NULL;                                                          \
+    }                                                                                \
+                                                                                     \
+    static inline size_t name##_size(const name##_t* ring) {                         \
+        return ring->tail - ring->head;                                              \
+    }                                                                                \
+                                                                                     \
+    static inline bool name##_is_empty(const name##_t* ring) {                       \
+        return ring->tail == ring->head;                                             \
+    }                                                                                \
+                                                                                     \
+    static inline bool name##_is_full(const name##_t* ring) {                        \
+        return ring->tail - ring->head > ring->mask;                                 \
+    }                                                                                \
+                                                                                     \
+    static inline bool name##_push(name##_t* ring, type value) {                     \
+        if (name##_is_full(ring)) {                                                  \
+            return false;                                                            \
+        }                                                                            \
+        ring->items[ring->tail++ & ring->mask] = value;                              \
+        return true;                                                                 \
+    }                                                                                \
+                                                                                     \
+    static inline bool name##_pop(name##_t* ring, type* value) {                     \
+        if (name##_is_empty(ring)) {                                                 \
+            return false;                                                            \
+        }                                                                            \
+        *value = ring->items[ring->head++ & ring->mask];                             \
+        return true;                                                                 \
+    }                                                                                \
+                                                                                     \
+    static inline type* name##_peek(name##_t* ring) {                                \
+        return name##_is_empty(ring) ? NULL : &ring->items[ring->head & ring->mask]; \
+    }
+
+/**
+ * @}
+ */
+
+#endif  // TYPED_RING_H
@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TYPED_VECTOR_H
+#define TYPED_VECTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @defgroup typed-vector Typed vector
+ * @ingroup typed-containers
+ *
+ * @brief A growable array of elements stored by value.
+ *
+ * TYPED_VECTOR_DEFINE(name, type) generates the `name_t` structure and `static inline` functions prefixed
+ * with `name_`. A zero initialized vector is empty and ready to use.
+ *
+ * Generated functions:
+ * - `void name_init(name_t* vector)`
+ * - `void name_free(name_t* vector)`
+ * - `bool name_reserve(name_t* vector, size_t capacity)`
+ * - `bool name_push(name_t* vector, type value)`
+ * - `bool name_insert(name_t* vector, size_t index, type value)`
+ * - `void name_remove(name_t* vector, size_t index)` keeping the order
+ * - `type* name_at(name_t* vector, size_t index)` without bounds checking
+ * - `size_t name_size(const name_t* vector)`
+ * - `void name_clear(name_t* vector)`
+ * @{
+ */
+
+/**
+ * @brief Iterate over vector elements.
+ * @param vector A pointer to the vector.
+ * @param item A pointer variable of the element type receiving every element.
+ */
+#define TYPED_VECTOR_FOR_EACH(vector, item) \
+    for ((item) = (vector)->items; (item) < (vector)->items + (vector)->size; (item)++)
+
+/**
+ * @brief Generate a vector of @p type.
+ * @param name The name of the vector type and the prefix of its functions.
+ * @param type The element type.
+ */
+#define TYPED_VECTOR_DEFINE(name, type)                                                                   \
+    typedef struct name {                                                                                 \
+        type* items;                                                                                      \
+        size_t size;                                                                                      \
+        size_t capacity;                                                                                  \
+    } name##_t;                                                                                           \
+                                                                                                          \
+    static inline void name##_init(name##_t* vector) {                                                    \
+        vector->items = NULL;                                                                             \
+        vector->size = 0;                                                                                 \
+        vector->capacity = 0;                                                                             \
+    }                                                                                                     \
+                                                                                                          \
+    static inline void name##_free(name##_t* vector) {                                                    \
+        free(vector->items);                                                                              \
+        name##_init(vector);                                                                              \
+    }                                                                                                     \
+                                                                                                          \
+    static inline bool name##_reserve(name##_t* vector, size_t capacity) {                                \
+        if (capacity <= vector->capacity) {                                                               \
+            return true;                                                                                  \
+        }                                                                                                 \
+        type* items = realloc(vector->items, capacity * sizeof(type));                                    \
+        if (!items) {                                                                                     \
+            return false;                                                                                 \
+        }                                                                                                 \
+        vector->items = items;                                                                            \
+        vector->capacity = capacity;                                                                      \
+        return true;                                                                                      \
+    }                                                                                                     \
+                                                                                                          \
+    static inline bool name##_grow(name##_t* vector) {                                                    \
+        return vector->size < vector->capacity ||                                                         \
+               name##_reserve(vector, vector->capacity ? vector->capacity * 2 : 4);                       \
+    }                                                                                                     \
+                                                                                                          \
+    static inline bool name##_push(name##_t* vector, type value) {                                        \
+        if (!name##_grow(vector)) {                                                                       \
+            return false;                                                                                 \
+        }                                                                                                 \
+        vector->items[vector->size++] = value;                                                            \
+        return true;                                                                                      \
+    }                                                                                                     \
+                                                                                                          \
+    static inline bool name##_insert(name##_t* vector, size_t index, type value) {                        \
+        if (index > vector->size || !name##_grow(vector)) {                                               \
+            return false;                                                                                 \
+        }                                                                                                 \
+        memmove(&vector->items[index + 1], &vector->items[index], (vector->size - index) * sizeof(type)); \
+        vector->items[index] = value;                                                                     \
+        vector->size++;                                                                                   \
+        return true;                                                                                      \
+    }                                                                                                     \
+                                                                                                          \
+    static inline void name##_remove(name##_t* vector, size_t index) {                                    \
+        if (index >= vector->size) {                                                                      \
+            return;                                                                                       \
+        }                                                                                                 \
+        vector->size--;                                                                                   \
+        memmove(&vector->items[index], &vector->items[index + 1], (vector->size - index) * sizeof(type)); \
+    }                                                                                                     \
+                                                                                                          \
+    static inline type* name##_at(name##_t* vector, size_t index) {                                       \
+        return &vector->items[index];                                                                     \
+    }                                                                                                     \
+                                                                                                          \
+    static inline size_t name##_size(const name##_t* vector) {                                            \
+        return vector->size;                                                                              \
+    }                                                                                                     \
+                                                                                                          \
+    static inline void name##_clear(name##_t* vector) {                                                   \
+        vector->size = 0;                                                                                 \
+    }
+
+/**
+ * @}
+ */
+
+#endif  // TYPED_VECTOR_H
@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "typed-containers.h"
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cmocka.h"
+
+typedef struct point {
+    int x;
+    int y;
+} point_t;
+
+#define INTEGER_EQUAL(a, b) ((a) == (b))
+
+TYPED_VECTOR_DEFINE(point_vector, point_t)
+TYPED_LIST_DEFINE(int_list, int)
+TYPED_RING_DEFINE(int_ring, int)
+TYPED_MAP_DEFINE(int_map, uint32_t, int, typed_map_hash_integer, INTEGER_EQUAL)
+
+static void test_typed_vector(void** state) {
+    (void)state;  // unused
+    point_vector_t vector;
+    point_vector_init(&vector);
+    for (int i = 0; i < 10; i++) {
+        assert_true(point_vector_push(&vector, (point_t){i, i * 2}));
+    }
+    assert_int_equal(point_vector_size(&vector), 10);
+    assert_true(point_vector_insert(&vector, 0, (point_t){-1, -2}));
+    assert_false(point_vector_insert(&vector, 12, (point_t){0, 0}));
+    point_vector_remove(&vector, 5);
+
+    int expected[] = {-1, 0, 1, 2, 3, 5, 6, 7, 8, 9};
+    size_t index = 0;
+    point_t* point;
+    TYPED_VECTOR_FOR_EACH(&vector, point) {
+        assert_int_equal(point->x, expected[index]);
+        assert_int_equal(point->y, expected[index] * 2);
+        index++;
+    }
+    assert_int_equal(index, 10);
+    assert_int_equal(point_vector_at(&vector, 9)->x, 9);
+
+    point_vector_clear(&vector);
+    assert_int_equal(point_vector_size(&vector), 0);
+    point_vector_free(&vector);
+}
+
+static void test_typed_list(void** state) {
+    (void)state;  // unused
+    int_list_t list;
+    int_list_init(&list);
+    int_list_node_t* middle = NULL;
+    for (int i = 1; i <= 5; i++) {
+        int_list_node_t* node = int_list_push_back(&list, i);
+        assert_non_null(node);
+        if (i == 3) {
+            middle = node;
+        }
+    }
+    assert_non_null(int_list_push_front(&list, 0));
+    int_list_remove(&list, middle);
+    int_list_remove(&list, list.tail);
+    assert_int_equal(int_list_size(&list), 4);
+
+    int expected[] = {0, 1, 2, 4};
+    size_t index = 0;
+    int_list_node_t* node;
+    TYPED_LIST_FOR_EACH(&list, node) {
+        assert_int_equal(node->value, expected[index++]);
+    }
+    assert_int_equal(index, 4);
+    int_list_free(&list);
+    assert_int_equal(int_list_size(&list), 0);
+}
+
+static void test_typed_ring(void** state) {
+    (void)state;  // unused
+    int_ring_t ring;
+    assert_true(int_ring_init(&ring, 3));
+    assert_true(int_ring_is_empty(&ring));
+    assert_null(int_ring_peek(&ring));
+    for (int i = 0; i < 4; i++) {
+        assert_true(int_ring_push(&ring, i));
+    }
+    assert_true(int_ring_is_full(&ring));
+    assert_false(int_ring_push(&ring, 4));
+
+    int value = 0;
+    for (int round = 0; round < 10; round++) {
+        assert_true(int_ring_pop(&ring, &value));
+        assert_int_equal(value, round);
+        assert_true(int_ring_push(&ring, round + 4));
+    }
+    assert_int_equal(int_ring_size(&ring), 4);
+    assert_int_equal(*int_ring_peek(&ring), 10);
+    while (int_ring_pop(&ring, &value)) {
+    }
+    assert_int_equal(value, 13);
+    int_ring_free(&ring);
+}
+
+static void test_typed_map(void** state) {
+    (void)state;  // unused
+    int_map_t map;
+    int_map_init(&map);
+    assert_null(int_map_get(&map, 1));
+    for (uint32_t key = 0; key < 1000; key++) {
+        assert_true(int_map_put(&map, key * 7, (int)key));
+    }
+    assert_int_equal(int_map_size(&map), 1000);
+    assert_true(int_map_put(&map, 14, -2));
+    assert_int_equal(int_map_size(&map), 1000);
+    assert_int_equal(*int_map_get(&map, 14), -2);
+
+    for (uint32_t key = 0; key < 1000; key += 2) {
+        assert_true(int_map_remove(&map, key * 7));
+    }
+    assert_false(int_map_remove(&map, 0));
+    assert_int_equal(int_map_size(&map), 500);
+    for (uint32_t key = 0; key < 1000; key++) {
+        int* value = int_map_get(&map, key * 7);
+        if (key % 2 == 0) {
+            assert_null(value);
+        } else {
+            assert_non_null(value);
+            assert_int_equal(*value, (int)key);
+        }
+    }
+
+    size_t count = 0;
+    int_map_entry_t* entry;
+    TYPED_MAP_FOR_EACH(&map, entry) {
+        assert_int_equal(entry->key % 2, 1);
+        count++;
+    }
+    assert_int_equal(count, 500);
+    int_map_free(&map);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_typed_vector),
+        cmocka_unit_test(test_typed_list),
+        cmocka_unit_test(test_typed_ring),
+        cmocka_unit_test(test_typed_map),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
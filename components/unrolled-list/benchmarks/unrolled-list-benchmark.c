@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "linked-list.h"
+#include "unrolled-list.h"
+
+#define BENCHMARK_VISITS (200000000)
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void summing_visitor(void* data, void* context) {
+    *(uint64_t*)context += *(uint32_t*)data;
+}
+
+static void report(const char* name, size_t elements, size_t rounds, double elapsed, uint64_t sum) {
+    printf("%8zu elements, %-22s: %7.1f M elements/s (sum %llu)\n",
+           elements,
+           name,
+           (double)(elements * rounds) / elapsed / 1e6,
+           (unsigned long long)sum);
+}
+
+/*
+ * Elements are appended interleaved with unrelated allocations, as registries are filled during
+ * initialization, so list nodes do not end up adjacent on the heap.
+ */
+static void benchmark(size_t elements) {
+    uint32_t* values = malloc(elements * sizeof(uint32_t));
+    void** noise = malloc(elements * sizeof(void*));
+    linked_list_t* linked = linked_list_create();
+    unrolled_list_t* unrolled = unrolled_list_create();
+    for (size_t i = 0; i < elements; i++) {
+        values[i] = (uint32_t)i;
+        linked_list_append(linked, &values[i]);
+        unrolled_list_append(unrolled, &values[i]);
+        noise[i] = malloc(16 + (size_t)rand() % 112);
+    }
+    size_t rounds = BENCHMARK_VISITS / elements;
+
+    uint64_t sum = 0;
+    double start = now_seconds();
+    for (size_t round = 0; round < rounds; round++) {
+        for (linked_list_iterator_t* it = linked_list_iterator_begin(linked); it; it = linked_list_iterator_next(it)) {
+            sum += *(uint32_t*)linked_list_get(it);
+        }
+    }
+    report("linked list", elements, rounds, now_seconds() - start, sum);
+
+    sum = 0;
+    start = now_seconds();
+    for (size_t round = 0; round < rounds; round++) {
+        for (unrolled_list_iterator_t it = unrolled_list_iterator_begin(unrolled); unrolled_list_iterator_valid(&it);
+             unrolled_list_iterator_next(&it)) {
+            sum += *(uint32_t*)unrolled_list_get(&it);
+        }
+    }
+    report("unrolled iterator", elements, rounds, now_seconds() - start, sum);
+
+    sum = 0;
+    start = now_seconds();
+    for (size_t round = 0; round < rounds; round++) {
+        uint32_t* item;
+        UNROLLED_LIST_FOR_EACH(unrolled, item) {
+            sum += *item;
+        }
+    }
+    report("unrolled for each", elements, rounds, now_seconds() - start, sum);
+
+    sum = 0;
+    start = now_seconds();
+    for (size_t round = 0; round < rounds; round++) {
+        unrolled_list_for_each(unrolled, summing_visitor, &sum);
+    }
+    report("unrolled for each call", elements, rounds, now_seconds() - start, sum);
+
+    for (size_t i = 0; i < elements; i++) {
+        free(noise[i]);
+    }
+    free(noise);
+    linked_list_destroy(linked);
+    unrolled_list_destroy(unrolled);
+    free(values);
+}
+
+int main(void) {
+    benchmark(10);
+    benchmark(1000);
+    benchmark(100000);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "unrolled-list.h"
+#include <stdlib.h>
+#include <string.h>
+
+unrolled_list_t* unrolled_list_create(void) {
+    return calloc(1, sizeof(unrolled_list_t));
+}
+
+void unrolled_list_destroy(unrolled_list_t* list) {
+    if (list == NULL) {
+        return;
+    }
+    unrolled_list_block_t* block = list->head;
+    while (block != NULL) {
+        unrolled_list_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(list);
+}
+
+bool unrolled_list_append(unrolled_list_t* list, void* data) {
+    if (list == NULL) {
+        return false;
+    }
+    unrolled_list_block_t* tail = list->tail;
+    if (tail == NULL || tail->count == UNROLLED_LIST_BLOCK_SIZE) {
+        unrolled_list_block_t* block = malloc(sizeof(unrolled_list_block_t));
+        if (block == NULL) {
+            return false;
+        }
+        block->next = NULL;
+        block->count = 0;
+        if (tail != NULL) {
+            tail->next = block;
+        } else {
+            list->head = block;
+        }
+        list->tail = block;
+        tail = block;
+    }
+    tail->items[tail->count++] = data;
+    list->size++;
+    return true;
+}
+
+static void unlink_block(unrolled_list_t* list, unrolled_list_block_t* prev, unrolled_list_block_t* block) {
+    if (prev != NULL) {
+        prev->next = block->next;
+    } else {
+        list->head = block->next;
+    }
+    if (list->tail == block) {
+        list->tail = prev;
+    }
+    free(block);
+}
+
+/*
+ * Keeps every block but the tail at least half full after a removal, so iteration does not degrade into a
+ * pointer chase per element. The block takes over the next one when both fit together, borrows the front of
+ * the next one otherwise, and a short tail is moved into the previous block when it fits there.
+ */
+static void rebalance(unrolled_list_t* list, unrolled_list_block_t* prev, unrolled_list_block_t* block) {
+    if (block->count >= UNROLLED_LIST_BLOCK_SIZE / 2) {
+        return;
+    }
+    unrolled_list_block_t* next = block->next;
+    if (next != NULL) {
+        if (block->count + next->count <= UNROLLED_LIST_BLOCK_SIZE) {
+            memcpy(&block->items[block->count], next->items, next->count * sizeof(void*));
+            block->count += next->count;
+            unlink_block(list, block, next);
+        } else {
+            size_t moved = (next->count - block->count + 1) / 2;
+            memcpy(&block->items[block->count], next->items, moved * sizeof(void*));
+            memmove(next->items, &next->items[moved], (next->count - moved) * sizeof(void*));
+            block->count += moved;
+            next->count -= moved;
+        }
+    } else if (prev != NULL && prev->count + block->count <= UNROLLED_LIST_BLOCK_SIZE) {
+        memcpy(&prev->items[prev->count], block->items, block->count * sizeof(void*));
+        prev->count += block->count;
+        unlink_block(list, prev, block);
+    } else if (block->count == 0) {
+        unlink_block(list, prev, block);
+    }
+}
+
+bool unrolled_list_remove(unrolled_list_t* list, void* data) {
+    if (list == NULL) {
+        return false;
+    }
+    for (unrolled_list_block_t *block = list->head, *prev = NULL; block != NULL; prev = block, block = block->next) {
+        for (size_t i = 0; i < block->count; i++) {
+            if (block->items[i] != data) {
+                continue;
+            }
+            memmove(&block->items[i], &block->items[i + 1], (block->count - i - 1) * sizeof(void*));
+            block->count--;
+            list->size--;
+            rebalance(list, prev, block);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t unrolled_list_size(const unrolled_list_t* list) {
+    return (list != NULL ? list->size : 0);
+}
+
+void unrolled_list_for_each(const unrolled_list_t* list, unrolled_list_visitor_t visitor, void* context) {
+    if (list == NULL || visitor == NULL) {
+        return;
+    }
+    for (const unrolled_list_block_t* block = list->head; block != NULL; block = block->next) {
+        void* const* items = block->items;
+        for (size_t i = 0, count = block->count; i < count; i++) {
+            visitor(items[i], context);
+        }
+    }
+}
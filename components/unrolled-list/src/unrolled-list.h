@@ -0,0 +1,182 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @defgroup unrolled-list Unrolled list
+ *
+ * @brief A list of element pointers stored in contiguous blocks.
+ *
+ * Iteration walks a block at a time, so it touches one cache line per few elements instead of chasing a
+ * pointer per element. The iterator and UNROLLED_LIST_FOR_EACH() are inline, so a loop over the list
+ * keeps its position in registers. Removals merge blocks which drop below half full.
+ * @{
+ */
+
+#ifndef UNROLLED_LIST_BLOCK_SIZE
+#define UNROLLED_LIST_BLOCK_SIZE 14 /**< Element pointers per block, the default makes a block 128 bytes */
+#endif
+
+/**
+ * @brief Unrolled list block.
+ * @note This structure is not meant to be used directly by the user.
+ */
+typedef struct unrolled_list_block {
+    struct unrolled_list_block* next;
+    size_t count;
+    void* items[UNROLLED_LIST_BLOCK_SIZE];
+} unrolled_list_block_t;
+
+/**
+ * @brief Unrolled list.
+ * @note This structure is not meant to be used directly by the user. Blocks are never empty and all but the
+ * tail are at least half full.
+ */
+typedef struct unrolled_list {
+    unrolled_list_block_t* head;
+    unrolled_list_block_t* tail;
+    size_t size;
+} unrolled_list_t;
+
+/**
+ * @brief Unrolled list iterator, used by value.
+ */
+typedef struct unrolled_list_iterator {
+    unrolled_list_block_t* block;
+    size_t index;
+} unrolled_list_iterator_t;
+
+/**
+ * @brief Element visitor used by unrolled_list_for_each().
+ * @param data A pointer to the element.
+ * @param context A pointer passed to unrolled_list_for_each().
+ */
+typedef void (*unrolled_list_visitor_t)(void* data, void* context);
+
+/**
+ * @brief Create a new unrolled list.
+ * @return A pointer to the newly created list.
+ * @return NULL if the list could not be created.
+ */
+unrolled_list_t* unrolled_list_create(void);
+
+/**
+ * @brief Destroy an unrolled list.
+ * @param list A pointer to the list to destroy.
+ * @note Elements themselves are not freed.
+ */
+void unrolled_list_destroy(unrolled_list_t* list);
+
+/**
+ * @brief Append an element to the end of a list.
+ * @param list A pointer to the list.
+ * @param data A pointer to the element.
+ * @return true if the element was appended.
+ * @return false if the list was invalid or no more memory.
+ */
+bool unrolled_list_append(unrolled_list_t* list, void* data);
+
+/**
+ * @brief Remove the first occurrence of an element, keeping the order of the others.
+ * @param list A pointer to the list.
+ * @param data A pointer to the element.
+ * @return true if the element was found and removed.
+ */
+bool unrolled_list_remove(unrolled_list_t* list, void* data);
+
+/**
+ * @brief Get the number of elements in a list.
+ * @param list A pointer to the list.
+ * @return The number of elements.
+ */
+size_t unrolled_list_size(const unrolled_list_t* list);
+
+/**
+ * @brief Call a visitor for every element of a list, in order.
+ * @param list A pointer to the list.
+ * @param visitor The function to call.
+ * @param context A pointer passed to every call.
+ */
+void unrolled_list_for_each(const unrolled_list_t* list, unrolled_list_visitor_t visitor, void* context);
+
+/**
+ * @brief Get an iterator to the first element of a list.
+ * @param list A pointer to the list.
+ * @return The iterator, check it with unrolled_list_iterator_valid().
+ */
+static inline unrolled_list_iterator_t unrolled_list_iterator_begin(const unrolled_list_t* list) {
+    unrolled_list_iterator_t iterator = {list ? list->head : NULL, 0};
+    return iterator;
+}
+
+/**
+ * @brief Check if an iterator points to an element.
+ * @param iterator A pointer to the iterator.
+ * @return true if unrolled_list_get() may be called.
+ */
+static inline bool unrolled_list_iterator_valid(const unrolled_list_iterator_t* iterator) {
+    return iterator->block != NULL;
+}
+
+/**
+ * @brief Advance an iterator to the next element.
+ * @param iterator A pointer to a valid iterator.
+ */
+static inline void unrolled_list_iterator_next(unrolled_list_iterator_t* iterator) {
+    if (++iterator->index == iterator->block->count) {
+        iterator->block = iterator->block->next;
+        iterator->index = 0;
+    }
+}
+
+/**
+ * @brief Get the element an iterator points to.
+ * @param iterator A pointer to a valid iterator.
+ * @return A pointer to the element.
+ */
+static inline void* unrolled_list_get(const unrolled_list_iterator_t* iterator) {
+    return iterator->block->items[iterator->index];
+}
+
+/**
+ * @brief Iterate over all elements of a list.
+ * @note The list must not be modified inside the loop.
+ * @param list A pointer to the list.
+ * @param item A `void*` compatible variable receiving the elements.
+ */
+#define UNROLLED_LIST_FOR_EACH(list, item)                                                      \
+    for (unrolled_list_iterator_t unrolled_list_iterator_ = unrolled_list_iterator_begin(list); \
+         unrolled_list_iterator_.block &&                                                       \
+         ((item) = unrolled_list_iterator_.block->items[unrolled_list_iterator_.index], 1);     \
+         unrolled_list_iterator_next(&unrolled_list_iterator_))
+
+/**
+ * @}
+ */
+
+#endif  // UNROLLED_LIST_H
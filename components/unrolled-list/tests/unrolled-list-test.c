@@ -0,0 +1,184 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 G2Labs Grzegorz Grzeda
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "unrolled-list.h"
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cmocka.h"
+
+#define TEST_ELEMENTS (UNROLLED_LIST_BLOCK_SIZE * 3 + 5)
+
+static void test_create_unrolled_list(void** state) {
+    (void)state;  // unused
+    unrolled_list_t* list = unrolled_list_create();
+    assert_non_null(list);
+    assert_int_equal(unrolled_list_size(list), 0);
+    unrolled_list_iterator_t it = unrolled_list_iterator_begin(list);
+    assert_false(unrolled_list_iterator_valid(&it));
+    unrolled_list_destroy(list);
+}
+
+static void test_unrolled_list_iterate(void** state) {
+    (void)state;  // unused
+    unrolled_list_t* list = unrolled_list_create();
+    int elements[TEST_ELEMENTS];
+    for (int i = 0; i < TEST_ELEMENTS; i++) {
+        elements[i] = i;
+        assert_true(unrolled_list_append(list, &elements[i]));
+    }
+    assert_int_equal(unrolled_list_size(list), TEST_ELEMENTS);
+
+    int expected = 0;
+    for (unrolled_list_iterator_t it = unrolled_list_iterator_begin(list); unrolled_list_iterator_valid(&it);
+         unrolled_list_iterator_next(&it)) {
+        assert_int_equal(*(int*)unrolled_list_get(&it), expected++);
+    }
+    assert_int_equal(expected, TEST_ELEMENTS);
+
+    expected = 0;
+    int* item;
+    UNROLLED_LIST_FOR_EACH(list, item) {
+        assert_int_equal(*item, expected++);
+    }
+    assert_int_equal(expected, TEST_ELEMENTS);
+
+    unrolled_list_destroy(list);
+}
+
+static void summing_visitor(void* data, void* context) {
+    *(int*)context += *(int*)data;
+}
+
+static void test_unrolled_list_remove(void** state) {
+    (void)state;  // unused
+    unrolled_list_t* list = unrolled_list_create();
+    int elements[TEST_ELEMENTS];
+    int sum = 0;
+    for (int i = 0; i < TEST_ELEMENTS; i++) {
+        elements[i] = i;
+        sum += i;
+        unrolled_list_append(list, &elements[i]);
+    }
+    /* Removing the whole first block keeps the rest in order. */
+    for (int i = 0; i < UNROLLED_LIST_BLOCK_SIZE; i++) {
+        assert_true(unrolled_list_remove(list, &elements[i]));
+        sum -= i;
+    }
+    assert_true(unrolled_list_remove(list, &elements[TEST_ELEMENTS - 1]));
+    sum -= TEST_ELEMENTS - 1;
+    assert_false(unrolled_list_remove(list, &elements[0]));
+    assert_int_equal(unrolled_list_size(list), TEST_ELEMENTS - UNROLLED_LIST_BLOCK_SIZE - 1);
+
+    int visited = 0;
+    unrolled_list_for_each(list, summing_visitor, &visited);
+    assert_int_equal(visited, sum);
+
+    int expected = UNROLLED_LIST_BLOCK_SIZE;
+    for (unrolled_list_iterator_t it = unrolled_list_iterator_begin(list); unrolled_list_iterator_valid(&it);
+         unrolled_list_iterator_next(&it)) {
+        assert_int_equal(*(int*)unrolled_list_get(&it), expected++);
+    }
+    assert_int_equal(expected, TEST_ELEMENTS - 1);
+
+    for (int i = UNROLLED_LIST_BLOCK_SIZE; i < TEST_ELEMENTS - 1; i++) {
+        assert_true(unrolled_list_remove(list, &elements[i]));
+    }
+    assert_int_equal(unrolled_list_size(list), 0);
+    assert_true(unrolled_list_append(list, &elements[0]));
+    assert_int_equal(unrolled_list_size(list), 1);
+    unrolled_list_destroy(list);
+}
+
+static void test_unrolled_list_break(void** state) {
+    (void)state;  // unused
+    unrolled_list_t* list = unrolled_list_create();
+    int elements[TEST_ELEMENTS];
+    for (int i = 0; i < TEST_ELEMENTS; i++) {
+        elements[i] = i;
+        unrolled_list_append(list, &elements[i]);
+    }
+    int visited = 0;
+    int* item = NULL;
+    UNROLLED_LIST_FOR_EACH(list, item) {
+        visited++;
+        if (*item == UNROLLED_LIST_BLOCK_SIZE + 2) {
+            break;
+        }
+    }
+    assert_int_equal(visited, UNROLLED_LIST_BLOCK_SIZE + 3);
+    assert_ptr_equal(item, &elements[UNROLLED_LIST_BLOCK_SIZE + 2]);
+    unrolled_list_destroy(list);
+}
+
+#define MERGE_TEST_ELEMENTS 1000
+
+static void test_unrolled_list_merge(void** state) {
+    (void)state;  // unused
+    unrolled_list_t* list = unrolled_list_create();
+    static int elements[MERGE_TEST_ELEMENTS];
+    for (int i = 0; i < MERGE_TEST_ELEMENTS; i++) {
+        elements[i] = i;
+        unrolled_list_append(list, &elements[i]);
+    }
+    /* Keep every tenth element, removing the others in a scattered order. */
+    for (int i = 0; i < MERGE_TEST_ELEMENTS; i++) {
+        int index = (i * 7919) % MERGE_TEST_ELEMENTS;
+        if (index % 10 != 0) {
+            assert_true(unrolled_list_remove(list, &elements[index]));
+        }
+    }
+    assert_int_equal(unrolled_list_size(list), MERGE_TEST_ELEMENTS / 10);
+
+    int expected = 0;
+    int* item;
+    UNROLLED_LIST_FOR_EACH(list, item) {
+        assert_int_equal(*item, expected);
+        expected += 10;
+    }
+    assert_int_equal(expected, MERGE_TEST_ELEMENTS);
+
+    size_t blocks = 0;
+    for (const unrolled_list_block_t* block = list->head; block != NULL; block = block->next) {
+        assert_true(block->count > 0);
+        assert_true(block == list->tail || block->count >= UNROLLED_LIST_BLOCK_SIZE / 2);
+        blocks++;
+    }
+    assert_true(blocks <= (MERGE_TEST_ELEMENTS / 10) / (UNROLLED_LIST_BLOCK_SIZE / 2) + 1);
+    unrolled_list_destroy(list);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_create_unrolled_list),
+        cmocka_unit_test(test_unrolled_list_iterate),
+        cmocka_unit_test(test_unrolled_list_remove),
+        cmocka_unit_test(test_unrolled_list_break),
+        cmocka_unit_test(test_unrolled_list_merge),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}